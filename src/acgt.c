@@ -0,0 +1,662 @@
+// ------------------------------------------------------------------
+//   acgt.c
+//   Copyright (C) 2025-2025 Genozip Limited. Patent Pending.
+//   Please see terms and conditions in the file LICENSE.txt
+//
+//   WARNING: Genozip is proprietary, not open source software. Modifying the source code is strictly prohibited,
+//   under penalties specified in the license.
+
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#elif defined __SSE2__
+#include <emmintrin.h>
+#endif
+#if defined __x86_64__ && defined __GNUC__
+#include <immintrin.h>
+#define ACGT_HAS_AVX2
+#define AVX2_FUNC __attribute__((target("avx2")))
+#endif
+#include "genozip.h"
+#include "acgt.h"
+#include "bits.h"
+#include "codec.h"
+#include "profiler.h"
+#include "reference.h"
+
+typedef enum { ACGT_SCALAR, ACGT_SIMD/*SSSE3, or just SSE2*/, ACGT_AVX2, NUM_ACGT_LEVELS } AcgtLevel;
+
+static AcgtLevel acgt_best_level (void)
+{
+#ifdef ACGT_HAS_AVX2
+    static int has_avx2 = -1; // benign race: all threads calculate the same value
+    if (__builtin_expect (has_avx2 < 0, false)) has_avx2 = __builtin_cpu_supports ("avx2");
+    if (has_avx2) return ACGT_AVX2;
+#endif
+    return ACGT_SIMD;
+}
+
+// same as acgt_encode, but strictly for upper case A,C,G,T (like nuke_encode), anything else is 4
+static const uint8_t acgt_encode_strict[256] = { [0 ... 255]=4, ['A']=0, ['C']=1, ['G']=2, ['T']=3 };
+
+// A,C,G,T (upper or lower case) are encoded by their bits 1,2: ((c>>1) ^ (c>>2)) & 3 is 0,1,2,3 for A,C,G,T
+#define ACGT_CODES_MASK 0x03
+
+//------------------------------------------------------
+// Pack: ASCII -> 2 bit
+//------------------------------------------------------
+
+// packs 4*n_bytes bases into whole bytes. returns false if any character is not A,C,G,T (strict) or A,C,G,T,a,c,g,t (non-strict)
+static inline bool acgt_pack_bytes_scalar (rom seq, uint32_t n_bytes, uint8_t *out, bool strict)
+{
+    bool all_acgt = true;
+    const uint8_t *encode = strict ? acgt_encode_strict : acgt_encode;
+
+    for (uint32_t i=0; i < n_bytes; i++, seq += 4) {
+        uint8_t e[4] = { encode[(uint8_t)seq[0]], encode[(uint8_t)seq[1]], encode[(uint8_t)seq[2]], encode[(uint8_t)seq[3]] };
+
+        if (strict && __builtin_expect ((e[0] | e[1] | e[2] | e[3]) & 4, false)) {
+            all_acgt = false;
+            for (int b=0; b < 4; b++) e[b] &= 3; // 4 -> 0 ('A')
+        }
+
+        out[i] = e[0] | (e[1] << 2) | (e[2] << 4) | (e[3] << 6);
+    }
+
+    return all_acgt;
+}
+
+#ifdef __SSSE3__
+// 16 bases -> 4 bytes
+static inline bool acgt_pack16_ssse3 (rom seq, uint8_t *out, bool strict)
+{
+    __m128i v = _mm_loadu_si128 ((const __m128i *)seq);
+    __m128i u = strict ? v : _mm_and_si128 (v, _mm_set1_epi8 ((char)0xDF)); // upper-case A,C,G,T (other characters might alias, but not to A,C,G,T)
+
+    __m128i is_acgt = _mm_or_si128 (_mm_or_si128 (_mm_cmpeq_epi8 (u, _mm_set1_epi8 ('A')), _mm_cmpeq_epi8 (u, _mm_set1_epi8 ('C'))),
+                                    _mm_or_si128 (_mm_cmpeq_epi8 (u, _mm_set1_epi8 ('G')), _mm_cmpeq_epi8 (u, _mm_set1_epi8 ('T'))));
+    if (_mm_movemask_epi8 (is_acgt) != 0xffff) return false;
+
+    __m128i codes = _mm_and_si128 (_mm_xor_si128 (_mm_srli_epi16 (v, 1), _mm_srli_epi16 (v, 2)), _mm_set1_epi8 (ACGT_CODES_MASK));
+    __m128i pairs = _mm_maddubs_epi16 (codes, _mm_set1_epi16 (0x0401));     // c0 + 4*c1
+    __m128i quads = _mm_madd_epi16 (pairs, _mm_set1_epi32 (0x00100001));    // p0 + 16*p1 - one byte in each 32 bit lane
+    uint32_t packed = _mm_cvtsi128_si32 (_mm_shuffle_epi8 (quads, _mm_setr_epi8 (0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)));
+
+    memcpy (out, &packed, 4);
+    return true;
+}
+
+#endif
+
+#ifdef ACGT_HAS_AVX2
+// 32 bases -> 8 bytes
+AVX2_FUNC static inline bool acgt_pack32_avx2 (rom seq, uint8_t *out, bool strict)
+{
+    __m256i v = _mm256_loadu_si256 ((const __m256i *)seq);
+    __m256i u = strict ? v : _mm256_and_si256 (v, _mm256_set1_epi8 ((char)0xDF));
+
+    __m256i is_acgt = _mm256_or_si256 (_mm256_or_si256 (_mm256_cmpeq_epi8 (u, _mm256_set1_epi8 ('A')), _mm256_cmpeq_epi8 (u, _mm256_set1_epi8 ('C'))),
+                                       _mm256_or_si256 (_mm256_cmpeq_epi8 (u, _mm256_set1_epi8 ('G')), _mm256_cmpeq_epi8 (u, _mm256_set1_epi8 ('T'))));
+    if (_mm256_movemask_epi8 (is_acgt) != -1) return false;
+
+    __m256i codes = _mm256_and_si256 (_mm256_xor_si256 (_mm256_srli_epi16 (v, 1), _mm256_srli_epi16 (v, 2)), _mm256_set1_epi8 (ACGT_CODES_MASK));
+    __m256i pairs = _mm256_maddubs_epi16 (codes, _mm256_set1_epi16 (0x0401));
+    __m256i quads = _mm256_madd_epi16 (pairs, _mm256_set1_epi32 (0x00100001));
+    __m256i lanes = _mm256_shuffle_epi8 (quads, _mm256_setr_epi8 (0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                                  0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1));
+    lanes = _mm256_permutevar8x32_epi32 (lanes, _mm256_setr_epi32 (0, 4, 0, 0, 0, 0, 0, 0)); // bring the 4 bytes of the high lane next to the low lane's
+
+    _mm_storel_epi64 ((__m128i *)out, _mm256_castsi256_si128 (lanes));
+    return true;
+}
+
+AVX2_FUNC static uint32_t acgt_pack_avx2 (rom seq, uint32_t seq_len, uint8_t *out, bool strict, bool *all_acgt)
+{
+    uint32_t i=0;
+    for (; i + 32 <= seq_len; i += 32, out += 8)
+        if (__builtin_expect (!acgt_pack32_avx2 (&seq[i], out, strict), false))
+            *all_acgt &= acgt_pack_bytes_scalar (&seq[i], 8, out, strict);
+
+    return i;
+}
+#endif
+
+static uint32_t acgt_pack_simd (rom seq, uint32_t seq_len, uint8_t *out, bool strict, bool *all_acgt)
+{
+    uint32_t i=0;
+#ifdef __SSSE3__
+    for (; i + 16 <= seq_len; i += 16, out += 4)
+        if (__builtin_expect (!acgt_pack16_ssse3 (&seq[i], out, strict), false))
+            *all_acgt &= acgt_pack_bytes_scalar (&seq[i], 4, out, strict);
+#endif
+    return i;
+}
+
+static bool acgt_pack_do (AcgtLevel level, BitsP packed, uint64_t next_bit, STRp(seq), bool strict)
+{
+    const uint8_t *encode = strict ? acgt_encode_strict : acgt_encode;
+    bool all_acgt = true;
+    uint32_t i=0;
+
+    #define PACK_ONE { uint8_t e = encode[(uint8_t)seq[i]];     \
+                       if (e == 4) { all_acgt = false; e = 0; } \
+                       bits_assign2 (packed, next_bit, e); }
+
+    // scalar until we reach a byte boundary in packed
+    for (; i < seq_len && (next_bit % 8); i++, next_bit += 2) PACK_ONE;
+
+    // whole bytes
+    uint8_t *out = (uint8_t *)packed->words + next_bit / 8;
+    uint32_t done = (level == ACGT_SCALAR) ? 0
+#ifdef ACGT_HAS_AVX2
+                  : (level == ACGT_AVX2)   ? acgt_pack_avx2 (&seq[i], seq_len - i, out, strict, &all_acgt)
+#endif
+                  :                          acgt_pack_simd (&seq[i], seq_len - i, out, strict, &all_acgt);
+
+    uint32_t n_bytes = (seq_len - i - done) / 4; // remaining whole bytes
+    all_acgt &= acgt_pack_bytes_scalar (&seq[i + done], n_bytes, out + done / 4, strict);
+
+    done += n_bytes * 4;
+    i += done;
+    next_bit += done * 2;
+
+    // remaining 0-3 bases
+    for (; i < seq_len; i++, next_bit += 2) PACK_ONE;
+
+    #undef PACK_ONE
+    return all_acgt;
+}
+
+void acgt_pack (BitsP packed, uint64_t next_bit, STRp(seq))
+{
+    acgt_pack_do (acgt_best_level(), packed, next_bit, STRa(seq), false);
+}
+
+bool acgt_pack_strict (BitsP packed, STRp(seq))
+{
+    return acgt_pack_do (acgt_best_level(), packed, 0, STRa(seq), true);
+}
+
+//------------------------------------------------------
+// NONREF_X exceptions
+//------------------------------------------------------
+
+#ifdef __SSE2__
+static inline __m128i acgt_exceptions16 (__m128i v)
+{
+    __m128i u = _mm_and_si128 (v, _mm_set1_epi8 ((char)0xDF));
+    __m128i is_acgt = _mm_or_si128 (_mm_or_si128 (_mm_cmpeq_epi8 (u, _mm_set1_epi8 ('A')), _mm_cmpeq_epi8 (u, _mm_set1_epi8 ('C'))),
+                                    _mm_or_si128 (_mm_cmpeq_epi8 (u, _mm_set1_epi8 ('G')), _mm_cmpeq_epi8 (u, _mm_set1_epi8 ('T'))));
+    __m128i is_lower = _mm_and_si128 (_mm_srli_epi16 (v, 5), _mm_set1_epi8 (1)); // bit 5 is the lower-case bit of a,c,g,t
+
+    return _mm_or_si128 (_mm_and_si128 (is_acgt, is_lower), _mm_andnot_si128 (is_acgt, v));
+}
+#endif
+
+#ifdef ACGT_HAS_AVX2
+AVX2_FUNC static uint32_t acgt_get_exceptions_avx2 (STRp(seq), uint8_t *x)
+{
+    uint32_t i=0;
+    for (; i + 32 <= seq_len; i += 32) {
+        __m256i v = _mm256_loadu_si256 ((const __m256i *)&seq[i]);
+        __m256i u = _mm256_and_si256 (v, _mm256_set1_epi8 ((char)0xDF));
+        __m256i is_acgt = _mm256_or_si256 (_mm256_or_si256 (_mm256_cmpeq_epi8 (u, _mm256_set1_epi8 ('A')), _mm256_cmpeq_epi8 (u, _mm256_set1_epi8 ('C'))),
+                                           _mm256_or_si256 (_mm256_cmpeq_epi8 (u, _mm256_set1_epi8 ('G')), _mm256_cmpeq_epi8 (u, _mm256_set1_epi8 ('T'))));
+        __m256i is_lower = _mm256_and_si256 (_mm256_srli_epi16 (v, 5), _mm256_set1_epi8 (1));
+
+        _mm256_storeu_si256 ((__m256i *)&x[i], _mm256_or_si256 (_mm256_and_si256 (is_acgt, is_lower), _mm256_andnot_si256 (is_acgt, v)));
+    }
+
+    return i;
+}
+#endif
+
+static void acgt_get_exceptions_do (AcgtLevel level, STRp(seq), uint8_t *x)
+{
+    // table to convert SEQ data to ACGT exceptions. The character is XORed with the entry in the table
+    static const uint8_t acgt_exceptions[256] = {
+        ['A']='A',   ['C']='C',   ['G']='G',   ['T']='T',  // -->0 (XORed with self)
+        ['a']='a'^1, ['c']='c'^1, ['g']='g'^1, ['t']='t'^1 // -->1 (XORed with self XOR 1)
+    };                                                     // all others are XORed with 0 and hence remain unchanged
+
+    uint32_t i=0;
+#ifdef ACGT_HAS_AVX2
+    if (level == ACGT_AVX2)
+        i = acgt_get_exceptions_avx2 (STRa(seq), x);
+#endif
+
+#ifdef __SSE2__
+    if (level != ACGT_SCALAR)
+        for (; i + 16 <= seq_len; i += 16)
+            _mm_storeu_si128 ((__m128i *)&x[i], acgt_exceptions16 (_mm_loadu_si128 ((const __m128i *)&seq[i])));
+#endif
+
+    for (; i < seq_len; i++)
+        x[i] = (uint8_t)seq[i] ^ acgt_exceptions[(uint8_t)seq[i]];
+}
+
+void acgt_get_exceptions (STRp(seq), uint8_t *x)
+{
+    acgt_get_exceptions_do (acgt_best_level(), STRa(seq), x);
+}
+
+//------------------------------------------------------
+// Unpack: 2 bit -> ASCII
+//------------------------------------------------------
+
+#define ACGT_FIRST_OF_NIBBLE  'A','C','G','T','A','C','G','T','A','C','G','T','A','C','G','T' // "ACGT"[n & 3]
+#define ACGT_SECOND_OF_NIBBLE 'A','A','A','A','C','C','C','C','G','G','G','G','T','T','T','T' // "ACGT"[n >> 2]
+
+#ifdef __SSSE3__
+// x==0: base as is ; x==1: lower case base ; otherwise: x
+static inline __m128i acgt_apply_x16 (__m128i bases, const uint8_t *acgt_x)
+{
+    __m128i x = _mm_loadu_si128 ((const __m128i *)acgt_x);
+    __m128i lower = _mm_and_si128 (_mm_cmpeq_epi8 (x, _mm_set1_epi8 (1)), _mm_set1_epi8 (32));
+    __m128i is_01 = _mm_cmpeq_epi8 (_mm_and_si128 (x, _mm_set1_epi8 ((char)0xFE)), _mm_setzero_si128());
+
+    return _mm_or_si128 (_mm_and_si128 (is_01, _mm_or_si128 (bases, lower)), _mm_andnot_si128 (is_01, x));
+}
+
+// 8 bytes -> 32 bases
+static uint64_t acgt_unpack_simd (const uint8_t *packed, const uint8_t *acgt_x, uint64_t n_bases, char *out)
+{
+    const __m128i first_lut  = _mm_setr_epi8 (ACGT_FIRST_OF_NIBBLE);
+    const __m128i second_lut = _mm_setr_epi8 (ACGT_SECOND_OF_NIBBLE);
+    const __m128i nibble     = _mm_set1_epi8 (0x0F);
+
+    uint64_t i=0;
+    for (; i + 32 <= n_bases; i += 32, packed += 8) {
+        __m128i b   = _mm_loadl_epi64 ((const __m128i *)packed);
+        __m128i nib = _mm_unpacklo_epi8 (_mm_and_si128 (b, nibble), _mm_and_si128 (_mm_srli_epi16 (b, 4), nibble)); // 16 nibbles in base order
+        __m128i first  = _mm_shuffle_epi8 (first_lut,  nib);
+        __m128i second = _mm_shuffle_epi8 (second_lut, nib);
+        __m128i lo = _mm_unpacklo_epi8 (first, second);
+        __m128i hi = _mm_unpackhi_epi8 (first, second);
+
+        if (acgt_x) {
+            lo = acgt_apply_x16 (lo, &acgt_x[i]);
+            hi = acgt_apply_x16 (hi, &acgt_x[i + 16]);
+        }
+
+        _mm_storeu_si128 ((__m128i *)&out[i],      lo);
+        _mm_storeu_si128 ((__m128i *)&out[i + 16], hi);
+    }
+
+    return i;
+}
+#else
+static uint64_t acgt_unpack_simd (const uint8_t *packed, const uint8_t *acgt_x, uint64_t n_bases, char *out) { return 0; }
+#endif
+
+#ifdef ACGT_HAS_AVX2
+AVX2_FUNC static inline __m256i acgt_apply_x32 (__m256i bases, const uint8_t *acgt_x)
+{
+    __m256i x = _mm256_loadu_si256 ((const __m256i *)acgt_x);
+    __m256i lower = _mm256_and_si256 (_mm256_cmpeq_epi8 (x, _mm256_set1_epi8 (1)), _mm256_set1_epi8 (32));
+    __m256i is_01 = _mm256_cmpeq_epi8 (_mm256_and_si256 (x, _mm256_set1_epi8 ((char)0xFE)), _mm256_setzero_si256());
+
+    return _mm256_or_si256 (_mm256_and_si256 (is_01, _mm256_or_si256 (bases, lower)), _mm256_andnot_si256 (is_01, x));
+}
+
+// 16 bytes -> 64 bases
+AVX2_FUNC static uint64_t acgt_unpack_avx2 (const uint8_t *packed, const uint8_t *acgt_x, uint64_t n_bases, char *out)
+{
+    const __m256i first_lut  = _mm256_setr_epi8 (ACGT_FIRST_OF_NIBBLE, ACGT_FIRST_OF_NIBBLE);
+    const __m256i second_lut = _mm256_setr_epi8 (ACGT_SECOND_OF_NIBBLE, ACGT_SECOND_OF_NIBBLE);
+    const __m128i nibble     = _mm_set1_epi8 (0x0F);
+
+    uint64_t i=0;
+    for (; i + 64 <= n_bases; i += 64, packed += 16) {
+        __m128i b  = _mm_loadu_si128 ((const __m128i *)packed);
+        __m128i lo_nib = _mm_and_si128 (b, nibble), hi_nib = _mm_and_si128 (_mm_srli_epi16 (b, 4), nibble);
+        __m256i nib = _mm256_inserti128_si256 (_mm256_castsi128_si256 (_mm_unpacklo_epi8 (lo_nib, hi_nib)), _mm_unpackhi_epi8 (lo_nib, hi_nib), 1);
+
+        __m256i first  = _mm256_shuffle_epi8 (first_lut,  nib);
+        __m256i second = _mm256_shuffle_epi8 (second_lut, nib);
+        __m256i a = _mm256_unpacklo_epi8 (first, second); // bases 0-15, 32-47
+        __m256i c = _mm256_unpackhi_epi8 (first, second); // bases 16-31, 48-63
+        __m256i out0 = _mm256_permute2x128_si256 (a, c, 0x20);
+        __m256i out1 = _mm256_permute2x128_si256 (a, c, 0x31);
+
+        if (acgt_x) {
+            out0 = acgt_apply_x32 (out0, &acgt_x[i]);
+            out1 = acgt_apply_x32 (out1, &acgt_x[i + 32]);
+        }
+
+        _mm256_storeu_si256 ((__m256i *)&out[i],      out0);
+        _mm256_storeu_si256 ((__m256i *)&out[i + 32], out1);
+    }
+
+    return i;
+}
+#endif
+
+static void acgt_unpack_do (AcgtLevel level, ConstBitsP packed, const uint8_t *acgt_x, uint64_t n_bases, char *out)
+{
+    const uint8_t *bytes = (const uint8_t *)packed->words;
+    uint64_t i=0;
+
+#ifdef ACGT_HAS_AVX2
+    if (level == ACGT_AVX2)
+        i = acgt_unpack_avx2 (bytes, acgt_x, n_bases, out);
+#endif
+
+    if (level != ACGT_SCALAR)
+        i += acgt_unpack_simd (&bytes[i / 4], acgt_x ? &acgt_x[i] : NULL, n_bases - i, &out[i]);
+
+    decl_acgt_decode;
+    for (; i < n_bases; i++) {
+        if      (!acgt_x || acgt_x[i] == 0) out[i] = base_by_idx(packed, i);      // case 0: use acgt as is - 'A', 'C', 'G' or 'T'
+        else if (           acgt_x[i] == 1) out[i] = base_by_idx(packed, i) + 32; // case 1: convert to lower case - 'a', 'c', 'g' or 't'
+        else                                out[i] = acgt_x[i];                   // case non-0/1: use acgt_x (this is usually, but not necessarily, 'N')
+    }
+}
+
+void acgt_unpack (ConstBitsP packed, const uint8_t *acgt_x, uint64_t n_bases, char *out)
+{
+    acgt_unpack_do (acgt_best_level(), packed, acgt_x, n_bases, out);
+}
+
+//------------------------------------------------------
+// Reverse complement of whole words (32 bases each)
+//------------------------------------------------------
+
+// complement is ~w (00=A <-> 11=T, 01=C <-> 10=G), followed by reversing the order of the 32 2-bit bases
+static inline uint64_t acgt_revcomp_word (uint64_t w)
+{
+    w = __builtin_bswap64 (~w);                                                         // reverse bytes
+    w = ((w >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((w & 0x0F0F0F0F0F0F0F0FULL) << 4);        // reverse nibbles within each byte
+    return ((w >> 2) & 0x3333333333333333ULL) | ((w & 0x3333333333333333ULL) << 2);     // reverse bases within each nibble
+}
+
+// revcomp of a nibble (2 bases) - in the high nibble for a low nibble of the source byte and vice versa
+#define RC(n,s) (char)((n) << (s))
+#define ACGT_RC_NIBBLE(s) RC(15,s), RC(11,s), RC(7,s), RC(3,s), RC(14,s), RC(10,s), RC(6,s), RC(2,s), RC(13,s), RC(9,s), RC(5,s), RC(1,s), RC(12,s), RC(8,s), RC(4,s), RC(0,s)
+
+#ifdef __SSSE3__
+static uint64_t acgt_revcomp_simd (uint64_t *dst, const uint64_t *src, uint64_t n_words)
+{
+    const __m128i rev_bytes = _mm_setr_epi8 (15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    const __m128i lo_lut    = _mm_setr_epi8 (ACGT_RC_NIBBLE(4)); // source low nibble -> high nibble
+    const __m128i hi_lut    = _mm_setr_epi8 (ACGT_RC_NIBBLE(0)); // source high nibble -> low nibble
+    const __m128i nibble    = _mm_set1_epi8 (0x0F);
+
+    uint64_t i=0;
+    for (; i + 2 <= n_words; i += 2) {
+        __m128i v = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *)&src[i]), rev_bytes);
+        __m128i rc = _mm_or_si128 (_mm_shuffle_epi8 (lo_lut, _mm_and_si128 (v, nibble)),
+                                   _mm_shuffle_epi8 (hi_lut, _mm_and_si128 (_mm_srli_epi16 (v, 4), nibble)));
+
+        _mm_storeu_si128 ((__m128i *)&dst[n_words - 2 - i], rc);
+    }
+
+    return i;
+}
+#else
+static uint64_t acgt_revcomp_simd (uint64_t *dst, const uint64_t *src, uint64_t n_words) { return 0; } // note: acgt_revcomp_word is already SWAR
+#endif
+
+#ifdef ACGT_HAS_AVX2
+AVX2_FUNC static uint64_t acgt_revcomp_avx2 (uint64_t *dst, const uint64_t *src, uint64_t n_words)
+{
+    const __m256i rev_bytes = _mm256_setr_epi8 (15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+                                                15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    const __m256i lo_lut    = _mm256_setr_epi8 (ACGT_RC_NIBBLE(4), ACGT_RC_NIBBLE(4));
+    const __m256i hi_lut    = _mm256_setr_epi8 (ACGT_RC_NIBBLE(0), ACGT_RC_NIBBLE(0));
+    const __m256i nibble    = _mm256_set1_epi8 (0x0F);
+
+    uint64_t i=0;
+    for (; i + 4 <= n_words; i += 4) {
+        __m256i v = _mm256_shuffle_epi8 (_mm256_loadu_si256 ((const __m256i *)&src[i]), rev_bytes); // reverse bytes within each lane...
+        v = _mm256_permute4x64_epi64 (v, 0x4E);                                                         // ...and swap the lanes
+        __m256i rc = _mm256_or_si256 (_mm256_shuffle_epi8 (lo_lut, _mm256_and_si256 (v, nibble)),
+                                      _mm256_shuffle_epi8 (hi_lut, _mm256_and_si256 (_mm256_srli_epi16 (v, 4), nibble)));
+
+        _mm256_storeu_si256 ((__m256i *)&dst[n_words - 4 - i], rc);
+    }
+
+    return i;
+}
+#endif
+
+static void acgt_revcomp_words_do (AcgtLevel level, uint64_t *dst, const uint64_t *src, uint64_t n_words)
+{
+    uint64_t i=0;
+
+#ifdef ACGT_HAS_AVX2
+    if (level == ACGT_AVX2)
+        i = acgt_revcomp_avx2 (dst, src, n_words);
+#endif
+
+    // note: dst offset is relative to the end, so the remaining words are a smaller instance of the same problem
+    if (level != ACGT_SCALAR)
+        i += acgt_revcomp_simd (dst, &src[i], n_words - i);
+
+    for (; i < n_words; i++)
+        dst[n_words-1 - i] = acgt_revcomp_word (src[i]);
+}
+
+void acgt_revcomp_words (uint64_t *dst, const uint64_t *src, uint64_t n_words)
+{
+    acgt_revcomp_words_do (acgt_best_level(), dst, src, n_words);
+}
+
+//------------------------------------------------------
+// BAM SEQ: ASCII -> 4 bit, 2 bases per byte, first base in the high nibble
+//------------------------------------------------------
+
+// the characters "=ACMGRSVTWYHKDBN" are mapped to BAM 0->15. All other characters are mapped to 0 (piz doesn't verify)
+static const uint8_t sam2bam_seq_map[256] = { ['=']=0x0, ['A']=0x1, ['C']=0x2, ['M']=0x3, ['G']=0x4, ['R']=0x5, ['S']=0x6, ['V']=0x7, 
+                                              ['T']=0x8, ['W']=0x9, ['Y']=0xa, ['H']=0xb, ['K']=0xc, ['D']=0xd, ['B']=0xe, ['N']=0xf };
+
+static inline void acgt_seq_to_bam_scalar (rom seq, uint32_t n_bytes, uint8_t *out)
+{
+    for (uint32_t i=0; i < n_bytes; i++, seq += 2) 
+        out[i] = (sam2bam_seq_map[(uint8_t)seq[0]] << 4) | sam2bam_seq_map[(uint8_t)seq[1]];
+}
+
+#ifdef __SSSE3__
+// 16 bases -> 8 bytes. returns false, without writing, if any character is not an upper case A,C,G,T,N
+static inline bool acgt_seq_to_bam16_ssse3 (rom seq, uint8_t *out)
+{
+    __m128i v = _mm_loadu_si128 ((const __m128i *)seq);
+
+    __m128i is_N    = _mm_cmpeq_epi8 (v, _mm_set1_epi8 ('N'));
+    __m128i is_acgt = _mm_or_si128 (_mm_or_si128 (_mm_cmpeq_epi8 (v, _mm_set1_epi8 ('A')), _mm_cmpeq_epi8 (v, _mm_set1_epi8 ('C'))),
+                                    _mm_or_si128 (_mm_cmpeq_epi8 (v, _mm_set1_epi8 ('G')), _mm_cmpeq_epi8 (v, _mm_set1_epi8 ('T'))));
+    if (_mm_movemask_epi8 (_mm_or_si128 (is_acgt, is_N)) != 0xffff) return false;
+
+    __m128i codes   = _mm_and_si128 (_mm_xor_si128 (_mm_srli_epi16 (v, 1), _mm_srli_epi16 (v, 2)), _mm_set1_epi8 (ACGT_CODES_MASK));
+    __m128i nibbles = _mm_shuffle_epi8 (_mm_setr_epi8 (1, 2, 4, 8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0), codes); // A,C,G,T -> 1,2,4,8
+    nibbles = _mm_or_si128 (nibbles, _mm_and_si128 (is_N, _mm_set1_epi8 (0xf)));                               // N -> 0xf
+    __m128i pairs   = _mm_maddubs_epi16 (nibbles, _mm_set1_epi16 (0x0110));                                     // 16*n0 + n1
+
+    _mm_storel_epi64 ((__m128i *)out, _mm_packus_epi16 (pairs, pairs));
+    return true;
+}
+#endif
+
+#ifdef ACGT_HAS_AVX2
+// 32 bases -> 16 bytes
+AVX2_FUNC static inline bool acgt_seq_to_bam32_avx2 (rom seq, uint8_t *out)
+{
+    __m256i v = _mm256_loadu_si256 ((const __m256i *)seq);
+
+    __m256i is_N    = _mm256_cmpeq_epi8 (v, _mm256_set1_epi8 ('N'));
+    __m256i is_acgt = _mm256_or_si256 (_mm256_or_si256 (_mm256_cmpeq_epi8 (v, _mm256_set1_epi8 ('A')), _mm256_cmpeq_epi8 (v, _mm256_set1_epi8 ('C'))),
+                                       _mm256_or_si256 (_mm256_cmpeq_epi8 (v, _mm256_set1_epi8 ('G')), _mm256_cmpeq_epi8 (v, _mm256_set1_epi8 ('T'))));
+    if (_mm256_movemask_epi8 (_mm256_or_si256 (is_acgt, is_N)) != -1) return false;
+
+    __m256i codes   = _mm256_and_si256 (_mm256_xor_si256 (_mm256_srli_epi16 (v, 1), _mm256_srli_epi16 (v, 2)), _mm256_set1_epi8 (ACGT_CODES_MASK));
+    __m256i nibbles = _mm256_shuffle_epi8 (_mm256_setr_epi8 (1, 2, 4, 8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                                             1, 2, 4, 8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0), codes);
+    nibbles = _mm256_or_si256 (nibbles, _mm256_and_si256 (is_N, _mm256_set1_epi8 (0xf)));
+    __m256i pairs   = _mm256_maddubs_epi16 (nibbles, _mm256_set1_epi16 (0x0110));
+    __m256i packed  = _mm256_permute4x64_epi64 (_mm256_packus_epi16 (pairs, pairs), 0x08); // bring the 8 bytes of the high lane next to the low lane's
+
+    _mm_storeu_si128 ((__m128i *)out, _mm256_castsi256_si128 (packed));
+    return true;
+}
+
+AVX2_FUNC static uint32_t acgt_seq_to_bam_avx2 (rom seq, uint32_t seq_len, uint8_t *out)
+{
+    uint32_t i=0;
+    for (; i + 32 <= seq_len; i += 32, out += 16)
+        if (__builtin_expect (!acgt_seq_to_bam32_avx2 (&seq[i], out), false))
+            acgt_seq_to_bam_scalar (&seq[i], 16, out);
+
+    return i;
+}
+#endif
+
+static uint32_t acgt_seq_to_bam_simd (rom seq, uint32_t seq_len, uint8_t *out)
+{
+    uint32_t i=0;
+#ifdef __SSSE3__
+    for (; i + 16 <= seq_len; i += 16, out += 8)
+        if (__builtin_expect (!acgt_seq_to_bam16_ssse3 (&seq[i], out), false))
+            acgt_seq_to_bam_scalar (&seq[i], 8, out);
+#endif
+    return i;
+}
+
+// note: each block of bases is loaded before its (half as long) output is stored, so out may be the same as seq
+static void acgt_seq_to_bam_do (AcgtLevel level, STRp(seq), uint8_t *out)
+{
+    uint32_t i=0;
+
+#ifdef ACGT_HAS_AVX2
+    if (level == ACGT_AVX2)
+        i = acgt_seq_to_bam_avx2 (STRa(seq), out);
+#endif
+
+    if (level != ACGT_SCALAR)
+        i += acgt_seq_to_bam_simd (&seq[i], seq_len - i, &out[i / 2]);
+
+    acgt_seq_to_bam_scalar (&seq[i], (seq_len - i) / 2, &out[i / 2]);
+
+    // if seq_len is odd, the low nibble of the last byte is 0
+    if (seq_len % 2) 
+        out[seq_len / 2] = sam2bam_seq_map[(uint8_t)seq[seq_len-1]] << 4;
+}
+
+void acgt_seq_to_bam (STRp(seq), uint8_t *out)
+{
+    acgt_seq_to_bam_do (acgt_best_level(), STRa(seq), out);
+}
+
+//------------------------------------------------------
+// Microbenchmark: genozip --bench-acgt (developer builds only)
+// verifies each level against the scalar implementation and reports its throughput
+//------------------------------------------------------
+
+#ifdef DEBUG
+
+static rom level_names[NUM_ACGT_LEVELS] = { "scalar",
+#ifdef __SSSE3__
+                                            "ssse3",
+#else
+                                            "sse2",
+#endif
+                                            "avx2" };
+
+#define BENCH_BASES (64 MB)
+#define BENCH_READ_LEN 151         // seq2bam-ip: in-place, read by read, as in sam_piz_sam2bam_SEQ. Odd, so the last base of each read is packed separately
+#define SEQ2BAM_TARGET_SPEEDUP 1.5 // vs. scalar
+#define BENCH_REPS 5               // each kernel is reported at its fastest repetition, to reduce noise
+
+typedef enum { BENCH_PACK_ACGT, BENCH_PACK, BENCH_X, BENCH_UNPACK, BENCH_REVCOMP, BENCH_SEQ2BAM, BENCH_SEQ2BAM_IP, NUM_BENCH_KERNELS } BenchKernel;
+static rom kernel_names[NUM_BENCH_KERNELS] = { "pack-acgt", "pack", "x", "unpack", "revcomp", "seq2bam", "seq2bam-ip" };
+
+static void acgt_bench_report (BenchKernel kernel, AcgtLevel level, int rep, TimeSpecType profiler_timer, bool matches, double target_speedup)
+{
+    static double scalar_mbps[NUM_BENCH_KERNELS];
+    static uint64_t best_nsec[NUM_BENCH_KERNELS];
+    static bool all_match[NUM_BENCH_KERNELS];
+
+    uint64_t nsec = MAX_(CHECK_TIMER, 1);
+    best_nsec[kernel] = rep ? MIN_(best_nsec[kernel], nsec) : nsec;
+    all_match[kernel] = (rep ? all_match[kernel] : true) && matches;
+
+    if (rep < BENCH_REPS - 1) return;
+
+    double mbps = (double)BENCH_BASES * 1000.0 / (double)best_nsec[kernel];
+
+    if (level == ACGT_SCALAR) {
+        scalar_mbps[kernel] = mbps;
+        printf ("%-10s %-7s %8.0f MB/s\n", kernel_names[kernel], level_names[level], mbps);
+    }
+
+    else {
+        double speedup = mbps / scalar_mbps[kernel];
+        printf ("%-10s %-7s %8.0f MB/s x%.2f%s%s\n", kernel_names[kernel], level_names[level], mbps, speedup, 
+                (target_speedup && speedup < target_speedup) ? " BELOW TARGET" : "", all_match[kernel] ? "" : " MISMATCH");
+    }
+}
+
+void acgt_benchmark (void)
+{
+    uint64_t n_words = BENCH_BASES / 32;
+    char *seq = MALLOC (BENCH_BASES);
+    char *out[2], *inplace[2]; uint8_t *x[2], *bam[2]; uint64_t *pack[2], *strict[2], *rc[2]; // [0] is the scalar reference
+    for (int i=0; i < 2; i++) { // memset, so page faults are not counted in the timing
+        out[i]     = memset (MALLOC (BENCH_BASES), 0, BENCH_BASES);
+        inplace[i] = memset (MALLOC (BENCH_BASES), 0, BENCH_BASES);
+        bam[i]     = memset (MALLOC (BENCH_BASES / 2), 0, BENCH_BASES / 2);
+        x[i]      = memset (MALLOC (BENCH_BASES), 0, BENCH_BASES);
+        pack[i]   = memset (MALLOC (n_words * 8), 0, n_words * 8);
+        strict[i] = memset (MALLOC (n_words * 8), 0, n_words * 8);
+        rc[i]     = memset (MALLOC (n_words * 8), 0, n_words * 8);
+    }
+
+    // mostly upper case A,C,G,T, with occasional runs of lower case and N
+    uint64_t rnd = 0x9E3779B97F4A7C15ULL;
+    for (uint64_t i=0; i < BENCH_BASES; i++) {
+        rnd ^= rnd << 13; rnd ^= rnd >> 7; rnd ^= rnd << 17; // xorshift64
+        seq[i] = "ACGT"[rnd & 3];
+        if ((rnd >> 20) % 4096 == 0) seq[i] = 'N';
+        else if (((i >> 10) & 15) == 7) seq[i] += 32;
+    }
+
+    AcgtLevel best_level = acgt_best_level();
+    for (AcgtLevel level=ACGT_SCALAR; level <= best_level; level++) {
+      for (int rep=0; rep < BENCH_REPS; rep++) {
+        int t = (level != ACGT_SCALAR); // index of the target arrays
+        #define SAME(arr, len) (!t || !memcmp (arr[0], arr[1], (len)))
+
+        Bits packed = { .nbits = BENCH_BASES * 2, .nwords = n_words, .words = strict[t], .type = BUF_REGULAR };
+        { START_TIMER_ALWAYS; acgt_pack_do (level, &packed, 0, seq, BENCH_BASES, true);
+          acgt_bench_report (BENCH_PACK_ACGT, level, rep, profiler_timer, SAME (strict, n_words * 8), 0); }
+
+        packed.words = pack[t];
+        { START_TIMER_ALWAYS; acgt_pack_do (level, &packed, 0, seq, BENCH_BASES, false);
+          acgt_bench_report (BENCH_PACK, level, rep, profiler_timer, SAME (pack, n_words * 8), 0); }
+
+        { START_TIMER_ALWAYS; acgt_get_exceptions_do (level, seq, BENCH_BASES, x[t]);
+          acgt_bench_report (BENCH_X, level, rep, profiler_timer, SAME (x, BENCH_BASES), 0); }
+
+        { START_TIMER_ALWAYS; acgt_unpack_do (level, &packed, x[t], BENCH_BASES, out[t]);
+          acgt_bench_report (BENCH_UNPACK, level, rep, profiler_timer, SAME (out, BENCH_BASES), 0); }
+
+        { START_TIMER_ALWAYS; acgt_revcomp_words_do (level, rc[t], pack[t], n_words);
+          acgt_bench_report (BENCH_REVCOMP, level, rep, profiler_timer, SAME (rc, n_words * 8), 0); }
+
+        { START_TIMER_ALWAYS; acgt_seq_to_bam_do (level, seq, BENCH_BASES, bam[t]);
+          acgt_bench_report (BENCH_SEQ2BAM, level, rep, profiler_timer, SAME (bam, BENCH_BASES / 2), SEQ2BAM_TARGET_SPEEDUP); }
+
+        // in place, read by read: only the first half of each read is overwritten, the rest of the buffer remains the same
+        memcpy (inplace[t], seq, BENCH_BASES);
+        { START_TIMER_ALWAYS; 
+          for (uint64_t r=0; r + BENCH_READ_LEN <= BENCH_BASES; r += BENCH_READ_LEN)
+              acgt_seq_to_bam_do (level, &inplace[t][r], BENCH_READ_LEN, (uint8_t *)&inplace[t][r]);
+          acgt_bench_report (BENCH_SEQ2BAM_IP, level, rep, profiler_timer, SAME (inplace, BENCH_BASES), SEQ2BAM_TARGET_SPEEDUP); }
+
+        #undef SAME
+      }
+    }
+
+    ASSERT0 (!memcmp (out[0], seq, BENCH_BASES), "scalar pack+unpack didn't restore the sequence");
+
+    exit (0);
+}
+#endif
@@ -0,0 +1,37 @@
+// ------------------------------------------------------------------
+//   acgt.h
+//   Copyright (C) 2025-2025 Genozip Limited. Patent Pending.
+//   Please see terms and conditions in the file LICENSE.txt
+//
+//   WARNING: Genozip is proprietary, not open source software. Modifying the source code is strictly prohibited,
+//   under penalties specified in the license.
+
+#pragma once
+
+#include "genozip.h"
+
+// 2-bit nucleotide kernels: A=0 C=1 G=2 T=3, 4 bases per byte, first base in the lowest bits.
+// Each kernel dispatches at runtime to AVX2 or SSSE3 on x86, with a scalar (word-at-a-time where possible) fallback elsewhere.
+
+// packs seq into packed starting at bit next_bit (even). Characters are encoded per acgt_encode (lower case and IUPAC codes included)
+extern void acgt_pack (BitsP packed, uint64_t next_bit, STRp(seq));
+
+// packs seq into packed starting at bit 0, encoding anything that is not an upper case A,C,G,T as 0. Returns true if seq is all A,C,G,T
+extern bool acgt_pack_strict (BitsP packed, STRp(seq));
+
+// NONREF_X exceptions: A,C,G,T -> 0 ; a,c,g,t -> 1 ; anything else is copied as is. x may be the same as seq.
+extern void acgt_get_exceptions (STRp(seq), uint8_t *x);
+
+// decodes the first n_bases of packed into out, applying the NONREF_X exceptions if acgt_x is not NULL
+extern void acgt_unpack (ConstBitsP packed, const uint8_t *acgt_x, uint64_t n_bases, char *out);
+
+// reverse-complements n_words of 32 bases each: dst[n_words-1-i] = revcomp (src[i]). src and dst may not overlap.
+extern void acgt_revcomp_words (uint64_t *dst, const uint64_t *src, uint64_t n_words);
+
+// BAM SEQ encoding: "=ACMGRSVTWYHKDBN" -> 0-15, 2 bases per byte, first base in the high nibble, other characters -> 0.
+// If seq_len is odd, the low nibble of the last byte is 0. out may be the same as seq (in-place).
+extern void acgt_seq_to_bam (STRp(seq), uint8_t *out);
+
+#ifdef DEBUG
+extern void acgt_benchmark (void);
+#endif
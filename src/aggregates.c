@@ -0,0 +1,231 @@
+// ------------------------------------------------------------------
+//   aggregates.c
+//   Copyright (C) 2025-2025 Genozip Limited. Patent pending.
+//   Please see terms and conditions in the file LICENSE.txt
+//
+//   WARNING: Genozip is proprietary, not open source software. Modifying the source code is strictly prohibited
+//   and subject to penalties specified in the license.
+
+// --aggregates: ZIP adds an optional SEC_AGGREGATES global section, with the number of lines (and in SAM: bases and
+// soft-clipped bases) of each VB, broken down by chrom and (SAM) cover type. This allows genocat --coverage, --idxstats
+// and --count --regions to skip reconstruction of VBs whose answer is fully determined by the section.
+
+#include "aggregates.h"
+#include "file.h"
+#include "context.h"
+#include "random_access.h"
+#include "regions.h"
+#include "zfile.h"
+#include "codec.h"
+#include "sorter.h"
+
+static Mutex agg_mutex = {};
+static uint64_t agg_count = 0; // PIZ: number of lines in VBs counted by aggregates_count_vb rather than reconstructed
+
+//------------
+// ZIP
+//------------
+
+void aggregates_initialize (void)
+{
+    mutex_initialize (agg_mutex);
+}
+
+// ZIP compute thread: called for each line after it is fully segged
+void aggregates_seg_line (VBlockP vb, CoverTypes cvr, uint32_t bases, uint32_t soft_clip)
+{
+    if (!flag.aggregates || segconf_running) return;
+
+    // the index has one entry per (chrom node, cover type), containing 1 + the index of the entry in agg_buf, or 0
+    uint32_t index_i = (vb->chrom_node_index + 1) * NUM_COVER_TYPES + cvr; // chrom_node_index=-1 goes into entries 0..NUM_COVER_TYPES-1
+    vb->agg_index.len = MAX_(vb->agg_index.len, index_i + 1);
+    buf_alloc_zero (vb, &vb->agg_index, 0, MAX_(vb->agg_index.len, 500 * NUM_COVER_TYPES), uint32_t, 2, "agg_index");
+
+    uint32_t *agg_i = B32 (vb->agg_index, index_i);
+    if (!*agg_i) {
+        buf_alloc (vb, &vb->agg_buf, 1, 64, AggEntry, 2, "agg_buf");
+        BNXT (AggEntry, vb->agg_buf) = (AggEntry){ .vblock_i    = vb->vblock_i,
+                                                   .chrom_index = vb->chrom_node_index,
+                                                   .cvr         = cvr };
+        *agg_i = vb->agg_buf.len32;
+    }
+
+    AggEntry *ent = B(AggEntry, vb->agg_buf, *agg_i - 1);
+    ent->num_lines++;
+    ent->bases     += bases;
+    ent->soft_clip += soft_clip;
+}
+
+// called by ZIP compute thread, after ctx_merge_in_vb_ctx: merge in the VB's agg_buf into the global z_file one
+void aggregates_merge_in_vb (VBlockP vb)
+{
+    if (!vb->agg_buf.len) return; // nothing to merge
+
+    ContextP chrom_ctx = CTX(CHROM);
+    ASSERT (chrom_ctx->nodes_converted, "expecting nodes of %s to be converted", chrom_ctx->tag_name);
+
+    mutex_lock (agg_mutex);
+
+    buf_alloc (evb, &z_file->agg_buf, vb->agg_buf.len, 0, AggEntry, 2, "z_file->agg_buf");
+
+    for_buf (AggEntry, src, vb->agg_buf) {
+        AggEntry *dst = &BNXT (AggEntry, z_file->agg_buf);
+        *dst = *src;
+
+        // note: if the contig was canceled by seg_rollback, node_index_to_word_index returns WORD_INDEX_NONE, and we keep the
+        // entry with no chrom, so its lines are still counted
+        if (src->chrom_index != WORD_INDEX_NONE)
+            dst->chrom_index = node_index_to_word_index (vb, chrom_ctx, src->chrom_index);
+    }
+
+    mutex_unlock (agg_mutex);
+}
+
+static void BGEN_aggregates (BufferP agg_buf)
+{
+    for_buf (AggEntry, ent, *agg_buf) {
+        ent->vblock_i    = BGEN32 (ent->vblock_i);
+        ent->chrom_index = BGEN32 (ent->chrom_index);
+        ent->num_lines   = BGEN32 (ent->num_lines);
+        ent->bases       = BGEN64 (ent->bases);
+        ent->soft_clip   = BGEN64 (ent->soft_clip);
+    }
+}
+
+static int aggregates_sorter (const void *a_, const void *b_)
+{
+    const AggEntry *a = (const AggEntry *)a_, *b = (const AggEntry *)b_;
+
+    if (a->vblock_i    != b->vblock_i)    return (a->vblock_i > b->vblock_i) ? 1 : -1;
+    if (a->chrom_index != b->chrom_index) return (a->chrom_index > b->chrom_index) ? 1 : -1;
+    return (int)a->cvr - (int)b->cvr;
+}
+
+// ZIP main thread: sort by VB (VBs are merged out of order) and compress into a SEC_AGGREGATES section
+void aggregates_compress (void)
+{
+    if (!z_file->agg_buf.len) return;
+
+    qsort (STRb(z_file->agg_buf), sizeof (AggEntry), aggregates_sorter);
+
+    BGEN_aggregates (&z_file->agg_buf);
+    z_file->agg_buf.len *= sizeof (AggEntry);
+
+    Codec codec = codec_assign_best_codec (evb, NULL, &z_file->agg_buf, SEC_AGGREGATES);
+    if (codec == CODEC_UNKNOWN) codec = CODEC_NONE; // really small
+
+    zfile_compress_section_data_ex (evb, NULL, SEC_AGGREGATES, &z_file->agg_buf, 0,0, codec, (SectionFlags){}, NULL);
+
+    buf_free (z_file->agg_buf); // not needed anymore
+}
+
+//------------
+// PIZ
+//------------
+
+// true if --count --regions may count whole VBs from SEC_AGGREGATES
+static bool aggregates_can_count (void)
+{
+    return flag.count == CNT_TOTAL && flags_regions_is_only_reconstructor_filter() &&
+           !flag.maybe_lines_dropped_by_writer && !z_has_gencomp && !flag.deep;
+}
+
+// true if genocat --coverage or --idxstats can be answered entirely from SEC_AGGREGATES
+bool aggregates_can_replace_coverage (void)
+{
+    return z_file->agg_buf.len && flag.collect_coverage && Z_DT(SAM) &&
+           !flag.has_reconstructor_filter && !flag.maybe_lines_dropped_by_writer && !flag.deep;
+}
+
+// PIZ main thread: load SEC_AGGREGATES, if the file has one and we can use it
+void aggregates_load_section (void)
+{
+    agg_count = 0;
+
+    if (!is_genocat || !(aggregates_can_count() || (flag.collect_coverage && Z_DT(SAM))) || !VER2(15,74)) return; // SEC_AGGREGATES introduced 15.0.74
+
+    Section sec = sections_first_sec (SEC_AGGREGATES, SOFT_FAIL);
+    if (!sec) return; // file was compressed without --aggregates
+
+    zfile_get_global_section (SectionHeader, sec, &z_file->agg_buf, "z_file->agg_buf");
+
+    z_file->agg_buf.len /= sizeof (AggEntry);
+    BGEN_aggregates (&z_file->agg_buf);
+}
+
+static BINARY_SEARCHER (aggregates_get_first_of_vb, AggEntry, VBIType, vblock_i, false, IfNotExact_ReturnNULL)
+
+// PIZ main thread: --count --regions: if all lines of the VB are known to be either included or excluded, based on
+// the VB's random access ranges, add its count of included lines and return true - the VB needn't be reconstructed
+bool aggregates_count_vb (VBIType vb_i)
+{
+    if (!z_file->agg_buf.len || !aggregates_can_count()) return false;
+
+    const AggEntry *first = binary_search (aggregates_get_first_of_vb, AggEntry, z_file->agg_buf, vb_i);
+    if (!first) return false; // VB has no entries - it might not have been counted
+
+    uint64_t count = 0;
+    for (const AggEntry *ent = first; ent < BAFT (AggEntry, z_file->agg_buf) && ent->vblock_i == vb_i; ent++) {
+        PosType64 min_pos, max_pos;
+
+        if (ent->chrom_index == WORD_INDEX_NONE ||
+            !random_access_get_vb_chrom_range (vb_i, ent->chrom_index, &min_pos, &max_pos))
+            return false; // positions unknown
+
+        if (regions_is_range_included (ent->chrom_index, min_pos, max_pos, true))
+            count += ent->num_lines; // all lines of this chrom are included
+
+        else if (regions_get_ra_intersection (ent->chrom_index, min_pos, max_pos))
+            return false; // some lines of this chrom might be included - we need to reconstruct
+    }
+
+    agg_count += count;
+    return true;
+}
+
+uint64_t aggregates_get_count (void)
+{
+    return agg_count;
+}
+
+// PIZ main thread: --coverage and --idxstats: populate the counts that would otherwise be accumulated by coverage_add_one_vb
+void aggregates_fill_coverage (void)
+{
+    // note: --coverage and --idxstats share read_count, so they cannot be filled together. This is guaranteed by their CONFLICT in flags.c
+    ASSERT0 (!flag.show_coverage != !flag.idxstats, "expecting exactly one of --coverage and --idxstats");
+
+    uint64_t num_chroms = ZCTX(CHROM)->word_list.len;
+
+    buf_alloc_exact_zero (evb, txt_file->coverage,            num_chroms + NUM_COVER_TYPES, uint64_t, "txt_file->coverage");
+    buf_alloc_exact_zero (evb, txt_file->read_count,          num_chroms + NUM_COVER_TYPES, uint64_t, "txt_file->read_count");
+    buf_alloc_exact_zero (evb, txt_file->unmapped_read_count, num_chroms,                   uint64_t, "txt_file->unmapped_read_count");
+
+    uint64_t *coverage            = B1ST64 (txt_file->coverage);
+    uint64_t *read_count          = B1ST64 (txt_file->read_count);
+    uint64_t *unmapped_read_count = B1ST64 (txt_file->unmapped_read_count);
+    uint64_t *coverage_special    = &coverage[num_chroms];
+    uint64_t *read_count_special  = &read_count[num_chroms];
+
+    for_buf (AggEntry, ent, z_file->agg_buf) {
+        ASSERT (ent->chrom_index == WORD_INDEX_NONE || ent->chrom_index < num_chroms,
+                "vb_i=%u: chrom_index=%d ∉ [0,%"PRIu64")", ent->vblock_i, ent->chrom_index, num_chroms);
+
+        if (flag.show_coverage) {
+            if (ent->cvr == CVR_ALL_CONTIGS && ent->chrom_index != WORD_INDEX_NONE) {
+                coverage[ent->chrom_index]      += ent->bases;
+                read_count[ent->chrom_index]    += ent->num_lines;
+                coverage_special[CVR_SOFT_CLIP] += ent->soft_clip;
+            }
+            else {
+                unsigned cvr = (ent->cvr == CVR_ALL_CONTIGS) ? CVR_UNMAPPED : ent->cvr; // chrom canceled by seg_rollback
+                coverage_special[cvr]   += ent->bases;
+                read_count_special[cvr] += ent->num_lines;
+            }
+        }
+
+        else if (ent->chrom_index != WORD_INDEX_NONE) { // flag.idxstats
+            if (ent->cvr == CVR_UNMAPPED) unmapped_read_count[ent->chrom_index] += ent->num_lines;
+            else                          read_count[ent->chrom_index]          += ent->num_lines;
+        }
+    }
+}
@@ -0,0 +1,25 @@
+// ------------------------------------------------------------------
+//   aggregates.h
+//   Copyright (C) 2025-2025 Genozip Limited. Patent pending.
+//   Please see terms and conditions in the file LICENSE.txt
+//
+//   WARNING: Genozip is proprietary, not open source software. Modifying the source code is strictly prohibited
+//   and subject to penalties specified in the license.
+
+#pragma once
+
+#include "genozip.h"
+#include "coverage.h"
+
+// ZIP
+extern void aggregates_initialize (void);
+extern void aggregates_seg_line (VBlockP vb, CoverTypes cvr, uint32_t bases, uint32_t soft_clip);
+extern void aggregates_merge_in_vb (VBlockP vb);
+extern void aggregates_compress (void);
+
+// PIZ
+extern void aggregates_load_section (void);
+extern bool aggregates_count_vb (VBIType vb_i);
+extern uint64_t aggregates_get_count (void);
+extern bool aggregates_can_replace_coverage (void);
+extern void aggregates_fill_coverage (void);
@@ -13,6 +13,7 @@
 #include "reconstruct.h"
 #include "piz.h"
 #include "aligner.h"
+#include "acgt.h"
 
 // Foward example: If seq is: G-AGGGCT  (G is the hook)  -- matches reference AGGGCT       - function returns 110110101000 (A=00 is the LSb)
 // Reverse       : If seq is: CGCCCT-C  (C is the hook)  -- also matches reference AGGGCT  - function returns 110110101000 - the same
@@ -61,18 +62,8 @@ static inline Bits aligner_seq_to_bitmap (VBlockP vb, rom seq, uint64_t seq_len,
                       .words  = bitmap_words,
                       .type   = BUF_REGULAR };
 
-    *seq_is_all_acgt = true; // starting optimistically
-
-    for (uint64_t base_i=0; base_i < seq_len; base_i++) {
-        uint8_t encoding = nuke_encode (seq[base_i]);
-    
-        if (__builtin_expect (encoding == 4, false)) { // not A, C, G or T - usually N
-            *seq_is_all_acgt = false;
-            encoding = 0;    // arbitrarily convert 4 (any non-ACGT is 4) to 0 ('A')
-        }
-    
-        bits_assign2 (&seq_bits, (base_i << 1), encoding);
-    }
+    // any non-ACGT (usually N) is arbitrarily converted to 0 ('A')
+    *seq_is_all_acgt = acgt_pack_strict (&seq_bits, seq, seq_len);
 
     bits_clear_excess_bits_in_top_word (&seq_bits, false); // bc bitmap_words is uninitialized
 
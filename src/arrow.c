@@ -0,0 +1,518 @@
+// ------------------------------------------------------------------
+//   arrow.c
+//   Copyright (C) 2025-2025 Genozip Limited. Patent Pending.
+//   Please see terms and conditions in the file LICENSE.txt
+//
+//   WARNING: Genozip is proprietary, not open source software. Modifying the source code is strictly prohibited,
+//   under penalties specified in the license.
+
+// genocat --arrow=FIELD[:TYPE],... outputs the requested fields as an Apache Arrow IPC stream (see
+// https://arrow.apache.org/docs/format/Columnar.html#serialization-and-interprocess-communication-ipc).
+// Values are captured from the contexts as each line is reconstructed, and the reconstructed line itself
+// is discarded. Lines are still reconstructed, as the fields' contexts depend on each other (eg delta against other
+// fields, copying from mates, SEQ against CIGAR and POS) and on the history of previous lines - but contexts of fields
+// that are not exported, and on which exported fields don't depend, are not loaded at all, and hence reconstructed 
+// as empty strings. Each VB becomes one record batch, built in the compute thread, so the writer just
+// concatenates them between the schema message and the end-of-stream marker. The flatbuffers metadata
+// is generated here directly, so no Arrow or flatbuffers library is needed.
+
+#include "arrow.h"
+#include "vblock.h"
+#include "context.h"
+#include "file.h"
+#include "sections.h"
+#include "strings.h"
+#include "endianness.h"
+#include "reconstruct.h"
+#include "dict_id.h"
+#include "vcf.h"
+
+#define MAX_ARROW_COLUMNS   64
+#define MAX_ARROW_NAME_LEN  63
+
+typedef enum { ARROW_UTF8, ARROW_INT64, ARROW_FLOAT64 } ArrowType;
+
+typedef struct {
+    char name[MAX_ARROW_NAME_LEN + 1];
+    Did did_i;
+    ArrowType type;
+} ArrowColumn;
+
+static ArrowColumn columns[MAX_ARROW_COLUMNS];
+static uint32_t num_columns;
+
+// one per column per line, in vb->arrow_cells (row-major)
+typedef struct {
+    union {
+        int64_t i;
+        double f;
+        struct { uint32_t str_index, str_len; }; // into vb->arrow_strs
+    };
+    bool is_null;
+} ArrowCell;
+
+// values from Arrow's Message.fbs and Schema.fbs
+#define ARROW_METADATA_V5       4
+#define ARROW_MSG_SCHEMA        1
+#define ARROW_MSG_RECORD_BATCH  3
+#define ARROW_TYPE_INT          2
+#define ARROW_TYPE_FLOATING     3
+#define ARROW_TYPE_UTF8         5
+#define ARROW_PRECISION_DOUBLE  2
+#define ARROW_CONTINUATION      0xffffffff
+
+//------------------------------------------------------------------------------------
+// Minimal flatbuffers builder. Unlike the official builders, it builds front-to-back:
+// a parent object is written before its children, and offset fields are set once the
+// child is written (flatbuffers offsets must point forward, which this guarantees).
+//------------------------------------------------------------------------------------
+
+typedef struct {
+    char *start;         // start of the flatbuffer - alignment is relative to it
+    uint32_t len, size;
+} FlatBuilder;
+
+typedef struct {
+    uint8_t size;        // 1,2,4,8 or 0 if field is absent. offset fields are 4 and set later with fb_set_offset
+    uint64_t value;
+} FbField;
+
+static uint32_t fb_reserve (FlatBuilder *fb, uint32_t len)
+{
+    ASSERT (fb->len + len <= fb->size, "flatbuffer overflow: len=%u + %u > size=%u", fb->len, len, fb->size);
+
+    uint32_t pos = fb->len;
+    memset (fb->start + pos, 0, len);
+    fb->len += len;
+
+    return pos;
+}
+
+static inline void fb_pad (FlatBuilder *fb, uint32_t align)
+{
+    fb_reserve (fb, (align - fb->len % align) % align);
+}
+
+static void fb_set_offset (FlatBuilder *fb, uint32_t at, uint32_t target)
+{
+    ASSERT (target > at, "flatbuffer offset at=%u must point forward, but target=%u", at, target);
+    PUT_UINT32 (fb->start + at, target - at);
+}
+
+// returns position of the table. field_pos[i] is set to the position of field i, for setting offsets
+static uint32_t fb_table (FlatBuilder *fb, uint32_t n_fields, const FbField *fields, uint32_t *field_pos)
+{
+    // lay out the fields after the vtable soffset, largest first, so that all are naturally aligned
+    uint16_t field_offset[n_fields + 1]; // +1 to avoid a zero-length array
+    memset (field_offset, 0, sizeof (field_offset));
+
+    uint32_t table_size = 4;
+    for (uint32_t size=8; size; size /= 2)
+        for (uint32_t f=0; f < n_fields; f++)
+            if (fields[f].size == size) {
+                table_size = (table_size + size - 1) & ~(size - 1);
+                field_offset[f] = table_size;
+                table_size += size;
+            }
+
+    // vtable: its size, table size, and the offset within the table of each field (0 = absent)
+    fb_pad (fb, 2);
+    uint32_t vtable_pos = fb_reserve (fb, 4 + 2 * n_fields);
+    PUT_UINT16 (fb->start + vtable_pos,     4 + 2 * n_fields);
+    PUT_UINT16 (fb->start + vtable_pos + 2, table_size);
+    for (uint32_t f=0; f < n_fields; f++)
+        PUT_UINT16 (fb->start + vtable_pos + 4 + 2*f, field_offset[f]);
+
+    // table: soffset back to the vtable, followed by the field values
+    fb_pad (fb, 8);
+    uint32_t table_pos = fb_reserve (fb, table_size);
+    PUT_UINT32 (fb->start + table_pos, table_pos - vtable_pos);
+
+    for (uint32_t f=0; f < n_fields; f++) {
+        char *p = fb->start + table_pos + field_offset[f];
+
+        switch (fields[f].size) {
+            case 1 : PUT_UINT8  (p, fields[f].value); break;
+            case 2 : PUT_UINT16 (p, fields[f].value); break;
+            case 4 : PUT_UINT32 (p, fields[f].value); break;
+            case 8 : PUT_UINT64 (p, fields[f].value); break;
+            default: continue; // absent field
+        }
+
+        if (field_pos) field_pos[f] = table_pos + field_offset[f];
+    }
+
+    return table_pos;
+}
+
+// returns the position of the vector length. elements (zeroed) start 4 bytes after it.
+static uint32_t fb_vector (FlatBuilder *fb, uint32_t n_elems, uint32_t elem_size, uint32_t elem_align)
+{
+    fb_pad (fb, 4);
+    while ((fb->len + 4) % elem_align) fb_reserve (fb, 4); // align the first element
+
+    uint32_t pos = fb_reserve (fb, 4 + n_elems * elem_size);
+    PUT_UINT32 (fb->start + pos, n_elems);
+
+    return pos;
+}
+
+static uint32_t fb_string (FlatBuilder *fb, STRp(str))
+{
+    fb_pad (fb, 4);
+    uint32_t pos = fb_reserve (fb, 4 + str_len + 1); // including nul terminator
+    PUT_UINT32 (fb->start + pos, str_len);
+    memcpy (fb->start + pos + 4, str, str_len);
+
+    return pos;
+}
+
+//------------------------
+// Arrow IPC messages
+//------------------------
+
+// reserves room for an encapsulated message at the end of out: continuation, metadata length, and up to max_metadata_len of metadata
+static FlatBuilder arrow_message_start (VBlockP vb, BufferP out, uint32_t max_metadata_len, uint64_t body_len)
+{
+    buf_alloc (vb, out, 8 + max_metadata_len + body_len, 0, char, 1, out->name ? out->name : "arrow");
+
+    return (FlatBuilder){ .start = BAFTc(*out) + 8, .size = max_metadata_len };
+}
+
+// writes the Message table, and returns the position of its header offset field
+static uint32_t arrow_message_table (FlatBuilder *fb, uint8_t header_type, uint64_t body_len)
+{
+    uint32_t root = fb_reserve (fb, 4);
+    uint32_t pos[4];
+    uint32_t message = fb_table (fb, 4, (FbField[]){ { 2, ARROW_METADATA_V5 }, // version
+                                                     { 1, header_type },       // header_type
+                                                     { 4 },                    // header (offset)
+                                                     { 8, body_len } },        // bodyLength
+                                 pos);
+    fb_set_offset (fb, root, message);
+
+    return pos[2];
+}
+
+// metadata is padded so the body that follows is 8-byte aligned
+static void arrow_message_finish (BufferP out, FlatBuilder *fb)
+{
+    fb_pad (fb, 8);
+
+    PUT_UINT32 (BAFTc(*out),     ARROW_CONTINUATION);
+    PUT_UINT32 (BAFTc(*out) + 4, fb->len);
+    out->len += 8 + fb->len;
+}
+
+// writer thread: the Schema message, which begins the stream
+void arrow_piz_append_schema (VBlockP wvb, BufferP out)
+{
+    FlatBuilder fb = arrow_message_start (wvb, out, 256 + num_columns * (MAX_ARROW_NAME_LEN + 128), 0);
+    uint32_t header_at = arrow_message_table (&fb, ARROW_MSG_SCHEMA, 0);
+
+    uint32_t pos[2];
+    uint32_t schema = fb_table (&fb, 2, (FbField[]){ { 2, 0 },   // endianness=Little
+                                                     { 4 } },    // fields (offset)
+                                pos);
+    fb_set_offset (&fb, header_at, schema);
+
+    uint32_t fields = fb_vector (&fb, num_columns, 4, 4);
+    fb_set_offset (&fb, pos[1], fields);
+
+    for (uint32_t c=0; c < num_columns; c++) {
+        uint8_t type_type = (columns[c].type == ARROW_INT64)   ? ARROW_TYPE_INT
+                          : (columns[c].type == ARROW_FLOAT64) ? ARROW_TYPE_FLOATING
+                          :                                      ARROW_TYPE_UTF8;
+        uint32_t fpos[6];
+        uint32_t field = fb_table (&fb, 6, (FbField[]){ { 4 },             // name (offset)
+                                                        { 1, true },       // nullable
+                                                        { 1, type_type },  // type_type
+                                                        { 4 },             // type (offset)
+                                                        { 0 },             // dictionary (absent)
+                                                        { 4 } },           // children (offset)
+                                   fpos);
+        fb_set_offset (&fb, fields + 4 + 4*c, field);
+        fb_set_offset (&fb, fpos[0], fb_string (&fb, columns[c].name, strlen (columns[c].name)));
+
+        uint32_t type = (columns[c].type == ARROW_INT64)   ? fb_table (&fb, 2, (FbField[]){ { 4, 64 }, { 1, true } }, NULL) // bitWidth, is_signed
+                      : (columns[c].type == ARROW_FLOAT64) ? fb_table (&fb, 1, (FbField[]){ { 2, ARROW_PRECISION_DOUBLE } }, NULL)
+                      :                                      fb_table (&fb, 0, NULL, NULL); // Utf8 has no fields
+        fb_set_offset (&fb, fpos[3], type);
+        fb_set_offset (&fb, fpos[5], fb_vector (&fb, 0, 4, 4)); // Arrow readers expect children, even if empty
+    }
+
+    arrow_message_finish (out, &fb);
+}
+
+// writer thread: end-of-stream marker
+void arrow_piz_append_eos (VBlockP wvb, BufferP out)
+{
+    buf_alloc (wvb, out, 8, 0, char, 1, out->name ? out->name : "arrow");
+
+    PUT_UINT32 (BAFTc(*out),     ARROW_CONTINUATION);
+    PUT_UINT32 (BAFTc(*out) + 4, 0);
+    out->len += 8;
+}
+
+//-----------------------------------------
+// Capturing values and building batches
+//-----------------------------------------
+
+// main thread: called after reading the global area: resolve the --arrow fields to contexts
+void arrow_piz_initialize (void)
+{
+    ASSINP (!z_has_gencomp, "--arrow is not supported for %s, because it has generated components", z_name);
+    ASSINP (!flag.deep, "--arrow is not supported for %s, because it was compressed with --deep", z_name);
+    ASSINP0 (!flag.interleaved, "--arrow cannot output interleaved FASTQ pairs. Tip: use --R1 or --R2");
+
+    str_split (flag.arrow, strlen (flag.arrow), 0, ',', spec, false);
+    ASSINP (n_specs <= MAX_ARROW_COLUMNS, "--arrow supports up to %u fields, but %u were requested", MAX_ARROW_COLUMNS, n_specs);
+
+    Section vb_1_sec = z_file->num_vbs ? sections_vb_header (1) : NULL;
+    Section vb_1_last_sec = z_file->num_vbs ? sections_vb_last_section (1) : NULL;
+
+    num_columns = 0;
+    for (uint32_t i=0; i < n_specs; i++) {
+        ArrowColumn *col = &columns[num_columns++];
+
+        // each spec is NAME or NAME:TYPE
+        rom colon = memchr (specs[i], ':', spec_lens[i]);
+        uint32_t name_len = colon ? colon - specs[i] : spec_lens[i];
+
+        ASSINP (name_len && name_len <= MAX_ARROW_NAME_LEN, "--arrow: invalid field name \"%.*s\"", STRfi(spec, i));
+        memcpy (col->name, specs[i], name_len);
+        col->name[name_len] = 0;
+
+        DictId dict_id = dict_id_typeless (dict_id_make (col->name, name_len, DTYPE_PLAIN));
+        col->did_i = DID_NONE;
+        for_zctx_that (dict_id_typeless (zctx->dict_id).num == dict_id.num) {
+            col->did_i = zctx->did_i;
+            break;
+        }
+
+        ASSINP (col->did_i != DID_NONE, "--arrow: field \"%s\" does not exist in %s", col->name, z_name);
+
+        // case: type given explicitly
+        if (colon) {
+            rom type = colon + 1;
+            uint32_t type_len = specs[i] + spec_lens[i] - type;
+
+            if      (str_issame_(STRa(type), _S("int")))    col->type = ARROW_INT64;
+            else if (str_issame_(STRa(type), _S("float")))  col->type = ARROW_FLOAT64;
+            else if (str_issame_(STRa(type), _S("string"))) col->type = ARROW_UTF8;
+            else ABORTINP ("--arrow: invalid type \"%.*s\" for field %s. Valid types are: int, float, string", STRf(type), col->name);
+        }
+
+        // case: type is set by how the context stores its values in the first VB
+        else {
+            col->type = ARROW_UTF8;
+
+            for (Section sec = vb_1_sec ? vb_1_sec + 1 : NULL; sec && sec <= vb_1_last_sec; sec++)
+                if (sec->dict_id.num == ZCTX(col->did_i)->dict_id.num) {
+                    col->type = (sec->flags.ctx.store == STORE_INT)   ? ARROW_INT64
+                              : (sec->flags.ctx.store == STORE_FLOAT) ? ARROW_FLOAT64
+                              :                                         ARROW_UTF8;
+                    break;
+                }
+        }
+    }
+
+    // VCF: if no FORMAT subfield is exported, the samples are not needed - don't load or reconstruct them, as in --drop-genotypes.
+    // (SAM: contexts of fields that are not exported are skipped by sam_piz_is_skip_section)
+    if (Z_DT(VCF) && !arrow_piz_needs_full_line && !arrow_piz_has_type2_column() &&
+        !arrow_piz_is_column ((DictId){ .num = _VCF_FORMAT }) && !arrow_piz_is_column ((DictId){ .num = _VCF_SAMPLES }))
+        flag.drop_genotypes = true;
+}
+
+// true if the context of dict_id is exported as a column
+bool arrow_piz_is_column (DictId dict_id)
+{
+    for (uint32_t c=0; c < num_columns; c++)
+        if (ZCTX(columns[c].did_i)->dict_id.num == dict_id.num) return true;
+
+    return false;
+}
+
+// true if any exported column is a DTYPE_2 field (SAM: AUX field ; VCF: FORMAT subfield)
+bool arrow_piz_has_type2_column (void)
+{
+    for (uint32_t c=0; c < num_columns; c++)
+        if (dict_id_is_type_2 (ZCTX(columns[c].did_i)->dict_id)) return true;
+
+    return false;
+}
+
+// compute thread: called from container_reconstruct after reconstructing a non-dropped line:
+// capture the values of the columns from their contexts, and drop the reconstructed text
+void arrow_piz_capture_line (VBlockP vb)
+{
+    buf_alloc (vb, &vb->arrow_cells, num_columns, vb->lines.len32 * num_columns, ArrowCell, 1.5, "arrow_cells");
+
+    ArrowCell *cells = BAFT(ArrowCell, vb->arrow_cells);
+    vb->arrow_cells.len32 += num_columns;
+
+    for (uint32_t c=0; c < num_columns; c++) {
+        decl_ctx (columns[c].did_i);
+        ArrowCell *cell = &cells[c];
+        *cell = (ArrowCell){ .is_null = true };
+
+        // a value belongs to this line only if the context was reconstructed in it, into the line's text
+        if (!ctx_encountered_in_line (vb, ctx->did_i) || ctx->last_txt.index < vb->line_start) continue;
+
+        rom txt = last_txtx (vb, ctx);
+        uint32_t txt_len = ctx->last_txt.len;
+
+        switch (columns[c].type) {
+            case ARROW_INT64:
+                // use the decoded value if we have it, otherwise parse the text
+                if (ctx->flags.store == STORE_INT && ctx_has_value_in_line_(vb, ctx)) {
+                    cell->i = ctx->last_value.i;
+                    cell->is_null = false;
+                }
+                else
+                    cell->is_null = !str_get_int (STRa(txt), &cell->i);
+                break;
+
+            case ARROW_FLOAT64:
+                if (ctx->flags.store == STORE_FLOAT && ctx_has_value_in_line_(vb, ctx)) {
+                    cell->f = ctx->last_value.f;
+                    cell->is_null = false;
+                }
+                else if (ctx->flags.store == STORE_INT && ctx_has_value_in_line_(vb, ctx)) {
+                    cell->f = ctx->last_value.i;
+                    cell->is_null = false;
+                }
+                else
+                    cell->is_null = !str_get_float (STRa(txt), &cell->f, NULL, NULL);
+                break;
+
+            default:
+                cell->str_index = vb->arrow_strs.len32;
+                cell->str_len   = txt_len;
+                cell->is_null   = false;
+                buf_add_moreS (vb, &vb->arrow_strs, txt, "arrow_strs");
+        }
+    }
+
+    // drop the reconstructed text, but keep the history of the line, as subsequent lines might need it
+    Ltxt = vb->line_start;
+    reconstruct_copy_dropped_line_history (vb);
+}
+
+// compute thread: called after reconstructing a VB: replaces txt_data with a RecordBatch message
+void arrow_piz_finalize_vb (VBlockP vb)
+{
+    uint32_t num_rows = vb->arrow_cells.len32 / num_columns;
+    Ltxt = 0; // all reconstructed lines were dropped
+
+    if (!num_rows) goto done; // all lines filtered out - no batch
+
+    ARRAY (ArrowCell, cells, vb->arrow_cells);
+
+    // calculate the layout of the body: per column a validity bitmap, followed by values for int and float,
+    // or offsets + data for strings. each buffer is 8-byte aligned.
+    uint32_t null_count[MAX_ARROW_COLUMNS], n_buffers = 0;
+    uint64_t str_total[MAX_ARROW_COLUMNS], body_len = 0;
+    uint64_t validity_len = ROUNDUP8 (roundup_bits2bytes ((uint64_t)num_rows));
+
+    for (uint32_t c=0; c < num_columns; c++) {
+        null_count[c] = str_total[c] = 0;
+        for (uint32_t r=0; r < num_rows; r++) {
+            ArrowCell *cell = &cells[r * num_columns + c];
+            null_count[c] += cell->is_null;
+            if (columns[c].type == ARROW_UTF8 && !cell->is_null) str_total[c] += cell->str_len;
+        }
+
+        ASSERT (str_total[c] <= 0x7fffffff, "%s: column %s has too much string data for one batch", VB_NAME, columns[c].name);
+
+        body_len += validity_len + (columns[c].type == ARROW_UTF8 ? ROUNDUP8 (4 * ((uint64_t)num_rows + 1)) + ROUNDUP8 (str_total[c])
+                                                                  : 8 * (uint64_t)num_rows);
+        n_buffers += (columns[c].type == ARROW_UTF8) ? 3 : 2;
+    }
+
+    // metadata: Message with a RecordBatch header
+    FlatBuilder fb = arrow_message_start (vb, &vb->txt_data, 512 + num_columns * 96, body_len);
+    uint32_t header_at = arrow_message_table (&fb, ARROW_MSG_RECORD_BATCH, body_len);
+
+    uint32_t pos[3];
+    uint32_t batch = fb_table (&fb, 3, (FbField[]){ { 8, num_rows }, // length
+                                                    { 4 },           // nodes (offset)
+                                                    { 4 } },         // buffers (offset)
+                               pos);
+    fb_set_offset (&fb, header_at, batch);
+
+    uint32_t nodes = fb_vector (&fb, num_columns, 16, 8); // FieldNode structs: length, null_count
+    fb_set_offset (&fb, pos[1], nodes);
+    for (uint32_t c=0; c < num_columns; c++) {
+        PUT_UINT64 (fb.start + nodes + 4 + 16*c,     num_rows);
+        PUT_UINT64 (fb.start + nodes + 4 + 16*c + 8, null_count[c]);
+    }
+
+    uint32_t buffers = fb_vector (&fb, n_buffers, 16, 8); // Buffer structs: offset, length
+    fb_set_offset (&fb, pos[2], buffers);
+
+    char *buf_desc = fb.start + buffers + 4;
+    uint64_t offset = 0;
+    #define ADD_BUFFER(len) ({ PUT_UINT64 (buf_desc, offset); PUT_UINT64 (buf_desc + 8, (len)); buf_desc += 16; offset += ROUNDUP8 ((uint64_t)(len)); })
+
+    for (uint32_t c=0; c < num_columns; c++) {
+        ADD_BUFFER (roundup_bits2bytes (num_rows));
+        if (columns[c].type == ARROW_UTF8) {
+            ADD_BUFFER (4 * (num_rows + 1));
+            ADD_BUFFER (str_total[c]);
+        }
+        else
+            ADD_BUFFER (8 * num_rows);
+    }
+    #undef ADD_BUFFER
+
+    arrow_message_finish (&vb->txt_data, &fb);
+
+    // body
+    char *body = BAFTtxt;
+    memset (body, 0, body_len);
+
+    for (uint32_t c=0; c < num_columns; c++) {
+        uint8_t *validity = (uint8_t *)body;
+        body += validity_len;
+
+        if (columns[c].type == ARROW_UTF8) {
+            char *offsets = body;
+            char *data = body + ROUNDUP8 (4 * ((uint64_t)num_rows + 1));
+            uint32_t str_len = 0;
+
+            for (uint32_t r=0; r < num_rows; r++) {
+                ArrowCell *cell = &cells[r * num_columns + c];
+                PUT_UINT32 (offsets + 4*r, str_len);
+
+                if (!cell->is_null) {
+                    validity[r / 8] |= 1 << (r % 8);
+                    memcpy (data + str_len, Bc(vb->arrow_strs, cell->str_index), cell->str_len);
+                    str_len += cell->str_len;
+                }
+            }
+            PUT_UINT32 (offsets + 4*num_rows, str_len);
+
+            body = data + ROUNDUP8 (str_total[c]);
+        }
+
+        else { // int64 and float64 are both 8-byte values
+            for (uint32_t r=0; r < num_rows; r++) {
+                ArrowCell *cell = &cells[r * num_columns + c];
+
+                if (!cell->is_null) {
+                    validity[r / 8] |= 1 << (r % 8);
+                    PUT_UINT64 (body + 8*r, cell->i); // note: copies the double's bits too
+                }
+            }
+
+            body += 8 * num_rows;
+        }
+    }
+
+    Ltxt += body_len;
+
+done:
+    buf_free (vb->arrow_cells);
+    buf_free (vb->arrow_strs);
+}
@@ -0,0 +1,21 @@
+// ------------------------------------------------------------------
+//   arrow.h
+//   Copyright (C) 2025-2025 Genozip Limited. Patent Pending.
+//   Please see terms and conditions in the file LICENSE.txt
+//
+//   WARNING: Genozip is proprietary, not open source software. Modifying the source code is strictly prohibited,
+//   under penalties specified in the license.
+
+#pragma once
+
+#include "genozip.h"
+
+// genocat --arrow: output selected fields as an Apache Arrow IPC stream, one record batch per VB
+extern void arrow_piz_initialize (void);
+extern bool arrow_piz_is_column (DictId dict_id);
+extern bool arrow_piz_has_type2_column (void);
+#define arrow_piz_needs_full_line (flag.grep || flag.filter) // --grep and --filter need all fields
+extern void arrow_piz_capture_line (VBlockP vb);
+extern void arrow_piz_finalize_vb (VBlockP vb);
+extern void arrow_piz_append_schema (VBlockP wvb, BufferP out);
+extern void arrow_piz_append_eos (VBlockP wvb, BufferP out);
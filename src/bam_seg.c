@@ -597,6 +597,8 @@ rom bam_seg_txt_line (VBlockP vb_, rom alignment /* BAM terminology for one line
 
     MAXIMIZE (vb->longest_seq_len, dl->SEQ.len);
 
+    sam_seg_aggregates (vb, dl);
+
     if (segconf_running)
         segconf.est_segconf_sam_size += bam_segconf_get_transated_sam_line_len (vb, dl, tlen);
 
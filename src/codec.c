@@ -6,6 +6,7 @@
 //   WARNING: Genozip is proprietary, not open source software. Modifying the source code is strictly prohibited
 //   and subject to penalties specified in the license.
 
+#include <errno.h>
 #include "codec.h"
 #include "vblock.h"
 #include "strings.h"
@@ -16,6 +17,8 @@
 #include "profiler.h"
 #include "mgzip.h"
 #include "sorter.h"
+#include "segconf.h"
+#include "qname.h"
 
 // --------------------------------------
 // memory functions that serve the codecs
@@ -162,6 +165,170 @@ static SORTER (codec_assign_sorter)
     return ASCENDING(CodecTest, size);
 }
 
+// ------------------------------------------------------------------------------------------------------
+// --codec-profile: codec selections of previous runs, keyed by flavor (data type, tech, mapper, qname flavor), 
+// dict_id and section type. A profiled codec is verified on the sample with a single trial, and if its
+// compression ratio didn't drift, it is accepted (and locked-in) without testing other codecs
+// ------------------------------------------------------------------------------------------------------
+
+#define CODEC_PROFILE_MAX_DRIFT 0.10 // accept a profiled codec if its ratio is at most 10% worse than recorded
+
+typedef struct {
+    uint64_t dict_id_num;      // 0 for non-context sections
+    float ratio;               // compression ratio of the sample when this codec was selected
+    SectionType st;
+    Codec codec;
+    char tag_name[MAX_TAG_LEN];// informational
+} CodecProfileEnt;
+
+static Buffer profile = {};        // entries of the current flavor
+static Buffer profile_others = {}; // lines of other flavors - saved back as is
+static Mutex profile_mutex = {};
+static char profile_flavor[256];
+static bool profile_loaded = false;
+
+static CodecProfileEnt *codec_profile_find (uint64_t dict_id_num, SectionType st) // caller should lock mutex
+{
+    for_buf (CodecProfileEnt, ent, profile)
+        if (ent->dict_id_num == dict_id_num && ent->st == st) return ent;
+
+    return NULL;
+}
+
+// ZIP main thread: called after segconf, so the flavor is known
+void codec_profile_load (void)
+{
+    if (!flag.codec_profile) return;
+
+    codec_profile_save(); // save the previous component's selections, in case of a bound file
+
+    mutex_initialize (profile_mutex);
+    buf_free (profile);
+    buf_free (profile_others);
+    buf_alloc (evb, &profile, 0, 64, CodecProfileEnt, 0, "codec_profile"); // allocated in main thread, grown under mutex
+
+    snprintf (profile_flavor, sizeof (profile_flavor), "%s/%s/%s/%s", z_dt_name(), tech_name (segconf.tech),
+              (Z_DT(SAM) || Z_DT(BAM)) ? segconf_sam_mapper_name() : "-", segconf_qf_name (QNAME1));
+    str_replace_letter (profile_flavor, strlen (profile_flavor), '\t', ' ');
+
+    profile_loaded = true;
+    if (!file_exists (flag.codec_profile)) return; // will be created in codec_profile_save
+
+    Buffer data = {};
+    file_get_file (evb, flag.codec_profile, &data, "codec_profile_data", 0, VERIFY_ASCII, true);
+
+    for (char *line = data.data, *after; line < BAFTc(data); line = after + 1) {
+        if (!(after = strchr (line, '\n'))) after = BAFTc(data);
+        *after = 0;
+
+        char *tab = strchr (line, '\t');
+        if (line[0] == '#' || !tab) continue; // header or empty line
+
+        // case: another flavor - keep the line as is
+        if (!str_issame_(line, tab - line, profile_flavor, strlen (profile_flavor))) {
+            buf_append_string (evb, &profile_others, line);
+            buf_append_string (evb, &profile_others, "\n");
+            continue;
+        }
+
+        CodecProfileEnt ent = {};
+        unsigned st, codec;
+        if (sscanf (tab+1, "%"SCNx64"\t%u\t%u\t%f\t%63s", &ent.dict_id_num, &st, &codec, &ent.ratio, ent.tag_name) < 4 ||
+            st >= NUM_SEC_TYPES || codec >= NUM_CODECS || !codec_args[codec].is_simple) {
+            WARN_ONCE ("FYI: ignoring invalid line in codec profile %s: \"%s\"", flag.codec_profile, line);
+            continue;
+        }
+
+        ent.st    = st;
+        ent.codec = codec;
+        buf_append_one (profile, ent);
+    }
+
+    buf_destroy (data);
+
+    if (flag.show_codec)
+        iprintf ("Loaded %u codec profile entries for flavor \"%s\" from %s\n", profile.len32, profile_flavor, flag.codec_profile);
+}
+
+// ZIP main thread: called after the z_file is complete - save the profile, updated with the selections of this run
+void codec_profile_save (void)
+{
+    if (!flag.codec_profile || !profile_loaded) return;
+
+    Buffer out = {};
+    bufprintf (evb, &out, "# Genozip codec profile: flavor dict_id section_type codec ratio tag (tab-separated)%s", "\n");
+    buf_append_buf (evb, &out, &profile_others, char, "codec_profile_out");
+
+    for_buf (CodecProfileEnt, ent, profile)
+        bufprintf (evb, &out, "%s\t%"PRIx64"\t%u\t%u\t%.3f\t%s\n", profile_flavor, ent->dict_id_num, ent->st, ent->codec, ent->ratio, 
+                   ent->tag_name[0] ? ent->tag_name : "-");
+
+    ASSERTW (file_put_data (flag.codec_profile, STRb(out), 0), "FYI: Failed to save codec profile %s: %s", flag.codec_profile, strerror (errno));
+
+    buf_destroy (out);
+    profile_loaded = false;
+}
+
+// record the result of a full test
+static void codec_profile_update (ContextP ctx, SectionType st, Codec codec, float ratio)
+{
+    if (!profile_loaded || !codec_args[codec].is_simple) return;
+
+    mutex_lock (profile_mutex);
+
+    CodecProfileEnt *ent = codec_profile_find (ctx ? ctx->dict_id.num : 0, st);
+    if (!ent) {
+        buf_alloc (evb, &profile, 1, 64, CodecProfileEnt, 2, "codec_profile");
+        ent = &BNXT (CodecProfileEnt, profile);
+        *ent = (CodecProfileEnt){ .dict_id_num = ctx ? ctx->dict_id.num : 0, .st = st };
+        if (ctx) strcpy (ent->tag_name, ctx->tag_name);
+    }
+
+    ent->codec = codec;
+    ent->ratio = ratio;
+
+    mutex_unlock (profile_mutex);
+}
+
+// measures the compressed size of the sample in data (data->len is already set to the sample length)
+static uint32_t codec_assign_measure (VBlockP vb, ContextP ctx, BufferP data, bool data_override, SectionType st, Codec codec)
+{
+    if (codec == CODEC_NONE) return data->len;
+
+    LocalGetLineCB *callback = (ST(LOCAL) && !data_override && !ctx->no_callback) ? zip_get_local_data_callback (vb->data_type, ctx) : NULL;
+
+    zfile_compress_section_data_ex (vb, ctx, SEC_RANDOM_ACCESS/*a section with SectionType header*/, callback ? NULL : data, callback, data->len, codec, SECTION_FLAGS_NONE, 
+                                    "codec_assign_best_codec");
+    uint32_t size = vb->z_data_test.len;
+    vb->z_data_test.len = 0;
+
+    return size;
+}
+
+// returns the profiled codec if it compresses the sample (nearly) as well as when it was selected, or CODEC_UNKNOWN if it needs testing
+static Codec codec_profile_verify (VBlockP vb, ContextP ctx, BufferP data, bool data_override, SectionType st)
+{
+    if (!profile_loaded || !profile.len) return CODEC_UNKNOWN;
+
+    mutex_lock (profile_mutex);
+    CodecProfileEnt *ent_p = codec_profile_find (ctx ? ctx->dict_id.num : 0, st);
+    CodecProfileEnt ent = ent_p ? *ent_p : (CodecProfileEnt){ .codec = CODEC_UNKNOWN };
+    mutex_unlock (profile_mutex);
+
+    if (ent.codec == CODEC_UNKNOWN) return CODEC_UNKNOWN;
+
+    float ratio = (float)data->len / MAX_(1, codec_assign_measure (vb, ctx, data, data_override, st, ent.codec));
+    bool drifted = ratio < ent.ratio * (1 - CODEC_PROFILE_MAX_DRIFT);
+
+    if (flag.show_codec) {
+        iprintf ("%-8s %-12s %-5s %6.1fX   profile: [%-4s %.1fX]%s\n", VB_NAME, ctx ? ctx->tag_name : &st_name (st)[4], ctx ? &st_name (st)[4] : "SECT",
+                 ratio, codec_name (ent.codec), ent.ratio, drifted ? " drifted - testing" : "");
+        fflush (info_stream);
+    }
+
+    return drifted ? CODEC_UNKNOWN : ent.codec;
+}
+
 // this function tests each of our generic codecs on a 100KB sample of local or b250 data, and assigns the best one based on 
 // compression ratio, or if the ratio is very similar, and the time is quite different, then based on time.
 // the codec is then committed to zctx, so that future VBs that clone recieve it and needn't test again.
@@ -224,7 +391,7 @@ Codec codec_assign_best_codec (VBlockP vb,
     if (!codec_args[*selected_codec].is_simple) 
         return *selected_codec;
 
-    // if --best, we accept a codec that's been selected by 5 previous VBs in a row
+    // if --best, we accept a codec that's been selected by (BEST_LOCK_IN_THREASHOLD) previous VBs in a row
     else if (flag.best && zselected_codec != CODEC_UNKNOWN && zselected_codec_count >= BEST_LOCK_IN_THREASHOLD)
         *selected_codec = zselected_codec;
 
@@ -270,6 +437,13 @@ Codec codec_assign_best_codec (VBlockP vb,
 
     vb->z_data_test.param = true; // testing
 
+    // --codec-profile: if the codec selected in a previous run still compresses as well - accept it without testing others
+    if ((*selected_codec = codec_profile_verify (vb, ctx, data, data_override, st)) != CODEC_UNKNOWN) {
+        if ((is_b250 || is_local) && zctx) 
+            ctx_lock_in_codec_to_zf_ctx (vb, ctx, is_local);
+        goto done;
+    }
+
     // measure the compressed size and duration for a small sample of of the local data, for each codec
     for (unsigned t=0; t < num_tests; t++) {
         *selected_codec = tests[t].codec;
@@ -278,15 +452,7 @@ Codec codec_assign_best_codec (VBlockP vb,
 
         clock_t start_time = clock();
 
-        if (*selected_codec == CODEC_NONE) tests[t].size = data->len;
-        else {
-            LocalGetLineCB *callback = (ST(LOCAL) && !data_override && !ctx->no_callback) ? zip_get_local_data_callback (vb->data_type, ctx) : NULL;
-
-            zfile_compress_section_data_ex (vb, ctx, SEC_RANDOM_ACCESS/*a section with SectionType header*/, callback ? NULL : data, callback, data->len, *selected_codec, SECTION_FLAGS_NONE, 
-                                            "codec_assign_best_codec");
-            tests[t].size = vb->z_data_test.len;
-            vb->z_data_test.len = 0;
-        }
+        tests[t].size = codec_assign_measure (vb, ctx, data, data_override, st, *selected_codec);
                                                            
         tests[t].clock = (clock() - start_time) * (1000000 / CLOCKS_PER_SEC); // note: POSIX requires CLOCKS_PER_SEC=1000000. In Windows it is 1000.
     }
@@ -314,6 +480,13 @@ Codec codec_assign_best_codec (VBlockP vb,
     else
         *selected_codec = tests[0].codec;
 
+    // --codec-profile: record the ratio of the selected codec (which is not necessarily tests[0] - see above)
+    float selected_size = tests[0].size;
+    for (unsigned t=0; t < num_tests; t++)
+        if (tests[t].codec == *selected_codec) { selected_size = tests[t].size; break; }
+
+    codec_profile_update (ctx, st, *selected_codec, (float)data->len / MAX_(1, selected_size));
+
     // save the assignment for future VBs, but not in --best, where each VB tests on its own.
     // note: for local (except in --fast), we don't commit for vb=1 bc less representative of data 
     // (ok for --best as we count (BEST_LOCK_IN_THREASHOLD) anyway))
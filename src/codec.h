@@ -142,6 +142,8 @@ extern void codec_show_time (VBlockP vb, rom name, rom subname, Codec codec);
 #define CODEC_ASSIGN_SAMPLE_SIZE 99999 // bytes (slightly better results than 50K)
 extern Codec codec_assign_best_codec (VBlockP vb, ContextP ctx, BufferP non_ctx_data, SectionType st);
 extern void codec_assign_best_qual_codec (VBlockP vb, Did qual_did, LocalGetLineCB callback, bool no_seq_dependency, bool maybe_revcomped, bool *codec_requires_seq);
+extern void codec_profile_load (void);
+extern void codec_profile_save (void);
 
 #define TAG_NAME (ctx ? ctx->tag_name : "NoContext")
 
@@ -9,6 +9,7 @@
 #include "codec.h"
 #include "piz.h"
 #include "seg.h"
+#include "acgt.h"
 
 // -------------------------------------------------------------------------------------
 // acgt stuff
@@ -83,8 +84,7 @@ static inline void codec_acgt_pack (BitsP packed, rom data, uint64_t data_len)
     packed->nwords = roundup_bits2words64 (packed->nbits);
 
     // pack nucleotides - each character is packed into 2 bits
-    for (uint64_t i=0 ; i < data_len ; i++, next_bit += 2)       
-        bits_assign2 (packed, next_bit, acgt_encode[(uint8_t)data[i]]);
+    acgt_pack (packed, next_bit, data, data_len);
 }
 
 // This function decompsoses SEQ data into two buffers:
@@ -96,12 +96,6 @@ static inline void codec_acgt_pack (BitsP packed, rom data, uint64_t data_len)
 // NONREF_X.local is later compressed as a normal context (codec=XCGT, subcodec=as assigned)
 COMPRESS (codec_acgt_compress)
 {
-    // table to convert SEQ data to ACGT exceptions. The character is XORed with the entry in the table
-    static const uint8_t acgt_exceptions[256] = { 
-        ['A']='A',   ['C']='C',   ['G']='G',   ['T']='T',  // -->0 (XORed with self)
-        ['a']='a'^1, ['c']='c'^1, ['g']='g'^1, ['t']='t'^1 // -->1 (XORed with self XOR 1)
-    };                                                     // all others are XORed with 0 and hence remain unchanged
-    
     START_TIMER;
     
     #define PACK(data,len) { if (len) codec_acgt_pack (packed, (data), (len)); }
@@ -136,8 +130,7 @@ COMPRESS (codec_acgt_compress)
 
         // calculate the exception in-place in NONREF.local also overlayed to NONREF_X.local
         if (has_x) 
-            for (uint32_t i=0; i < *uncompressed_len; i++) \
-                ((uint8_t*)uncompressed)[i] = (uint8_t)(uncompressed[i]) ^ acgt_exceptions[(uint8_t)(uncompressed[i])];
+            acgt_get_exceptions (uncompressed, *uncompressed_len, (uint8_t *)uncompressed);
     }
 
     // option 2 - callback to get each line 
@@ -152,8 +145,8 @@ COMPRESS (codec_acgt_compress)
 
             PACK (data_1, data_1_len);
 
-            for (uint32_t i=0; i < data_1_len; i++) 
-                BNXT8 (nonref_x_ctx->local) = (uint8_t)(data_1[i]) ^ acgt_exceptions[(uint8_t)(data_1[i])];
+            acgt_get_exceptions (STRa(data_1), BAFT8 (nonref_x_ctx->local));
+            nonref_x_ctx->local.len32 += data_1_len;
         }
     }
     else 
@@ -215,12 +208,8 @@ UNCOMPRESS (codec_xcgt_uncompress)
         
     char *nonref = B1STc (nonref_ctx->local); // note: local was allocated by caller ahead of comp_uncompress -> codec_acgt_uncompress of the NONREF context
 
-    decl_acgt_decode;
-    for (uint32_t i=0; i < uncompressed_len; i++) {
-        if      (!acgt_x || acgt_x[i] == 0) *nonref++ = base_by_idx(packed, i);      // case 0: use acgt as is - 'A', 'C', 'G' or 'T'
-        else if (           acgt_x[i] == 1) *nonref++ = base_by_idx(packed, i) + 32; // case 1: convert to lower case - 'a', 'c', 'g' or 't'
-        else                                *nonref++ = acgt_x[i];                   // case non-0/1: use acgt_x (this is usually, but not necessarily, 'N')
-    }
+    // 0: use acgt as is - 'A', 'C', 'G' or 'T' ; 1: convert to lower case ; non-0/1: use acgt_x (usually, but not necessarily, 'N')
+    acgt_unpack (packed, (const uint8_t *)acgt_x, uncompressed_len, nonref);
 
     buf_free (vb->scratch);
 }
@@ -254,9 +243,7 @@ UNCOMPRESS (codec_acgt_uncompress)
     if (ctx->flags.acgt_no_x) {
         char *nonref = B1STc (ctx->local); // note: local was allocated by caller ahead of comp_uncompress -> codec_acgt_uncompress of the NONREF context
 
-        decl_acgt_decode;
-        for (uint32_t i=0; i < uncompressed_len; i++) 
-            *nonref++ = base_by_idx(packed, i);
+        acgt_unpack (packed, NULL, uncompressed_len, nonref);
 
         buf_free (*packed_buf);
     }
@@ -17,17 +17,16 @@
     ContextP fgrc_ctx __attribute__((unused)) = CTX(FORMAT_PBWT_FGRC);  \
     ContextP ht_ctx   __attribute__((unused)) = CTX(FORMAT_GT_HT);
 
-typedef struct {
-    Allele allele;      // copied from line on which permutation is applied
-    uint32_t index;     // index into ht_one_line from which this allele was copied
-} PermEnt;
-
+// note: the permutation is kept as two parallel arrays (rather than an array of {allele,index} structs), so that 
+// alleles are contiguous in memory and runs can be scanned a word at a time
 typedef struct {
     BufferP runs;       // array of uint32_t - alternating bg ('0') / fg runs
     BufferP fgrc;       // array PbwtFgRunCount describing the fg runs
     Allele run_allele;  // current allele for which we're constructing a run 
-    PermEnt *perm;      // a permutation - expressed as indices into the haplotype line 
-    PermEnt *temp;      // working memory
+    uint32_t *perm;     // a permutation - expressed as indices into the haplotype line 
+    uint32_t *temp;     // working memory
+    Allele *perm_allele;// perm_allele[i] is the allele of ht_one_line[perm[i]]
+    Allele allele_order[NUM_SMALL_ALLELES + 5]; // order in which allele groups appear in the permutation
 } PbwtState;
 
 // this struct is part of the file format
@@ -84,26 +83,65 @@ static void show_runs (const PbwtState *state)
     iprint0 ("\n"); }) // flush
 
 #define show_line    if (flag.show_alleles) SHOW ("LINE", (htputc (*B(Allele, ht_ctx->local, line_i * ht_ctx->ht_per_line + i))))
-#define show_perm(s) if (flag.show_alleles) SHOW ("PERM", (fprintf (info_stream, "%d ", (s)->perm[i].index)));       
+#define show_perm(s) if (flag.show_alleles) SHOW ("PERM", (fprintf (info_stream, "%d ", (s)->perm[i])));       
 
 static PbwtState codec_pbwt_initialize_state (VBlockP vb, BufferP runs, BufferP fgrc, uint32_t ht_per_line)
 {
     decl_pbwt_contexts;
 
-    buf_alloc (vb, &vb->codec_bufs[0], 0, ht_per_line * 2, PermEnt, 1, "codec_bufs");
-    buf_zero (&vb->codec_bufs[0]); // re-zero every time
-    ARRAY (PermEnt, state_data, vb->codec_bufs[0]);
+    buf_alloc_exact_zero (vb, vb->codec_bufs[0], ht_per_line * 2 * sizeof (uint32_t) + roundup_bytes2bytes64 (ht_per_line), char, "codec_bufs"); // re-zero every time
 
     PbwtState state = {
-        .runs = runs,
-        .fgrc = fgrc,
-        .perm = &state_data[0],               // size: ht_per_line X PermEnt
-        .temp = &state_data[ht_per_line], // size: ht_per_line X PermEnt
+        .runs        = runs,
+        .fgrc        = fgrc,
+        .perm        = B32 (vb->codec_bufs[0], 0),           // size: ht_per_line X uint32_t
+        .temp        = B32 (vb->codec_bufs[0], ht_per_line), // size: ht_per_line X uint32_t
+        .perm_allele = B(Allele, vb->codec_bufs[0], ht_per_line * 2 * sizeof (uint32_t)), // size: ht_per_line X Allele
     };
+
+    // alleles are grouped '0', '1'... (round robin using uint8_t arithmetic) followed by the pseudo alleles - 
+    // we need to keep them in this order (which is not ASCII order) for back comp
+    for (int i=0; i < NUM_SMALL_ALLELES; i++)
+        state.allele_order[i] = (Allele)('0' + i); 
+
+    static const Allele pseudo_alleles[] = { '.', '*', '%', '-', '&' };
+    memcpy (&state.allele_order[NUM_SMALL_ALLELES], pseudo_alleles, sizeof (pseudo_alleles));
         
     return state;
 } 
 
+#define ALLELE_WORD(a) (0x0101010101010101ULL * (uint8_t)(a))
+
+// returns the number of consecutive alleles equal to allele, starting from alleles[0] and going forward, comparing 8 alleles at a time 
+static inline uint32_t codec_pbwt_run_len_fwd (const Allele *alleles, uint32_t max_len, Allele allele)
+{
+    uint64_t word_allele = ALLELE_WORD (allele);
+    uint32_t i=0;
+
+    for (; i + 8 <= max_len; i += 8) {
+        uint64_t diff = GET_UINT64 (&alleles[i]) ^ word_allele;
+        if (diff) return i + trailing_zeros (diff) / 8; // note: GET_UINT64 is little endian on all hosts
+    }
+
+    for (; i < max_len && alleles[i] == allele; i++) {}
+    return i;
+}
+
+// returns the number of consecutive alleles equal to allele, starting from alleles[-1] and going backwards
+static inline uint32_t codec_pbwt_run_len_bwd (const Allele *alleles_after, uint32_t max_len, Allele allele)
+{
+    uint64_t word_allele = ALLELE_WORD (allele);
+    uint32_t i=0;
+
+    for (; i + 8 <= max_len; i += 8) {
+        uint64_t diff = GET_UINT64 (alleles_after - i - 8) ^ word_allele;
+        if (diff) return i + leading_zeros (diff) / 8; // note: GET_UINT64 is little endian on all hosts
+    }
+
+    for (; i < max_len && *(alleles_after - i - 1) == allele; i++) {}
+    return i;
+}
+
 // update the permutation for the next row: we re-sort it to make indices containing the same allele grouped
 // first '0', then '1' etc - but the order within each of these allele groups remains as in the current row's premutation 
 // (this is why we traverse the permuted line rather than the ht_matrix line)
@@ -111,46 +149,36 @@ static void inline codec_pbwt_calculate_permutation (PbwtState *state, const All
 {
     // populate permutation index - by re-ordering according to previous line's alleles
     if (!is_first_line) {
-        // mark which allele values exist in prev line
-        bool has_allele[256] = {};
+        // count the number of occurrences of each allele in prev line 
+        uint32_t next_i[256] = {};
         for (uint32_t ht_i=0; ht_i < line_len; ht_i++) 
-            has_allele[state->perm[ht_i].allele] = true;
-
-        // list of allele values existing in prev line
-        Allele my_alleles[256];
-        int n_my_alleles=0;
-        for (Allele allele='0'; allele != (Allele)('0' + NUM_SMALL_ALLELES); allele++)  // round robin using uint8_t arithmetic
-            if (has_allele[allele]) 
-                my_alleles[n_my_alleles++] = allele;
-
-        // pseudo alleles - we need to keep them in this order (which is not ASCII order) for back comp
-        static const Allele pseudo_alleles[] = { '.', '*', '%', '-', '&' };
-        for (int i=0; i < ARRAY_LEN(pseudo_alleles); i++) // note: not i is not uint8_t bc would round-robin 
-            if (has_allele[pseudo_alleles[i]]) 
-                my_alleles[n_my_alleles++] = pseudo_alleles[i];
-
-        // re-order permutation - first taking the indices of the '0' alleles, then '1', '2' etc - but keeping
-        // the order within each allele as it was 
+            next_i[state->perm_allele[ht_i]]++;
+
+        // convert counts to the index in temp of the first entry of each allele - first the indices of the '0' alleles, 
+        // then '1', '2' etc (a stable counting sort, equivalent to a separate pass over the line for each allele)
         uint32_t temp_i=0;        
-        for (int i=0; i < n_my_alleles; i++) {
-            Allele bg = my_alleles[i];
-        
-            for (uint32_t ht_i=0; ht_i < line_len; ht_i++) 
-                if (state->perm[ht_i].allele == bg) 
-                    state->temp[temp_i++].index = state->perm[ht_i].index;
+        for (int i=0; i < ARRAY_LEN(state->allele_order); i++) {
+            Allele allele = state->allele_order[i];
+            uint32_t count = next_i[allele];
+            next_i[allele] = temp_i;
+            temp_i += count;
         }
 
+        // re-order permutation, keeping the order within each allele as it was 
+        for (uint32_t ht_i=0; ht_i < line_len; ht_i++) 
+            state->temp[next_i[state->perm_allele[ht_i]]++] = state->perm[ht_i];
+
         SWAP (state->perm, state->temp);
     }
 
     else // first line - initialize permutation to identity
         for (uint32_t ht_i=0; ht_i < line_len; ht_i++) 
-            state->perm[ht_i].index = ht_i;
+            state->perm[ht_i] = ht_i;
 
     // ZIP: populate alleles
     if (IS_ZIP) 
         for (uint32_t ht_i=0; ht_i < line_len; ht_i++)
-            state->perm[ht_i].allele = line[state->perm[ht_i].index];
+            state->perm_allele[ht_i] = line[state->perm[ht_i]];
 }
 
 // -------------
@@ -214,11 +242,11 @@ static void inline codec_pbwt_run_len_encode (PbwtState *state, uint32_t line_le
 { 
     for (uint32_t ht_i=0; ht_i < line_len; ) {		
 
-        #define ALLELE(ht_i) state->perm[backwards ? line_len - (ht_i) -1 : (ht_i)].allele
+        #define ALLELE(ht_i) state->perm_allele[backwards ? line_len - (ht_i) -1 : (ht_i)]
 
-        uint32_t run_len=0;
-        for (; ht_i < line_len && ALLELE(ht_i) == state->run_allele; ht_i++) 
-            run_len++;
+        uint32_t run_len = backwards ? codec_pbwt_run_len_bwd (&state->perm_allele[line_len - ht_i], line_len - ht_i, state->run_allele)
+                                     : codec_pbwt_run_len_fwd (&state->perm_allele[ht_i], line_len - ht_i, state->run_allele);
+        ht_i += run_len;
 
         // case: we have more of the existing run - extend the current run length
         if (run_len) 
@@ -335,10 +363,14 @@ static inline void pbwt_decode_one_line (VBlockVCFP vb, ContextP ht_ctx, PbwtSta
 
         uint32_t line_part_of_run = MIN_(run_len, ht_ctx->ht_per_line - ht_i); // the run could be shared with the next line
         
-        for (uint32_t i=0; i < line_part_of_run; i++, ht_i++) {
-            uint32_t oriented_ht_i = backwards ? ht_ctx->ht_per_line - ht_i - 1 : ht_i;
-            ht_one_line[state->perm[oriented_ht_i].index] = state->perm[oriented_ht_i].allele = state->run_allele;
-        }
+        // the run occupies a contiguous range of the permutation, in either orientation
+        uint32_t first_perm_i = backwards ? ht_ctx->ht_per_line - ht_i - line_part_of_run : ht_i;
+        memset (&state->perm_allele[first_perm_i], state->run_allele, line_part_of_run);
+
+        for (uint32_t perm_i=first_perm_i; perm_i < first_perm_i + line_part_of_run; perm_i++)
+            ht_one_line[state->perm[perm_i]] = state->run_allele;
+
+        ht_i += line_part_of_run;
 
         // case: we consumed only part of the run - leave the remaining part for the next line
         if (line_part_of_run < run_len) *runs -= line_part_of_run; 
@@ -16,6 +16,9 @@
 #include "piz.h"
 #include "writer.h"
 #include "lookback.h"
+#include "arrow.h"
+#include "txt_index.h"
+#include "expr_filter.h"
 #include "libdeflate_1.19/libdeflate.h"
 
 //----------------------
@@ -287,9 +290,13 @@ static inline void container_toplevel_filter (VBlockP vb, uint32_t rep_i, rom re
     }
 
     // filter by --regions
-    else if (!vb->drop_curr_line && flag.regions && !regions_is_site_included (vb)) 
+    else if (!vb->drop_curr_line && flag.regions && (rep_i < vb->recon_lines_first || !regions_is_site_included (vb))) 
         vb->drop_curr_line = "regions";
 
+    // filter by --filter (conjuncts that were not already evaluated while reconstructing the line)
+    else if (!vb->drop_curr_line && flag.filter && !vb->preprocessing && !expr_filter_does_line_survive (vb))
+        vb->drop_curr_line = "filter";
+
     // filter by --grep (but not for FASTA - it implements its own logic)
     else if (!vb->drop_curr_line && flag.grep && !TXT_DT(FASTA) && !piz_grep_match (recon, BAFTtxt))
         vb->drop_curr_line = "grep";
@@ -496,8 +503,18 @@ ValueType container_reconstruct (VBlockP vb, ContextP ctx, ConstContainerP con,
         
         if (flag.maybe_lines_dropped_by_reconstructor || flag.maybe_lines_dropped_by_writer)
             vb->is_dropped = writer_get_is_dropped (vb->vblock_i);
+
+        // --head, --lines, --tail: lines after the last line the writer outputs needn't be reconstructed either
+        // note: with gencomp or --interleave, writer's lines don't map 1:1 to this VB's lines
+        uint64_t last_written;
+        if (flag.maybe_lines_dropped_by_writer && vb->is_dropped && !z_has_gencomp && !flag.interleaved && 
+            vb->is_dropped->nbits == con->repeats && bits_find_last_clear_bit (vb->is_dropped, &last_written))
+            vb->recon_lines_limit = vb->recon_lines_limit ? MIN_(vb->recon_lines_limit, last_written + 1) : (last_written + 1);
         
         debug_lines_ctx = container_get_debug_lines_ctx (vb); 
+
+        if (flag.filter && !vb->preprocessing)
+            expr_filter_init_toplevel (vb, con);
     }
 
     bool is_container_of_fields = container_is_of_fields (vb, ctx, is_toplevel); // TOPLEVEL, AUX, INFO, FORMAT etc
@@ -515,6 +532,15 @@ ValueType container_reconstruct (VBlockP vb, ContextP ctx, ConstContainerP con,
             
             container_set_lines (vb, rep_i);
 
+            // case: all remaining lines are outside of --regions (per the sub-VB index) or beyond --head/--lines - drop them without reconstructing
+            if (vb->recon_lines_limit && rep_i >= vb->recon_lines_limit) {
+                for (; rep_i < con->repeats; rep_i++) {
+                    container_set_lines (vb, rep_i);
+                    if (vb->is_dropped) bits_set (vb->is_dropped, rep_i);
+                }
+                break;
+            }
+
             if (flag.show_lines)
                 iprintf ("%s byte-in-vb=%u\n", LN_NAME, vb->txt_data.len32);
 
@@ -616,6 +642,10 @@ ValueType container_reconstruct (VBlockP vb, ContextP ctx, ConstContainerP con,
             if (trans_item && IS_CI0_SET (CI0_TRANS_MOVE))
                 Ltxt += (uint8_t)item->separator[1];
 
+            // --filter: evaluate predicates whose fields are now all reconstructed, possibly marking the line for dropping
+            if (is_toplevel && flag.filter && !vb->drop_curr_line && !vb->preprocessing)
+                expr_filter_after_item (vb, item_i);
+
             // display 10 first reconstructed characters, but all characters if just this ctx was requested 
             if (show_item) {
                 int len = flag.dict_id_show_containers.num ? (int)(BAFTtxt-reconstruction_start) : MIN_(64,(int)(BAFTtxt-reconstruction_start));
@@ -662,6 +692,12 @@ ValueType container_reconstruct (VBlockP vb, ContextP ctx, ConstContainerP con,
 
             if (flag.maybe_lines_dropped_by_reconstructor || flag.maybe_lines_dropped_by_writer)
                 container_toplevel_filter (vb, rep_i, rep_reconstruction_start, show_non_item);
+
+            if (flag.arrow && !vb->drop_curr_line)
+                arrow_piz_capture_line (vb);
+
+            if (flag.index_txt && !vb->drop_curr_line)
+                txt_index_capture_line (vb);
         }
     } // repeats loop
 
@@ -646,6 +646,30 @@ void ctx_populate_zf_ctx_from_contigs (Did dst_did_i, ConstContigPkgP ctgs)
     }
 }
 
+// ZIP main thread: --dict-template: pre-populate an empty zctx with the words of a template dictionary, before
+// the first VB. VBs then find these words in ol_nodes, and only words beyond num_primed_words are written to SEC_DICT.
+void ctx_prime_zf_ctx (ContextP zctx, STRp(dict), uint32_t num_words, uint32_t estimated_entries)
+{
+    ASSERT (!zctx->nodes.len, "expecting %s to have no nodes", zctx->tag_name);
+
+    if (!buf_is_alloc (&zctx->global_hash)) 
+        hash_alloc_global (zctx, estimated_entries);
+
+    rom word = dict;
+    for (uint32_t i=0; i < num_words; i++) {
+        uint32_t word_len = strlen (word);
+        ASSERT (word + word_len < dict + dict_len, "%s: dictionary overflow at word_i=%u", zctx->tag_name, i);
+
+        bool is_new;
+        ctx_commit_node (NULL, zctx, NULL, STRa(word), false, &is_new);
+        ASSERT (is_new, "%s: word_i=%u \"%.*s\" appears twice in the template dictionary", zctx->tag_name, i, STRf(word));
+        
+        word += word_len + 1; // skip the \0 separator
+    }
+
+    zctx->num_primed_words = num_words;
+}
+
 // Find the z_file context that corresponds to dict_id, or return NULL if there is none.
 // ZIP note: It could be possibly a different did_i than in the vb - in case this dict_id is new to this vb, but another 
 // vb already inserted it to z_file
@@ -786,6 +810,25 @@ void ctx_commit_codec_to_zf_ctx (VBlockP vb, ContextP vctx, bool is_lcodec, bool
     mutex_unlock (ZMUTEX(zctx));
 }
 
+// --codec-profile: commit a codec verified against the profile, as if it was selected by the maximum number of VBs in a row (so --best locks it in)
+void ctx_lock_in_codec_to_zf_ctx (VBlockP vb, ContextP vctx, bool is_lcodec)
+{
+    ContextP zctx = ctx_get_zctx_from_vctx (vctx, true, false);
+
+    mutex_lock (ZMUTEX(zctx));
+
+    if (is_lcodec) {
+        store_relaxed (zctx->lcodec, vctx->lcodec); 
+        store_relaxed (zctx->lcodec_count, 255); 
+    }
+    else {
+        store_relaxed (zctx->bcodec, vctx->bcodec); 
+        store_relaxed (zctx->bcodec_count, 255); 
+    }
+
+    mutex_unlock (ZMUTEX(zctx));
+}
+
 void ctx_reset_codec_commits (void)
 {
     for_zctx {
@@ -1456,7 +1499,7 @@ void ctx_shorten_unused_dict_words (Did did_i)
     for (WordIndex ni=0; ni < nodes_len; ni++) {
         uint64_t new_char_index = nodes[ni].char_index - deleted_so_far;
 
-        if (!counts[ni]) {
+        if (!counts[ni] && ni >= zctx->num_primed_words) { // primed words are not ours to remove - PIZ takes them from the template
             memset (&dict[nodes[ni].char_index], SNIP_RESERVED, nodes[ni].snip_len); // A value guaranteed not to exist in dictionary data
             deleted_so_far += nodes[ni].snip_len; 
             nodes[ni].snip_len = 0;
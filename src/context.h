@@ -158,6 +158,7 @@ extern CtxNode ctx_node_vb_do (ConstContextP ctx, WordIndex node_index, rom *sni
 extern void ctx_merge_in_vb_ctx (VBlockP vb);
 extern void ctx_update_zctx_txt_len (VBlockP vb, ContextP vctx, int64_t increment);
 extern void ctx_commit_codec_to_zf_ctx (VBlockP vb, ContextP vctx, bool is_lcodec, bool is_lcodec_inherited);
+extern void ctx_lock_in_codec_to_zf_ctx (VBlockP vb, ContextP vctx, bool is_lcodec);
 extern void ctx_reset_codec_commits (void);
 extern void ctx_segconf_set_hard_coded_lcodec (Did did_i, Codec codec);
 extern void ctx_get_z_codecs (ContextP zctx, Codec *lcodec, Codec *bcodec, uint8_t *lcodec_count, uint8_t *bcodec_count, bool *lcodec_hard_coded);
@@ -256,6 +257,7 @@ extern void ctx_compress_subdicts (void);
 extern rom ctx_get_snip_with_largest_count (Did did_i, int64_t *count);
 extern void ctx_populate_zf_ctx_from_contigs (Did dst_did_i, ConstContigPkgP ctgs);
 extern WordIndex ctx_populate_zf_ctx (Did dst_did_i, STRp (snip), WordIndex ref_index);
+extern void ctx_prime_zf_ctx (ContextP zctx, STRp(dict), uint32_t num_words, uint32_t estimated_entries);
 
 extern void ctx_dump_binary (VBlockP vb, ContextP ctx, bool local);
 
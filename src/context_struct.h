@@ -345,6 +345,7 @@ typedef struct Context {
     bool override_rm_dict_ats; // zctx: don't remove dict, even if rm_dict_all_the_same is set
     bool all_the_same_wi_is_set; // zctx: zctx->dict_flags.all_the_same_wi is set 
     int8_t vb_1_pending_merges;// ZIP zctx: count of vb=1 merges still pending for this context (>1 if it has aliases). Other VBs can merge only if this is 0.
+    uint32_t num_primed_words; // ZIP zctx: number of leading nodes pre-populated from --dict-template - these are not written to SEC_DICT
     }; // ------ End of ZIP-only fields - zctx only -------
     };
     };
@@ -6,6 +6,8 @@
 //   WARNING: Genozip is proprietary, not open source software. Modifying the source code is strictly prohibited,
 //   under penalties specified in the license.
 
+#pragma once
+
 #include "genozip.h"
 
 // if updating, update cvr_names in coverage.c too
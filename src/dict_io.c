@@ -83,14 +83,14 @@ static void dict_io_prepare_for_compress (VBlockP vb)
     while (frag_ctx < ZCTX(z_file->num_contexts)) {
 
         if (!frag_next_node) {
-            if (!frag_ctx->nodes.len ||
+            if (frag_ctx->nodes.len == frag_ctx->num_primed_words || // no nodes, or only words primed by --dict-template (PIZ gets them from the template)
                 frag_ctx->please_remove_dict ||  // this context belongs to a method that lost the test and is not used in this file
                 (frag_ctx->rm_dict_all_the_same && !frag_ctx->override_rm_dict_ats)) { // if only word in dict is a SNIP_LOOKUP, we don't need the dict, as absent a dict, lookup will happen (unless any VB objects) 
                 frag_ctx++;
                 continue; // unused context
             }
 
-            frag_next_node = B1ST (const CtxNode, frag_ctx->nodes);
+            frag_next_node = B(const CtxNode, frag_ctx->nodes, frag_ctx->num_primed_words); // words primed from --dict-template are not written
 
             ASSERT (frag_next_node->char_index + frag_next_node->snip_len <= frag_ctx->dict.len, 
                     "Corrupt nodes in ctx=%.8s did_i=%u", frag_ctx->tag_name, (int)(frag_ctx - z_file->contexts));
@@ -252,7 +252,8 @@ static void dict_io_read_one_vb (VBlockP vb) // one vb = one fragment
         // this allows us to calculate the frag_size with which this dictionary was compressed and hence an upper bound on the size
         uint64_t size_upper_bound = (num_fragments == 1) ? vb->fragment_len : ((uint64_t)roundup2pow (vb->fragment_len) * (uint64_t)num_fragments);
         
-        buf_alloc (evb, &dict_ctx->dict, 0, VER(9) ? size_upper_bound : v8_get_dict_size (vb, dict_sec), char, 0, "zctx->dict");
+        // note: dict might already contain words primed from --dict-template, in which case the fragments are appended to them
+        buf_alloc (evb, &dict_ctx->dict, 0, dict_ctx->dict.len + (VER(9) ? size_upper_bound : v8_get_dict_size (vb, dict_sec)), char, 0, "zctx->dict");
         dict_ctx->dict.prm32[0] = num_fragments;     // for error reporting
         dict_ctx->dict.prm32[1] = vb->fragment_len;
 
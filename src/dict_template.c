@@ -0,0 +1,218 @@
+// ------------------------------------------------------------------
+//   dict_template.c
+//   Copyright (C) 2025-2025 Genozip Limited. Patent pending.
+//   Please see terms and conditions in the file LICENSE.txt
+//
+//   WARNING: Genozip is proprietary, not open source software. Modifying the source code is strictly prohibited
+//   and subject to penalties specified in the license.
+
+// --dict-template=FILE.genozip: the dictionaries of a previously compressed file of the same type are loaded once,
+// and used to prime the zctx dictionaries (and their global hash) of each file compressed - so small similar files,
+// such as per-sample VCFs or FASTQs in a --tar, don't need to store near-identical dictionaries over and over.
+// Primed words are not written to SEC_DICT - instead, a SEC_DICT_TEMPLATE section lists the primed dictionaries
+// along with their crc32, and PIZ (also given --dict-template) primes the same dictionaries before reading SEC_DICT.
+
+#include "dict_template.h"
+#include "file.h"
+#include "context.h"
+#include "dict_io.h"
+#include "zfile.h"
+#include "piz.h"
+#include "segconf.h"
+#include "digest.h"
+
+typedef struct {
+    DictId dict_id;
+    char tag_name[MAX_TAG_LEN];
+    uint32_t num_words;
+    uint64_t char_index, dict_len; // dictionary data in tmpl_data
+} TemplateDict;
+
+static Buffer tmpl_dicts = {};       // TemplateDict entries - dictionaries of the --dict-template file that can be primed
+static Buffer tmpl_data  = {};       // dictionary data of all tmpl_dicts
+static DataType tmpl_dt  = DT_NONE;  // DT_NONE if no template is loaded
+static int64_t tmpl_txt_size = 0;    // size of the txt data of the template file
+
+// ZIP & PIZ main thread: load the dictionaries of the template file, once, before any file is processed
+void dict_template_load (void)
+{
+    if (!flag.dict_template) return;
+
+    SAVE_FLAGS_AUX ("dict-template");
+    SAVE_VALUE (segconf); // reading the Genozip header of the template sets some segconf fields
+
+    flag.reading_dict_template = true; // tell piz_is_skip_section to load all dictionaries, and exit_on_error not to remove the file
+    flag.no_writer = flag.no_writer_thread = true;
+    flag.dont_load_ref_file = true;    // only the dictionaries are needed
+    flag.only_headers = flag.show_gheader = flag.show_data_type = 0;
+    flag.t_offset = flag.t_size = 0;
+
+    ASSERTISNULL (z_file);
+    z_file = file_open_z_read (flag.dict_template);
+
+    TEMP_VALUE (command, PIZ);
+
+    ASSINP (zfile_read_genozip_header (NULL, SOFT_FAIL), "Failed to read the --dict-template file %s", flag.dict_template);
+
+    tmpl_dt       = z_file->data_type;
+    tmpl_txt_size = z_file->txt_data_so_far_bind;
+
+    ASSINP (tmpl_dt == DT_VCF || tmpl_dt == DT_FASTQ, "--dict-template: %s is a %s file, but only VCF, BCF and FASTQ files are supported",
+            flag.dict_template, z_dt_name());
+
+    dict_io_read_all_dictionaries();
+
+    for_zctx {
+        // CHROM is not primed, as its word indices are tied to the contigs in the txt header and the reference. One-word
+        // dictionaries are not primed, as they are too small to be worth it, and some are expected to remain single-word
+        if (zctx->did_i == DTFZ(chrom) || zctx->word_list.len < 2) continue;
+
+        // a dictionary with empty words (eg of removed unused words) cannot be primed, as its words are not unique
+        bool has_empty_word = false;
+        for_buf (CtxWord, word, zctx->word_list)
+            if (!word->snip_len) { has_empty_word = true; break; }
+
+        if (has_empty_word) continue;
+
+        buf_alloc (evb, &tmpl_dicts, 1, 64, TemplateDict, 2, "tmpl_dicts");
+        TemplateDict *td = &BNXT (TemplateDict, tmpl_dicts);
+        *td = (TemplateDict){ .dict_id    = zctx->dict_id,
+                              .num_words  = zctx->word_list.len32,
+                              .char_index = tmpl_data.len,
+                              .dict_len   = zctx->dict.len };
+        strcpy (td->tag_name, zctx->tag_name);
+
+        buf_add_more (evb, &tmpl_data, zctx->dict.data, zctx->dict.len, "tmpl_data");
+    }
+
+    file_close (&z_file);
+
+    RESTORE_VALUE (command);
+    RESTORE_VALUE (segconf);
+    RESTORE_FLAGS;
+}
+
+static const TemplateDict *dict_template_find (DictId dict_id)
+{
+    for_buf (TemplateDict, td, tmpl_dicts)
+        if (td->dict_id.num == dict_id.num) return td;
+
+    return NULL;
+}
+
+//------------
+// ZIP
+//------------
+
+// ZIP main thread: called after segconf of the first component of a z_file, before any VB is merged
+void dict_template_zip_prime (void)
+{
+    if (tmpl_dt == DT_NONE || z_file->num_txts_so_far > 1) return;
+
+    ASSINP (tmpl_dt == (Z_DT(BCF) ? DT_VCF : z_file->data_type), "--dict-template: %s is a %s file, but %s is a %s file",
+            flag.dict_template, dt_name (tmpl_dt), txt_name, z_dt_name());
+
+    // the hash table is sized for the template's words scaled by the relative file size, as it cannot be resized later
+    double scale = MAX_(1.0, (double)txt_file->est_seggable_size / (double)MAX_(tmpl_txt_size, 1));
+
+    for_buf (TemplateDict, td, tmpl_dicts) {
+        ContextP zctx = ctx_get_existing_zctx (td->dict_id);
+        if (!zctx) zctx = ctx_add_new_zf_ctx_at_init (td->tag_name, strlen (td->tag_name), td->dict_id);
+
+        // don't prime aliases, CHROM, or a dictionary already populated (eg from the txt header)
+        if (zctx->dict_id.num != td->dict_id.num || zctx->dict_did_i != zctx->did_i ||
+            zctx->did_i == DTFZ(chrom) || zctx->nodes.len)
+            continue;
+
+        ctx_prime_zf_ctx (zctx, Bc(tmpl_data, td->char_index), td->dict_len, td->num_words,
+                          MIN_((double)td->num_words * scale, (double)MAX_WORDS_IN_CTX));
+    }
+}
+
+// true if this file references any of the primed words, or adds words of its own
+static bool dict_template_is_ctx_used (ConstContextP zctx)
+{
+    if (zctx->nodes.len > zctx->num_primed_words) return true;
+
+    for_buf (uint64_t, count, zctx->counts)
+        if (*count) return true;
+
+    return false;
+}
+
+// ZIP main thread: write a SEC_DICT_TEMPLATE section listing the primed dictionaries used by this file
+void dict_template_compress (void)
+{
+    if (tmpl_dt == DT_NONE) return;
+
+    ASSERTNOTINUSE (evb->scratch);
+    buf_alloc (evb, &evb->scratch, 0, z_file->num_contexts, DictTemplateEnt, 0, "scratch");
+
+    for_zctx {
+        if (!zctx->num_primed_words || zctx->please_remove_dict || !dict_template_is_ctx_used (zctx)) continue;
+
+        const CtxNode *last = B(CtxNode, zctx->nodes, zctx->num_primed_words - 1);
+        uint64_t dict_len = last->char_index + last->snip_len + 1; // primed words are at the start of the dict, in the order of their nodes
+
+        BNXT (DictTemplateEnt, evb->scratch) = (DictTemplateEnt){
+            .dict_id     = zctx->dict_id,
+            .num_words   = BGEN32 (zctx->num_primed_words),
+            .dict_crc32  = BGEN32 (digest_checksum (false, 0, zctx->dict.data, dict_len)),
+            .dict_len    = BGEN64 (dict_len),
+            .dict_helper = zctx->dict_helper,
+            .dict_flags  = (SectionFlags){ .dictionary = zctx->dict_flags }
+        };
+    }
+
+    if (evb->scratch.len) {
+        evb->scratch.len *= sizeof (DictTemplateEnt);
+        zfile_compress_section_data (evb, SEC_DICT_TEMPLATE, &evb->scratch);
+    }
+
+    buf_free (evb->scratch);
+}
+
+//------------
+// PIZ
+//------------
+
+// PIZ main thread: called before reading SEC_DICT sections: prime the dictionaries listed in SEC_DICT_TEMPLATE,
+// to which the file's SEC_DICT fragments are then appended
+void dict_template_piz_prime (void)
+{
+    Section sec = VER2(15,74) ? sections_first_sec (SEC_DICT_TEMPLATE, SOFT_FAIL) : NULL; // SEC_DICT_TEMPLATE introduced 15.0.74
+    if (!sec || flag.only_headers) return; // file was compressed without --dict-template, or dictionaries not needed
+
+    ASSINP (tmpl_dt != DT_NONE, "%s was compressed with --dict-template. To decompress it, please use --dict-template with the same template file", z_name);
+
+    zfile_get_global_section (SectionHeader, sec, &evb->scratch, "scratch");
+    evb->scratch.len /= sizeof (DictTemplateEnt);
+
+    for_buf (DictTemplateEnt, ent, evb->scratch) {
+        if (piz_is_skip_zf_dict (ent->dict_id)) continue; // not needed, just like its SEC_DICT sections
+
+        const TemplateDict *td = dict_template_find (ent->dict_id);
+        uint32_t num_words = BGEN32 (ent->num_words);
+        uint64_t dict_len  = BGEN64 (ent->dict_len);
+
+        ASSINP (td && td->num_words == num_words && td->dict_len == dict_len &&
+                digest_checksum (false, 0, Bc(tmpl_data, td->char_index), dict_len) == BGEN32 (ent->dict_crc32),
+                "--dict-template: dictionary %s of %s differs from that of the template file %s. Please use the same template file used to compress it",
+                dis_dict_id (ent->dict_id).s, z_name, flag.dict_template);
+
+        ContextP zctx = ctx_get_ctx_do (z_file->contexts, z_file->data_type, z_file->d2d_map, &z_file->num_contexts, ent->dict_id, 0, 0);
+        ASSERT (!zctx->dict.len, "expecting %s.dict to be empty", zctx->tag_name);
+
+        buf_alloc (evb, &zctx->dict, 0, dict_len, char, 0, "zctx->dict");
+        buf_set_shared (&zctx->dict);
+        memcpy (zctx->dict.data, Bc(tmpl_data, td->char_index), dict_len);
+
+        zctx->dict.len      = dict_len;
+        zctx->word_list.len = num_words; // word_list is built in dict_io_build_word_lists
+        zctx->dict_helper   = ent->dict_helper;
+        zctx->dict_flags    = ent->dict_flags.dictionary;
+        zctx->is_loaded     = zctx->z_data_exists = true; // as if it had a SEC_DICT section
+    }
+
+    buf_free (evb->scratch);
+}
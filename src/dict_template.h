@@ -0,0 +1,21 @@
+// ------------------------------------------------------------------
+//   dict_template.h
+//   Copyright (C) 2025-2025 Genozip Limited. Patent pending.
+//   Please see terms and conditions in the file LICENSE.txt
+//
+//   WARNING: Genozip is proprietary, not open source software. Modifying the source code is strictly prohibited
+//   and subject to penalties specified in the license.
+
+#pragma once
+
+#include "genozip.h"
+
+// ZIP & PIZ
+extern void dict_template_load (void);
+
+// ZIP
+extern void dict_template_zip_prime (void);
+extern void dict_template_compress (void);
+
+// PIZ
+extern void dict_template_piz_prime (void);
@@ -6,6 +6,7 @@
 //   WARNING: Genozip is proprietary, not open source software. Modifying the source code is strictly prohibited
 //   and subject to penalties specified in the license.
 
+#include <pthread.h>
 #include "libdeflate_1.19/libdeflate.h"
 #include "digest.h"
 #include "md5.h"
@@ -17,6 +18,10 @@
 #include "writer.h"
 #include "txtheader.h"
 #include "piz.h"
+#include "threads.h"
+#include "mutex.h"
+#include "arch.h"
+#include "profiler.h"
 
 #define IS_ADLER (IS_ZIP ? !flag.md5 : z_file->z_flags.adler)
 #define IS_MD5 (!IS_ADLER)
@@ -54,9 +59,133 @@ Digest digest_snapshot (const DigestContext *ctx, rom msg)
     return digest;
 }
 
+#define CHECKSUM_MIN_CHUNK_SIZE (16 MB)
+#define CHECKSUM_MAX_CHUNKS     16
+
+typedef struct {
+    bool is_adler;
+    uint32_t checksum;
+    rom data;
+    uint64_t data_len;
+    pthread_t thread;
+} ChecksumChunk;
+
+static void *checksum_one_chunk (void *arg)
+{
+    ChecksumChunk *chunk = (ChecksumChunk *)arg;
+
+    chunk->checksum = chunk->is_adler ? adler32 (1, STRa(chunk->data)) : crc32 (0, STRa(chunk->data));
+
+    return NULL;
+}
+
+// Adler32 or CRC32 of a large buffer, computed by the main or writer thread: the buffer is divided into chunks, each
+// checksummed by its own thread, and the chunk checksums are then combined. Compute threads, and buffers too small to
+// benefit, are checksummed in a single pass, as the compute threads already keep all cores busy.
+uint32_t digest_checksum (bool is_adler, uint32_t seed, STRp(data))
+{
+    uint32_t num_chunks = MIN_(MIN_(global_max_threads, CHECKSUM_MAX_CHUNKS), data_len / CHECKSUM_MIN_CHUNK_SIZE);
+
+    if (num_chunks < 2 || !(threads_am_i_main_thread() || threads_am_i_writer_thread()))
+        return is_adler ? adler32 (seed, STRa(data)) : crc32 (seed, STRa(data));
+
+    ChecksumChunk chunks[num_chunks];
+    uint64_t chunk_size = data_len / num_chunks;
+
+    for (uint32_t i=0; i < num_chunks; i++) {
+        chunks[i] = (ChecksumChunk){ .is_adler = is_adler,
+                                     .data     = data + i * chunk_size,
+                                     .data_len = (i == num_chunks-1) ? data_len - i * chunk_size : chunk_size };
+
+        // the first chunk is calculated by the calling thread, while the other threads are busy with the other chunks
+        if (i) {
+            int err;
+            ASSERT (!(err = pthread_create (&chunks[i].thread, NULL, checksum_one_chunk, &chunks[i])),
+                    "failed to create checksum thread: %s", strerror (err));
+        }
+    }
+
+    uint32_t checksum = is_adler ? adler32 (seed, chunks[0].data, chunks[0].data_len) 
+                                 : crc32   (seed, chunks[0].data, chunks[0].data_len);
+
+    for (uint32_t i=1; i < num_chunks; i++) {
+        int err;
+        ASSERT (!(err = PTHREAD_JOIN (chunks[i].thread, "checksum_one_chunk")), "pthread_join failed: %s", strerror (err));
+
+        checksum = is_adler ? adler32_combine (checksum, chunks[i].checksum, chunks[i].data_len)
+                            : crc32_combine   (checksum, chunks[i].checksum, chunks[i].data_len);
+    }
+
+    return checksum;
+}
+
+#ifdef DEBUG
+//------------------------------------------------------
+// Microbenchmark: genozip --bench-checksum (developer builds only)
+// verifies adler32_combine and crc32_combine against a single pass at odd split points, 
+// and reports the throughput of a single pass vs. digest_checksum
+//------------------------------------------------------
+
+#define BENCH_CHECKSUM_LEN (512 MB)
+
+void digest_benchmark (void)
+{
+    char *data = MALLOC (BENCH_CHECKSUM_LEN);
+
+    uint64_t rnd = 0x9E3779B97F4A7C15ULL;
+    for (uint64_t i=0; i < BENCH_CHECKSUM_LEN; i++) {
+        rnd ^= rnd << 13; rnd ^= rnd >> 7; rnd ^= rnd << 17; // xorshift64
+        data[i] = rnd;
+    }
+
+    // split points around Adler32's BASE and NMAX, chunk sizes, and odd lengths
+    uint64_t splits[] = { 0, 1, 3, 5551, 5552, 5553, 65520, 65521, 65522, 1 MB + 7, 16 MB - 1, 16 MB + 13, BENCH_CHECKSUM_LEN - 1, BENCH_CHECKSUM_LEN };
+
+    for (int is_adler=0; is_adler <= 1; is_adler++) {
+        #define CHECKSUM(seed, data, len) (is_adler ? adler32 ((seed), (data), (len)) : crc32 ((seed), (data), (len)))
+        rom name = is_adler ? "adler32" : "crc32";
+        uint32_t init = is_adler ? 1 : 0;
+
+        // every split point of short buffers, with an arbitrary seed for the first part
+        for (uint32_t len=0; len <= 300; len++) {
+            uint32_t whole = CHECKSUM (12345, data, len);
+            for (uint32_t split=0; split <= len; split++) {
+                uint32_t c1 = CHECKSUM (12345, data, split), c2 = CHECKSUM (init, data + split, len - split);
+                uint32_t combined = is_adler ? adler32_combine (c1, c2, len - split) : crc32_combine (c1, c2, len - split);
+                ASSERT (combined == whole, "%s_combine mismatch: len=%u split=%u", name, len, split);
+            }
+        }
+
+        uint32_t whole;
+        { START_TIMER_ALWAYS; whole = CHECKSUM (init, data, BENCH_CHECKSUM_LEN);
+          printf ("%-8s single-pass %8.0f MB/s\n", name, (double)BENCH_CHECKSUM_LEN * 1000.0 / (double)MAX_(CHECK_TIMER, 1)); }
+
+        for (int i=0; i < ARRAY_LEN(splits); i++) {
+            uint64_t split = splits[i];
+            uint32_t c1 = CHECKSUM (init, data, split), c2 = CHECKSUM (init, data + split, BENCH_CHECKSUM_LEN - split);
+            uint32_t combined = is_adler ? adler32_combine (c1, c2, BENCH_CHECKSUM_LEN - split) : crc32_combine (c1, c2, BENCH_CHECKSUM_LEN - split);
+            ASSERT (combined == whole, "%s_combine mismatch: split=%"PRIu64, name, split);
+        }
+
+        // chunked, with all cores and with odd length
+        global_max_threads = arch_get_num_cores();
+        uint32_t chunked;
+        { START_TIMER_ALWAYS; chunked = digest_checksum (is_adler, init, data, BENCH_CHECKSUM_LEN);
+          printf ("%-8s chunked     %8.0f MB/s (%u threads)\n", name, (double)BENCH_CHECKSUM_LEN * 1000.0 / (double)MAX_(CHECK_TIMER, 1), global_max_threads); }
+        
+        ASSERT (chunked == whole, "%s: digest_checksum mismatch", name);
+        ASSERT (digest_checksum (is_adler, init, data, BENCH_CHECKSUM_LEN - 7) == CHECKSUM (init, data, BENCH_CHECKSUM_LEN - 7), 
+                "%s: digest_checksum mismatch (odd length)", name);
+        #undef CHECKSUM
+    }
+
+    exit (0);
+}
+#endif
+
 Digest digest_do (STRp(data), bool is_adler, rom show_digest_msg)
 {
-    Digest digest = is_adler ? (Digest){ .words = { BGEN32 (adler32 (1, STRa(data))) } }
+    Digest digest = is_adler ? (Digest){ .words = { BGEN32 (digest_checksum (true, 1, STRa(data))) } }
                              : md5_do (STRa(data));
 
     if (flag.show_digest)
@@ -80,7 +209,7 @@ static void digest_update_do (VBlockP vb, DigestContext *ctx, rom data, uint64_t
             ctx->adler_ctx.initialized = true;
         }
         if (flag.show_digest) before = *ctx;
-        ctx->adler_ctx.adler = adler32 (ctx->adler_ctx.adler, STRa(data));
+        ctx->adler_ctx.adler = digest_checksum (true, ctx->adler_ctx.adler, STRa(data));
     }
 
     else {
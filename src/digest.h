@@ -63,6 +63,10 @@ extern void digest_piz_verify_one_txt_file (unsigned txt_file_i);
 extern bool digest_piz_has_it_failed (void);
 
 extern Digest digest_do (STRp(data), bool is_adler, rom show_digest_msg);
+extern uint32_t digest_checksum (bool is_adler, uint32_t seed, STRp(data));
+#ifdef DEBUG
+extern void digest_benchmark (void);
+#endif
 
 typedef struct { char s[64]; } DigestDisplay;
 extern DigestDisplay digest_display (Digest digest);
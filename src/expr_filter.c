@@ -0,0 +1,664 @@
+// ------------------------------------------------------------------
+//   expr_filter.c
+//   Copyright (C) 2025-2025 Genozip Limited. Patent pending.
+//   Please see terms and conditions in the file LICENSE.txt
+//
+//   WARNING: Genozip is proprietary, not open source software. Modifying the source code is strictly prohibited
+//   and subject to penalties specified in the license.
+
+// genocat --filter: the expression is compiled once into RPN programs - one per top-level && conjunct. During
+// reconstruction of the top-level container, each conjunct is evaluated as soon as the top-level items containing
+// all the fields it references are reconstructed, and the line is dropped as soon as a conjunct fails - remaining
+// conjuncts are not evaluated.
+//
+// Field names:
+// - Top level fields by their name, eg CHROM, POS, FILTER, QUAL, FLAG, MAPQ, RNAME
+// - VCF: INFO/<name> for INFO fields, and REF and ALT
+// - SAM/BAM: aux fields by their 2-character tag, eg NM ; SEQ
+// - An identifier that is not the name of a field in the file is a string, eg PASS in FILTER==PASS
+// Operators (in order of increasing precedence): || && | & (== != < <= > >=) (! -) and length(field)
+// A comparison in which a number is involved is numeric, otherwise it is a string comparison. A comparison
+// involving a field missing in the line is false.
+//
+// Predicate pushdown: conjuncts of the form CHROM==string (RNAME in SAM/BAM) or, in VCF, POS<op>number, are also
+// tested against the random access entries of each VB, and VBs that cannot have a surviving line are not read at all.
+
+#include "expr_filter.h"
+#include "container.h"
+#include "reconstruct.h"
+#include "strings.h"
+#include "buffer.h"
+#include "file.h"
+#include "vcf.h"
+#include "sam.h"
+#include "random_access.h"
+
+#define MAX_FILTER_OPS       256
+#define MAX_FILTER_REFS      32
+#define MAX_FILTER_CONJUNCTS 32
+#define MAX_REF_CANDIDATES   5   // SAM aux field: type is unknown, eg NM:i or NM:Z
+#define EVAL_AT_EOL          0xffff
+
+typedef enum { OP_NUM, OP_STR, OP_REF, OP_LENGTH, OP_NOT, OP_NEG, OP_OR, OP_AND, OP_BOR, OP_BAND,
+               OP_EQ, OP_NE, OP_LT, OP_LE, OP_GT, OP_GE, OP_NONE } ExprOpType;
+
+typedef struct {
+    ExprOpType type;
+    uint8_t ref_i;      // OP_REF
+    double num;         // OP_NUM
+    rom str;            // OP_STR
+    uint32_t str_len;
+} ExprOp;
+
+// compiled expression - set once by the main thread while parsing the command line, read-only afterwards
+static struct {
+    rom expr;
+    ExprOp ops[MAX_FILTER_OPS];
+    uint32_t n_ops;
+    struct { uint32_t first_op, n_ops; } conj[MAX_FILTER_CONJUNCTS];
+    uint32_t n_conj;
+    struct { rom name; uint32_t name_len; } refs[MAX_FILTER_REFS];
+    uint32_t n_refs;
+} filt = {};
+
+// per-VB state, resolved against the VB's contexts and top-level container, in vb->filter_state
+typedef struct {
+    struct {
+        DictId dict_ids[MAX_REF_CANDIDATES];
+        uint8_t n_dict_ids;
+        DictId anchor;        // top-level item containing this field
+        int8_t part;          // VCF REF/ALT: tab-separated part of REF+ALT. -1 if entire field.
+        bool is_seq;          // length is vb->seq_len
+        bool is_literal;      // not the name of a field in this file - it is a string
+    } refs[MAX_FILTER_REFS];
+    uint16_t eval_after_item[MAX_FILTER_CONJUNCTS]; // top-level item after which the conjunct is evaluated, or EVAL_AT_EOL
+    LineIType line_i;         // line to which "done" applies
+    uint32_t done;            // bitmap of conjuncts already evaluated in line_i
+} ExprFilterVb;
+
+typedef enum { EV_MISSING, EV_DEFER, EV_NUM, EV_STR } ExprValueType;
+
+typedef struct {
+    ExprValueType type;
+    bool has_num;       // EV_STR: num is valid too (value of a numeric field)
+    double num;
+    rom s;              // EV_STR
+    uint32_t len;
+    uint32_t length;    // for length(): usually len
+} ExprValue;
+
+#define EV_BOOL(b) ((ExprValue){ .type = EV_NUM, .num = !!(b) })
+
+//-----------------------------------------------------------
+// Compiling (main thread, while parsing the command line)
+//-----------------------------------------------------------
+
+typedef enum { TK_END, TK_NUM, TK_STR, TK_IDENT, TK_LPAREN, TK_RPAREN, TK_OP } TokenType;
+
+typedef struct {
+    TokenType type;
+    ExprOpType op;
+    rom s;
+    uint32_t len;
+    double num;
+} Token;
+
+static Token tokens[MAX_FILTER_OPS + 1];
+static uint32_t n_tokens, next_tk, end_tk;
+
+#define IS_IDENT_CHAR(c) (IS_LETTER(c) || IS_DIGIT(c) || (c)=='_' || (c)=='/' || (c)==':' || (c)=='.' || (c)=='+')
+
+static void expr_filter_tokenize (rom expr)
+{
+    rom c = expr;
+    n_tokens = 0;
+
+    while (true) {
+        while (*c == ' ' || *c == '\t') c++;
+
+        ASSINP (n_tokens < MAX_FILTER_OPS, "--filter expression is too long (more than %u tokens)", MAX_FILTER_OPS);
+
+        Token *tk = &tokens[n_tokens++];
+        *tk = (Token){ .s = c, .len = 1, .op = OP_NONE };
+
+        #define OP2(s2, op2, op1) if (c[1] == (s2)) { tk->op = (op2); tk->len = 2; } else tk->op = (op1)
+
+        switch (*c) {
+            case 0   : tk->type = TK_END; return;
+            case '(' : tk->type = TK_LPAREN; break;
+            case ')' : tk->type = TK_RPAREN; break;
+            case '|' : tk->type = TK_OP; OP2('|', OP_OR,  OP_BOR);  break;
+            case '&' : tk->type = TK_OP; OP2('&', OP_AND, OP_BAND); break;
+            case '=' : tk->type = TK_OP; OP2('=', OP_EQ,  OP_EQ);   break; // = is accepted as ==
+            case '!' : tk->type = TK_OP; OP2('=', OP_NE,  OP_NOT);  break;
+            case '<' : tk->type = TK_OP; OP2('=', OP_LE,  OP_LT);   break;
+            case '>' : tk->type = TK_OP; OP2('=', OP_GE,  OP_GT);   break;
+            case '-' : tk->type = TK_OP; tk->op = OP_NEG; break;
+
+            case '"' : case '\'' : {
+                rom close = strchr (c+1, *c);
+                ASSINP (close, "--filter: missing closing %c in \"%s\"", *c, expr);
+                *tk = (Token){ .type = TK_STR, .s = c+1, .len = close - c - 1 };
+                c = close + 1;
+                continue;
+            }
+
+            default:
+                if (IS_DIGIT(*c) || (*c == '.' && IS_DIGIT(c[1]))) {
+                    char *after;
+                    tk->num  = (c[0]=='0' && (c[1]=='x' || c[1]=='X')) ? (double)strtoull (c, &after, 16) : strtod (c, &after);
+                    tk->type = TK_NUM;
+                    tk->len  = after - c;
+                }
+
+                else if (IS_IDENT_CHAR(*c)) {
+                    tk->type = TK_IDENT;
+                    for (tk->len=0; IS_IDENT_CHAR(c[tk->len]); tk->len++);
+                }
+
+                else
+                    ASSINP (false, "--filter: unexpected character '%c' in \"%s\"", *c, expr);
+        }
+
+        c += tk->len;
+    }
+}
+
+static void expr_filter_emit (ExprOp op)
+{
+    ASSINP (filt.n_ops < MAX_FILTER_OPS, "--filter expression is too long (more than %u operations)", MAX_FILTER_OPS);
+    filt.ops[filt.n_ops++] = op;
+}
+
+static uint8_t expr_filter_add_ref (STRp(name))
+{
+    for (uint8_t ref_i=0; ref_i < filt.n_refs; ref_i++)
+        if (str_issame_(STRa(name), filt.refs[ref_i].name, filt.refs[ref_i].name_len)) return ref_i;
+
+    ASSINP (filt.n_refs < MAX_FILTER_REFS, "--filter expression references too many fields (max %u)", MAX_FILTER_REFS);
+    filt.refs[filt.n_refs] = (typeof(filt.refs[0])){ .name = name, .name_len = name_len };
+
+    return filt.n_refs++;
+}
+
+static inline bool expr_filter_is_op (ExprOpType op)
+{
+    return next_tk < end_tk && tokens[next_tk].type == TK_OP && tokens[next_tk].op == op;
+}
+
+static void expr_filter_parse_or (void);
+
+static void expr_filter_parse_primary (void)
+{
+    ASSINP (next_tk < end_tk, "--filter: unexpected end of expression in \"%s\"", filt.expr);
+    Token *tk = &tokens[next_tk++];
+
+    switch (tk->type) {
+        case TK_NUM : expr_filter_emit ((ExprOp){ .type = OP_NUM, .num = tk->num }); break;
+        case TK_STR : expr_filter_emit ((ExprOp){ .type = OP_STR, .str = tk->s, .str_len = tk->len }); break;
+
+        case TK_LPAREN :
+            expr_filter_parse_or();
+            ASSINP (next_tk < end_tk && tokens[next_tk++].type == TK_RPAREN, "--filter: missing ')' in \"%s\"", filt.expr);
+            break;
+
+        case TK_IDENT :
+            // case: function
+            if (next_tk < end_tk && tokens[next_tk].type == TK_LPAREN) {
+                ASSINP (str_issame_(tk->s, tk->len, _S("length")), "--filter: unknown function \"%.*s\" - only length() is supported", tk->len, tk->s);
+                next_tk++; // skip (
+                expr_filter_parse_or();
+                ASSINP (next_tk < end_tk && tokens[next_tk++].type == TK_RPAREN, "--filter: missing ')' in \"%s\"", filt.expr);
+                expr_filter_emit ((ExprOp){ .type = OP_LENGTH });
+            }
+            else
+                expr_filter_emit ((ExprOp){ .type = OP_REF, .ref_i = expr_filter_add_ref (tk->s, tk->len) });
+            break;
+
+        default :
+            ASSINP (false, "--filter: unexpected \"%.*s\" in \"%s\"", tk->type == TK_END ? 3 : tk->len, tk->type == TK_END ? "end" : tk->s, filt.expr);
+    }
+}
+
+static void expr_filter_parse_unary (void)
+{
+    if (expr_filter_is_op (OP_NOT) || expr_filter_is_op (OP_NEG)) {
+        ExprOpType op = tokens[next_tk++].op;
+        expr_filter_parse_unary();
+        expr_filter_emit ((ExprOp){ .type = op });
+    }
+    else
+        expr_filter_parse_primary();
+}
+
+static void expr_filter_parse_cmp (void)
+{
+    expr_filter_parse_unary();
+
+    for (ExprOpType op=OP_EQ; op <= OP_GE; op++)
+        if (expr_filter_is_op (op)) {
+            next_tk++;
+            expr_filter_parse_unary();
+            expr_filter_emit ((ExprOp){ .type = op });
+            break;
+        }
+}
+
+// binary operators of the same precedence, left-associative
+#define PARSE_BINARY(func, op, operand_func)        \
+static void func (void)                             \
+{                                                   \
+    operand_func();                                 \
+    while (expr_filter_is_op (op)) {                \
+        next_tk++;                                  \
+        operand_func();                             \
+        expr_filter_emit ((ExprOp){ .type = op });  \
+    }                                               \
+}
+PARSE_BINARY (expr_filter_parse_band, OP_BAND, expr_filter_parse_cmp)
+PARSE_BINARY (expr_filter_parse_bor,  OP_BOR,  expr_filter_parse_band)
+PARSE_BINARY (expr_filter_parse_and,  OP_AND,  expr_filter_parse_bor)
+PARSE_BINARY (expr_filter_parse_or,   OP_OR,   expr_filter_parse_and)
+
+static void expr_filter_compile_conjunct (uint32_t first_tk, uint32_t after_tk)
+{
+    ASSINP (filt.n_conj < MAX_FILTER_CONJUNCTS, "--filter: too many && terms (max %u)", MAX_FILTER_CONJUNCTS);
+    ASSINP (first_tk < after_tk, "--filter: empty term in \"%s\"", filt.expr);
+
+    filt.conj[filt.n_conj].first_op = filt.n_ops;
+
+    next_tk = first_tk;
+    end_tk  = after_tk;
+    expr_filter_parse_or();
+
+    ASSINP (next_tk == after_tk, "--filter: unexpected \"%.*s\" in \"%s\"", tokens[next_tk].len, tokens[next_tk].s, filt.expr);
+
+    filt.conj[filt.n_conj].n_ops = filt.n_ops - filt.conj[filt.n_conj].first_op;
+    filt.n_conj++;
+}
+
+// called from flags.c while parsing --filter
+void expr_filter_compile (rom expr)
+{
+    ASSINP0 (!flag.filter, "--filter can be only be used once on the command line");
+    flag.filter = filt.expr = expr;
+
+    expr_filter_tokenize (expr);
+    uint32_t end = n_tokens - 1; // excluding TK_END
+
+    // split into top-level && conjuncts, so each can be evaluated as early as possible - unless there is a top-level ||
+    bool has_toplevel_or = false;
+    int depth = 0;
+    for (uint32_t i=0; i < end; i++) {
+        if      (tokens[i].type == TK_LPAREN) depth++;
+        else if (tokens[i].type == TK_RPAREN) depth--;
+        else if (!depth && tokens[i].type == TK_OP && tokens[i].op == OP_OR) has_toplevel_or = true;
+    }
+    ASSINP (!depth, "--filter: unbalanced parentheses in \"%s\"", expr);
+
+    uint32_t first_tk = 0;
+    if (!has_toplevel_or)
+        for (uint32_t i=0; i < end; i++) {
+            if      (tokens[i].type == TK_LPAREN) depth++;
+            else if (tokens[i].type == TK_RPAREN) depth--;
+            else if (!depth && tokens[i].type == TK_OP && tokens[i].op == OP_AND) {
+                expr_filter_compile_conjunct (first_tk, i);
+                first_tk = i + 1;
+            }
+        }
+
+    expr_filter_compile_conjunct (first_tk, end);
+}
+
+//-----------------------------------------------------------
+// Evaluating (compute threads, during reconstruction)
+//-----------------------------------------------------------
+
+static void expr_filter_resolve_ref (VBlockP vb, ExprFilterVb *st, unsigned ref_i)
+{
+    rom name = filt.refs[ref_i].name;
+    uint32_t name_len = filt.refs[ref_i].name_len;
+    typeof(st->refs[0]) *ref = &st->refs[ref_i];
+    *ref = (typeof(st->refs[0])){ .part = -1 };
+
+    #define ADD_CANDIDATE(dict_id) ref->dict_ids[ref->n_dict_ids++] = (dict_id)
+
+    if ((VB_DT(VCF) || VB_DT(BCF)) && name_len > 5 && !memcmp (name, "INFO/", 5)) {
+        ADD_CANDIDATE (dict_id_make (name + 5, name_len - 5, DTYPE_VCF_INFO));
+        ref->anchor = (DictId){ .num = _VCF_INFO };
+    }
+
+    else if ((VB_DT(VCF) || VB_DT(BCF)) && (str_issame_(STRa(name), _S("REF")) || str_issame_(STRa(name), _S("ALT")))) {
+        ADD_CANDIDATE (((DictId){ .num = _VCF_REFALT }));
+        ref->anchor = ref->dict_ids[0];
+        ref->part   = (name[0] == 'A');
+    }
+
+    else if ((VB_DT(SAM) || VB_DT(BAM) || VB_DT(FASTQ)) && str_issame_(STRa(name), _S("SEQ"))) {
+        ADD_CANDIDATE (((DictId){ .num = _SAM_SQBITMAP })); // note: same as _FASTQ_SQBITMAP
+        ref->anchor = ref->dict_ids[0];
+        ref->is_seq = true;
+    }
+
+    // SAM/BAM aux field: we don't know its type, so we try all types
+    else if ((VB_DT(SAM) || VB_DT(BAM)) && name_len == 2) {
+        for (rom type = "iZfAH"; *type; type++)
+            ADD_CANDIDATE (dict_id_make ((char[]){ name[0], name[1], ':', *type }, 4, DTYPE_2/*DTYPE_SAM_AUX*/));
+        ref->anchor = (DictId){ .num = _SAM_AUX };
+    }
+
+    else {
+        ADD_CANDIDATE (dict_id_make (STRa(name), DTYPE_FIELD));
+        ref->anchor = ref->dict_ids[0];
+    }
+
+    // case: not a field in this file - it is a string literal
+    ref->is_literal = true;
+    for (int i=0; i < ref->n_dict_ids; i++)
+        if (ECTX (ref->dict_ids[i])) ref->is_literal = false;
+}
+
+// called before reconstructing a top-level container: resolve field names and decide when to evaluate each conjunct
+void expr_filter_init_toplevel (VBlockP vb, ConstContainerP con)
+{
+    buf_alloc_exact_zero (vb, vb->filter_state, sizeof (ExprFilterVb), char, "filter_state");
+    ExprFilterVb *st = B1ST (ExprFilterVb, vb->filter_state);
+
+    st->line_i = NO_LINE;
+
+    for (unsigned ref_i=0; ref_i < filt.n_refs; ref_i++)
+        expr_filter_resolve_ref (vb, st, ref_i);
+
+    for (unsigned conj_i=0; conj_i < filt.n_conj; conj_i++) {
+        st->eval_after_item[conj_i] = 0; // constant expression - evaluate after first item
+
+        for (unsigned op_i=0; op_i < filt.conj[conj_i].n_ops; op_i++) {
+            const ExprOp *op = &filt.ops[filt.conj[conj_i].first_op + op_i];
+            if (op->type != OP_REF || st->refs[op->ref_i].is_literal) continue;
+
+            // find the top-level item containing the field. If it is not a top-level item - evaluate at the end of the line
+            uint16_t item_i=0;
+            while (item_i < con_nitems (*con) && con->items[item_i].dict_id.num != st->refs[op->ref_i].anchor.num) item_i++;
+
+            st->eval_after_item[conj_i] = (item_i == con_nitems (*con)) ? EVAL_AT_EOL : MAX_(st->eval_after_item[conj_i], item_i);
+        }
+    }
+}
+
+static bool expr_filter_to_num (const ExprValue *v, double *n)
+{
+    if (v->type == EV_NUM || v->has_num) { *n = v->num; return true; }
+
+    return v->type == EV_STR && v->len && str_get_float (v->s, v->len, n, NULL, NULL);
+}
+
+static ExprValue expr_filter_get_ref (VBlockP vb, ExprFilterVb *st, unsigned ref_i, bool at_eol)
+{
+    typeof(st->refs[0]) *ref = &st->refs[ref_i];
+
+    if (ref->is_literal)
+        return (ExprValue){ .type = EV_STR, .s = filt.refs[ref_i].name, .len = filt.refs[ref_i].name_len, .length = filt.refs[ref_i].name_len };
+
+    ContextP ctx = NULL;
+    for (int i=0; i < ref->n_dict_ids && !ctx; i++)
+        if ((ctx = ECTX (ref->dict_ids[i])) && !ctx_encountered_in_line (vb, ctx->did_i))
+            ctx = NULL;
+
+    if (!ctx) return (ExprValue){ .type = EV_MISSING };
+
+    // case: value is inserted only after the line's samples are reconstructed (eg VCF INFO/DP)
+    if (!at_eol && ctx->special_res == SPEC_RES_DEFERRED) return (ExprValue){ .type = EV_DEFER };
+
+    ExprValue v = { .type = EV_STR, .s = last_txtx (vb, ctx), .len = ctx->last_txt.len };
+
+    // case: REF or ALT
+    if (ref->part >= 0) {
+        rom tab = memchr (v.s, '\t', v.len);
+        if (!tab) return (ExprValue){ .type = EV_MISSING };
+
+        if (ref->part == 0) v.len = tab - v.s;
+        else { v.len -= tab + 1 - v.s; v.s = tab + 1; }
+    }
+
+    // numeric fields: use the value, as text might be binary (eg BAM)
+    else if (ctx_has_value_in_line_(vb, ctx) && ctx->flags.store == STORE_INT)   { v.num = ctx->last_value.i; v.has_num = true; }
+    else if (ctx_has_value_in_line_(vb, ctx) && ctx->flags.store == STORE_FLOAT) { v.num = ctx->last_value.f; v.has_num = true; }
+
+    v.length = ref->is_seq ? vb->seq_len : v.len;
+    return v;
+}
+
+static inline int expr_filter_truth (const ExprValue *v) // -1 if deferred
+{
+    return v->type == EV_DEFER ? -1
+         : v->type == EV_NUM   ? (v->num != 0)
+         : v->type == EV_STR   ? (v->has_num ? (v->num != 0) : (v->len > 0))
+         :                       0; // EV_MISSING
+}
+
+static ExprValue expr_filter_compare (ExprOpType op, const ExprValue *a, const ExprValue *b)
+{
+    if (a->type == EV_DEFER || b->type == EV_DEFER) return (ExprValue){ .type = EV_DEFER };
+    if (a->type == EV_MISSING || b->type == EV_MISSING) return EV_BOOL(false);
+
+    int cmp;
+
+    // numeric comparison if a number is involved (a literal or a result of an operator), or both are numeric fields
+    if (a->type == EV_NUM || b->type == EV_NUM || (a->has_num && b->has_num)) {
+        double x, y;
+        if (!expr_filter_to_num (a, &x) || !expr_filter_to_num (b, &y))
+            return EV_BOOL(op == OP_NE); // a non-numeric string is not equal to any number
+
+        cmp = (x > y) - (x < y);
+    }
+
+    else {
+        // in binary output, the reconstructed text of a field is not its textual value (eg RNAME in BAM is a ref_id)
+        ASSINP (!DTPO(is_binary), "--filter: string comparisons are not supported when outputting %s data%s", 
+                dt_name (flag.out_dt), OUT_DT(BAM) || OUT_DT(CRAM) ? ". Tip: add --sam" : OUT_DT(BCF) ? ". Tip: add --vcf" : "");
+
+        cmp = memcmp (a->s, b->s, MIN_(a->len, b->len));
+        if (!cmp) cmp = (a->len > b->len) - (a->len < b->len);
+    }
+
+    switch (op) {
+        case OP_EQ : return EV_BOOL(cmp == 0);
+        case OP_NE : return EV_BOOL(cmp != 0);
+        case OP_LT : return EV_BOOL(cmp <  0);
+        case OP_LE : return EV_BOOL(cmp <= 0);
+        case OP_GT : return EV_BOOL(cmp >  0);
+        default    : return EV_BOOL(cmp >= 0);
+    }
+}
+
+// returns 1 if conjunct is true, 0 if false and -1 if it cannot be evaluated yet
+static int expr_filter_eval_conjunct (VBlockP vb, ExprFilterVb *st, unsigned conj_i, bool at_eol)
+{
+    ExprValue stack[filt.conj[conj_i].n_ops];
+    int sp = 0;
+
+    for (unsigned op_i=0; op_i < filt.conj[conj_i].n_ops; op_i++) {
+        const ExprOp *op = &filt.ops[filt.conj[conj_i].first_op + op_i];
+        ExprValue *a = (sp >= 2) ? &stack[sp-2] : NULL; // operands of binary operators (the parser guarantees they exist)
+        ExprValue *b = (sp >= 1) ? &stack[sp-1] : NULL; // operand of unary operators
+
+        switch (op->type) {
+            case OP_NUM    : stack[sp++] = (ExprValue){ .type = EV_NUM, .num = op->num }; break;
+            case OP_STR    : stack[sp++] = (ExprValue){ .type = EV_STR, .s = op->str, .len = op->str_len, .length = op->str_len }; break;
+            case OP_REF    : stack[sp++] = expr_filter_get_ref (vb, st, op->ref_i, at_eol); break;
+
+            case OP_LENGTH :
+                if (b->type == EV_STR) *b = (ExprValue){ .type = EV_NUM, .num = b->length };
+                else if (b->type == EV_NUM) *b = (ExprValue){ .type = EV_MISSING };
+                break;
+
+            case OP_NOT    : { int t = expr_filter_truth (b); if (t >= 0) *b = EV_BOOL(!t); break; }
+
+            case OP_NEG    : { double n; *b = expr_filter_to_num (b, &n) ? (ExprValue){ .type = EV_NUM, .num = -n }
+                                            : (b->type == EV_DEFER) ? *b : (ExprValue){ .type = EV_MISSING }; break; }
+
+            case OP_AND    :
+            case OP_OR     : {
+                int ta = expr_filter_truth (a), tb = expr_filter_truth (b);
+                bool decisive = (op->type == OP_OR); // the value that decides the result regardless of the other operand
+
+                *a = (ta == decisive || tb == decisive) ? EV_BOOL(decisive)
+                   : (ta < 0 || tb < 0)                 ? (ExprValue){ .type = EV_DEFER }
+                   :                                      EV_BOOL(!decisive);
+                sp--;
+                break;
+            }
+
+            case OP_BAND   :
+            case OP_BOR    : {
+                double x, y;
+                if (a->type == EV_DEFER || b->type == EV_DEFER) *a = (ExprValue){ .type = EV_DEFER };
+                else if (!expr_filter_to_num (a, &x) || !expr_filter_to_num (b, &y)) *a = (ExprValue){ .type = EV_MISSING };
+                else *a = (ExprValue){ .type = EV_NUM, .num = (op->type == OP_BAND) ? ((int64_t)x & (int64_t)y) : ((int64_t)x | (int64_t)y) };
+                sp--;
+                break;
+            }
+
+            default        : *a = expr_filter_compare (op->type, a, b); sp--; break;
+        }
+    }
+
+    return expr_filter_truth (&stack[0]);
+}
+
+static inline ExprFilterVb *expr_filter_get_state (VBlockP vb)
+{
+    ExprFilterVb *st = B1ST (ExprFilterVb, vb->filter_state);
+
+    if (st->line_i != vb->line_i) { // first call for this line
+        st->line_i = vb->line_i;
+        st->done   = 0;
+    }
+
+    return st;
+}
+
+// called after each top-level item is reconstructed: evaluate conjuncts whose fields are all reconstructed, and drop the line if one fails
+void expr_filter_after_item (VBlockP vb, unsigned item_i)
+{
+    ExprFilterVb *st = expr_filter_get_state (vb);
+
+    for (unsigned conj_i=0; conj_i < filt.n_conj; conj_i++)
+        if (st->eval_after_item[conj_i] == item_i) {
+            int res = expr_filter_eval_conjunct (vb, st, conj_i, false);
+
+            if (res == 0) {
+                vb->drop_curr_line = "filter";
+                return; // no need to evaluate the remaining conjuncts
+            }
+
+            if (res == 1) st->done |= (1u << conj_i);
+        }
+}
+
+// called after the line is reconstructed: evaluate conjuncts not evaluated yet (deferred, not top-level or filtered out)
+bool expr_filter_does_line_survive (VBlockP vb)
+{
+    ExprFilterVb *st = expr_filter_get_state (vb);
+
+    for (unsigned conj_i=0; conj_i < filt.n_conj; conj_i++)
+        if (!(st->done & (1u << conj_i)) && expr_filter_eval_conjunct (vb, st, conj_i, true) != 1)
+            return false;
+
+    return true;
+}
+
+//-----------------------------------------------------------
+// Predicate pushdown (main thread, while creating the reconstruction plan)
+//-----------------------------------------------------------
+
+typedef struct { bool is_pos; ExprOpType op; WordIndex chrom; double pos; } PushdownPred;
+
+static PushdownPred preds[MAX_FILTER_CONJUNCTS];
+static uint32_t n_preds;
+
+static bool expr_filter_is_ref_to (const ExprOp *op, Did did_i)
+{
+    return op->type == OP_REF && did_i != DID_NONE &&
+           str_issame_(filt.refs[op->ref_i].name, filt.refs[op->ref_i].name_len, ZCTX(did_i)->tag_name, strlen (ZCTX(did_i)->tag_name));
+}
+
+// get string of an OP_STR, or of an identifier which is not a field in this file
+static bool expr_filter_get_literal_str (const ExprOp *op, pSTRp(str))
+{
+    if (op->type == OP_STR) {
+        *str = op->str;
+        *str_len = op->str_len;
+        return true;
+    }
+
+    if (op->type == OP_REF && !ctx_get_existing_zctx (dict_id_make (filt.refs[op->ref_i].name, filt.refs[op->ref_i].name_len, DTYPE_FIELD))) {
+        *str = filt.refs[op->ref_i].name;
+        *str_len = filt.refs[op->ref_i].name_len;
+        return true;
+    }
+
+    return false;
+}
+
+// called per component, after random access is loaded. returns true if VBs can be filtered out by expr_filter_is_vb_included
+bool expr_filter_prepare_pushdown (void)
+{
+    n_preds = 0;
+    if (!flag.filter || !z_file->ra_buf.len) return false;
+
+    Did chrom_did_i = DTFZ(chrom);
+    Did pos_did_i   = (Z_DT(VCF) || Z_DT(BCF)) ? DTFZ(pos) : DID_NONE; // in SAM, lines without RA data (eg unmapped) have POS too
+
+    for (unsigned conj_i=0; conj_i < filt.n_conj; conj_i++) {
+        if (filt.conj[conj_i].n_ops != 3) continue;
+
+        const ExprOp *ops = &filt.ops[filt.conj[conj_i].first_op];
+        ExprOpType op = ops[2].type;
+        if (op < OP_EQ || op > OP_GE) continue;
+
+        // normalize to "field op value"
+        const ExprOp *field = &ops[0], *value = &ops[1];
+        if (!expr_filter_is_ref_to (field, chrom_did_i) && !expr_filter_is_ref_to (field, pos_did_i)) {
+            SWAP (field, value);
+            op = (op == OP_LT) ? OP_GT : (op == OP_GT) ? OP_LT : (op == OP_LE) ? OP_GE : (op == OP_GE) ? OP_LE : op;
+        }
+
+        STR(chrom);
+        if (op == OP_EQ && expr_filter_is_ref_to (field, chrom_did_i) && ZCTX(chrom_did_i)->word_list.len &&
+            expr_filter_get_literal_str (value, pSTRa(chrom)) && !str_issame_(STRa(chrom), "*", 1) && !str_issame_(STRa(chrom), "=", 1))
+            preds[n_preds++] = (PushdownPred){ .chrom = ctx_search_for_word_index (ZCTX(chrom_did_i), STRa(chrom)) }; // WORD_INDEX_NONE if not in file - no VB has it
+
+        else if (op != OP_NE && expr_filter_is_ref_to (field, pos_did_i) && value->type == OP_NUM)
+            preds[n_preds++] = (PushdownPred){ .is_pos = true, .op = op, .pos = value->num };
+    }
+
+    return n_preds > 0;
+}
+
+// true if there might be a line in the range that satisfies all predicates
+static bool expr_filter_is_ra_included (WordIndex chrom_index, PosType64 min_pos, PosType64 max_pos)
+{
+    for (unsigned i=0; i < n_preds; i++) {
+        PushdownPred *p = &preds[i];
+
+        if (!p->is_pos) {
+            if (chrom_index != p->chrom) return false;
+        }
+
+        else switch (p->op) {
+            case OP_EQ : if (p->pos < min_pos || p->pos > max_pos) return false; break;
+            case OP_LT : if (!(min_pos <  p->pos)) return false; break;
+            case OP_LE : if (!(min_pos <= p->pos)) return false; break;
+            case OP_GT : if (!(max_pos >  p->pos)) return false; break;
+            default    : if (!(max_pos >= p->pos)) return false; break; // OP_GE
+        }
+    }
+
+    return true;
+}
+
+bool expr_filter_is_vb_included (VBIType vb_i)
+{
+    return !n_preds || random_access_is_vb_included_by (vb_i, expr_filter_is_ra_included);
+}
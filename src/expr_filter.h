@@ -0,0 +1,19 @@
+// ------------------------------------------------------------------
+//   expr_filter.h
+//   Copyright (C) 2025-2025 Genozip Limited. Patent pending.
+//   Please see terms and conditions in the file LICENSE.txt
+//
+//   WARNING: Genozip is proprietary, not open source software. Modifying the source code is strictly prohibited
+//   and subject to penalties specified in the license.
+
+#pragma once
+
+#include "genozip.h"
+
+// genocat --filter: an expression over the fields of a line, eg "FILTER==PASS && INFO/AF>0.01" or "MAPQ>=30 && !(FLAG&0x400)"
+extern void expr_filter_compile (rom expr);
+extern void expr_filter_init_toplevel (VBlockP vb, ConstContainerP con);
+extern void expr_filter_after_item (VBlockP vb, unsigned item_i);
+extern bool expr_filter_does_line_survive (VBlockP vb);
+extern bool expr_filter_prepare_pushdown (void);
+extern bool expr_filter_is_vb_included (VBIType vb_i);
@@ -406,6 +406,84 @@ void fastq_zip_init_vb (VBlockP vb)
     }
 }
 
+//-------------------------------------------------------------------------------------------
+// ZIP: R1 cache - the R1 sections needed by R2 VBs, kept in memory so R2 needn't read them back
+//-------------------------------------------------------------------------------------------
+
+#define R1_CACHE_MAX_SIZE (512 MB) // R1 VBs that don't fit are not cached, and their sections are read back from disk
+
+typedef struct { 
+    DictId dict_id; 
+    uint64_t start;                // start of section in z_file->R1_cache
+    uint32_t len;                  // length of section, including its header
+    VBIType vb_i; 
+    SectionType st; 
+} R1CacheEnt;
+
+static inline bool fastq_zip_is_R1_section_needed_by_R2 (Section sec)
+{
+    return (sec->st == SEC_B250 || sec->st == SEC_LOCAL) &&
+           (fastq_zip_use_pair_assisted (sec->dict_id, sec->st) || fastq_zip_use_pair_identical (sec->dict_id));
+}
+
+// main thread: called for R1 VBs, possibly out of order, after z_data is final and before it is written
+static void fastq_zip_cache_R1_sections (VBlockP vb)
+{
+    ARRAY (SectionEnt, sec, vb->section_list); // note: offsets are still relative to vb->z_data 
+    
+    uint64_t add_len = 0;
+    uint32_t add_ents = 0;
+    for (uint32_t i=0; i < sec_len; i++) 
+        if (fastq_zip_is_R1_section_needed_by_R2 (&sec[i])) {
+            add_len += (i < sec_len-1 ? sec[i+1].offset : vb->z_data.len) - sec[i].offset;
+            add_ents++;
+        }
+
+    // note: R2 consumes R1 VBs in order, so rather than evicting older VBs (which are needed first), we skip a VB that doesn't 
+    // fit in the remaining space. A later, smaller VB may still be admitted.
+    if (!add_len || z_file->R1_cache.len + add_len > R1_CACHE_MAX_SIZE) return; 
+
+    uint32_t vb_index = vb->vblock_i - z_file->R1_first_vb_i;
+    buf_alloc_zero (evb, &z_file->R1_cache_index, 0, vb_index + 1, uint32_t, CTX_GROWTH, "z_file->R1_cache_index");
+    z_file->R1_cache_index.len32 = MAX_(z_file->R1_cache_index.len32, vb_index + 1);
+    *B32(z_file->R1_cache_index, vb_index) = z_file->R1_cache_ents.len32 + 1;
+
+    buf_alloc (evb, &z_file->R1_cache, add_len, 0, char, CTX_GROWTH, "z_file->R1_cache");
+    buf_alloc (evb, &z_file->R1_cache_ents, add_ents, 0, R1CacheEnt, CTX_GROWTH, "z_file->R1_cache_ents");
+
+    for (uint32_t i=0; i < sec_len; i++) 
+        if (fastq_zip_is_R1_section_needed_by_R2 (&sec[i])) {
+            uint32_t len = (i < sec_len-1 ? sec[i+1].offset : vb->z_data.len) - sec[i].offset;
+
+            BNXT (R1CacheEnt, z_file->R1_cache_ents) = (R1CacheEnt){ .dict_id = sec[i].dict_id, .start = z_file->R1_cache.len, 
+                                                                     .len = len, .vb_i = vb->vblock_i, .st = sec[i].st };
+            buf_add (&z_file->R1_cache, Bc(vb->z_data, sec[i].offset), len);
+        }
+}
+
+// main thread: ZIP of R2: returns an R1 section, exactly as written to z_file (i.e. including header, possibly encrypted), or NULL if not cached
+rom fastq_zip_get_cached_R1_section (Section sec, uint32_t *len)
+{
+    uint32_t vb_index = sec->vblock_i - z_file->R1_first_vb_i; // note: wraps around if sec->vblock_i is not an R1 VB
+    if (vb_index >= z_file->R1_cache_index.len32 || !*B32(z_file->R1_cache_index, vb_index)) return NULL;
+
+    for (R1CacheEnt *ent = B(R1CacheEnt, z_file->R1_cache_ents, *B32(z_file->R1_cache_index, vb_index) - 1); 
+         ent < BAFT(R1CacheEnt, z_file->R1_cache_ents) && ent->vb_i == sec->vblock_i; ent++)
+        
+        if (ent->st == sec->st && ent->dict_id.num == sec->dict_id.num) {
+            *len = ent->len;
+            return Bc(z_file->R1_cache, ent->start);
+        }
+
+    return NULL;
+}
+
+static bool fastq_zip_is_R1_vb_cached (VBIType R1_vb_i)
+{
+    uint32_t vb_index = R1_vb_i - z_file->R1_first_vb_i;
+    return IS_ZIP && vb_index < z_file->R1_cache_index.len32 && *B32(z_file->R1_cache_index, vb_index);
+}
+
 // called by main thread, as VBs complete (might be out-of-order)
 void fastq_zip_after_compute (VBlockP vb)
 {
@@ -437,6 +515,8 @@ void fastq_zip_after_compute (VBlockP vb)
 
         if (flag_show_bgzf)
             iprintf ("R1_LAST_QNAME vb=%-7s qname=\"%.*s\" num_lines=%u\n", VB_NAME, STRf(qname), vb->lines.len32);
+
+        fastq_zip_cache_R1_sections (vb);
     }
 }
 
@@ -527,6 +607,12 @@ void fastq_zip_finalize (bool is_last_user_txt_file)
     if (flag.pair != PAIR_R1 && flag.bam_assist)
         fastq_bamass_zip_finalize (is_last_user_txt_file);
 
+    if (flag.pair == PAIR_R2) {
+        buf_destroy (z_file->R1_cache);
+        buf_destroy (z_file->R1_cache_ents);
+        buf_destroy (z_file->R1_cache_index);
+    }
+
     if (!flag.let_OS_cleanup_on_exit && flag.pair != PAIR_R1 && !flag.deep) {
         if (IS_REF_EXT_STORE)
             ref_destroy_reference();
@@ -880,7 +966,9 @@ void fastq_read_R1_data (VBlockP vb_, VBIType R1_vb_i)
     START_TIMER;
     VBlockFASTQP vb = (VBlockFASTQP)vb_;
 
-    if (flag.no_zriter) zriter_flush(); 
+    bool is_cached = fastq_zip_is_R1_vb_cached (R1_vb_i); // ZIP: R1 sections are read from memory rather than from disk
+
+    if (flag.no_zriter && !is_cached) zriter_flush(); 
 
     Section sec = sections_vb_header (R1_vb_i);
 
@@ -892,7 +980,7 @@ void fastq_read_R1_data (VBlockP vb_, VBIType R1_vb_i)
         
     piz_read_all_ctxs (VB, &sec, true);
     
-    if (flag.no_zriter) 
+    if (flag.no_zriter && !is_cached) 
         file_seek (z_file, 0, SEEK_END, READ, HARD_FAIL); // restore
 
     COPY_TIMER (fastq_read_R1_data);
@@ -1301,7 +1389,7 @@ IS_SKIP (fastq_piz_is_skip_section)
         return true;
 
     // note: we don't SKIP for --count with an additional filter. Logic is too complicated and bug-prone.
-    if (flag.count && !flag.grep && IS_DICTED_SEC (st) && !flag.bases && !flag.regions && 
+    if (flag.count && !flag.grep && !flag.filter && IS_DICTED_SEC (st) && !flag.bases && !flag.regions && 
         dict_id.num != _FASTQ_TOPLEVEL) 
         return true;
 
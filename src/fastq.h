@@ -113,6 +113,7 @@ extern void fastq_zip_after_compress (VBlockP vb);
 extern void fastq_zip_after_compute (VBlockP vb);
 extern bool fastq_zip_use_pair_assisted (DictId dict_id, SectionType st);
 extern bool fastq_zip_use_pair_identical (DictId dict_id);
+extern rom fastq_zip_get_cached_R1_section (Section sec, uint32_t *len);
 extern uint32_t fastq_zip_get_seq_len (VBlockP vb, uint32_t line_i) ;
 extern uint32_t fastq_get_num_deeped (VBlockP vb);
 
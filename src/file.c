@@ -29,6 +29,7 @@
 #include "writer.h"
 #include "filename.h"
 #include "huffman.h"
+#include "zip_resume.h"
 
 // globals
 FileP z_file   = NULL;
@@ -686,6 +687,9 @@ static void file_initialize_z_file_data (FileP file)
     if (flag_no_biopsy_line) // no need to initialize in --biopsy-line (as destroying it later will error)
         serializer_initialize (file->digest_serializer); 
 
+    if (IS_ZIP && flag.resumable)
+        serializer_initialize (file->merge_serializer);
+
     clock_gettime (CLOCK_REALTIME, &file->start_time);
 }
 
@@ -839,6 +843,7 @@ FileP file_open_z_write (rom filename, FileMode mode, DataType data_type, Codec
     
     if (file_exists (filename) && 
         !flag.force            && 
+        !flag.resume           && // --resume continues the existing file
         !flag.zip_no_z_file    && // not zip with --seg-only
         !file->is_in_tar)   
 
@@ -866,7 +871,7 @@ FileP file_open_z_write (rom filename, FileMode mode, DataType data_type, Codec
     
     if (!flag.zip_no_z_file) {
 
-        if (flag.force && !file->is_in_tar) 
+        if (flag.force && !flag.resume && !file->is_in_tar) 
             unlink (file->name); // delete file if it already exists (needed in weird cases, eg symlink to non-existing file)
 
         // if we're writing to a tar file, we get the already-openned tar file
@@ -875,7 +880,7 @@ FileP file_open_z_write (rom filename, FileMode mode, DataType data_type, Codec
             // note: tar doesn't have a z_reread_file bc --pair and --deep are not yet supported with --tar
 
         else {
-            file->file = fopen (file->name, file->mode);
+            file->file = fopen (file->name, flag.resume ? "r+b" : file->mode); // --resume: update the partial file in place
             
             if (!flag.no_zriter) 
                 file->z_reread_file = fopen (file->name, READ);
@@ -902,6 +907,9 @@ FileP file_open_z_write (rom filename, FileMode mode, DataType data_type, Codec
     ASSINP (file->file || flag.zip_no_z_file, 
             "cannot open file \"%s\": %s", file->name, strerror(errno)); // errno will be retrieve even the open() was called through zlib and bzlib 
 
+    if (flag.resume) 
+        zip_resume_open_z_file (file); // truncate to the last checkpoint and restore its section list
+
     COPY_TIMER_EVB (file_open_z);
     return file;
 }
@@ -919,15 +927,24 @@ static void file_index_txt (ConstFileP file)
         case DT_SAM:
         case DT_BAM: 
             RETURNW (file->effective_codec == CODEC_BGZF,, "%s: output file needs to be a .sam.gz or .bam to be indexed", global_cmd); 
+            if (file->index_written) return; // BAM index already created while writing (see txt_index.c)
             indexing = stream_create (0, 0, 0, 0, 0, 0, 0, "to create an index", "samtools", "index", file->name, NULL); 
             break;
             
         case DT_VCF: 
             RETURNW (file->effective_codec == CODEC_BGZF,, "%s: output file needs to be a .vcf.gz or .bcf to be indexed", global_cmd); 
             RETURNW (vcf_header_get_has_fileformat(),, "%s: file needs to start with ##fileformat=VCF be indexed", global_cmd); 
+            if (file->index_written) return; // tabix index already created while writing (see txt_index.c)
             indexing = stream_create (0, 0, 0, 0, 0, 0, 0, "to create an index", "bcftools", "index", file->name, NULL); 
             break;
 
+        case DT_GFF:
+        case DT_BED:
+            RETURNW (file->effective_codec == CODEC_BGZF,, "%s: output file needs to be a .%s.gz to be indexed", global_cmd, file->data_type == DT_GFF ? "gff" : "bed"); 
+            if (file->index_written) return; // tabix index already created while writing (see txt_index.c)
+            indexing = stream_create (0, 0, 0, 0, 0, 0, 0, "to create an index", "tabix", "-p", file->data_type == DT_GFF ? "gff" : "bed", file->name, NULL); 
+            break;
+
         case DT_FASTQ:
         case DT_FASTA:
             RETURNW (file->effective_codec == CODEC_BGZF || file->effective_codec == CODEC_NONE,, 
@@ -1001,6 +1018,7 @@ void file_close (FileP *file_p)
             FCLOSE (file->z_reread_file, file_printname (file));
         }
         serializer_destroy (file->digest_serializer);  
+        serializer_destroy (file->merge_serializer);  
     }
 
     // free resources if we are NOT near the end of the execution. If we are at the end of the execution
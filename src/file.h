@@ -78,6 +78,7 @@ typedef struct File {
 
     // Digest stuff - stored in z_file (ZIP & PIZ)
     Serializer digest_serializer;      // ZIP/PIZ: used for serializing VBs so they are MD5ed in order (not used for Adler32)
+    Serializer merge_serializer;       // ZIP: with --resumable, used for serializing merges, so that dictionaries can be re-created by --resume
     DigestContext digest_ctx;          // ZIP/PIZ: Z_FILE: digest context of txt file being compressed / reconstructed (used for MD5 and, in v9-13, for Adler32, starting v15 also for make-reference)
     DigestContext v13_commulative_digest_ctx; // PIZ: z_file: used for multi-component up-to-v13 files - VB digests (adler and md5) are commulative since the beginning of the data, while txt file digest are commulative only with in the component.
     Digest digest;                     // ZIP: Z_FILE: digest of txt data read from input file (make-ref since v15: digest of in-memory genome)  PIZ: z_file: as read from TxtHeader section (used for MD5 and, in v9-13, for Adler32)
@@ -129,6 +130,8 @@ typedef struct File {
     DictIdtoDidMap d2d_map; // map for quick look up of did_i from dict_id : 64K for key_map, 64K for alt_map 
     ContextArray contexts;             // Z_FILE ZIP/PIZ: a merge of dictionaries of all VBs
     Buffer ra_buf;                     // ZIP/PIZ:  RAEntry records
+    Buffer ra_lines_buf;               // ZIP/PIZ:  RALinesEntry records (--sub-vb-index)
+    Buffer agg_buf;                    // ZIP/PIZ:  AggEntry records (--aggregates)
     
     // section list - used for READING and WRITING genozip files
     Buffer section_list;               // Z_FILE ZIP/PIZ section list (payload of the GenozipHeader section)
@@ -156,6 +159,8 @@ typedef struct File {
     uint8_t num_bgzf_blocks_tested_for_level; // ZIP: number of bgzf blocks tested for discovering level
     struct FlagsMgzip mgzip_flags;     // corresponds to SectionHeader.flags in SEC_MGZIP
     uint8_t bgzf_signature[3];         // PIZ: 3 LSB of size of source BGZF-compressed file, as passed in SectionHeaderTxtHeader.codec_info
+    bool index_written;                // PIZ: an index was created while writing the file (BAM with --index)
+    uint8_t index_type;                // PIZ: --index: IndexType (see txt_index.c) of the index to be created while writing the file
     bool non_EOF_zero_block_found;     // ZIP: file contains an isize=0 block that is not identical to the EOF block, therefore we won't be able to reconstruct exactly
      
     // TXT_FILE: accounting for truncation when --truncate-partial-last-line is used
@@ -210,6 +215,9 @@ typedef struct File {
     Buffer R1_txt_data_lens;           // Z_FILE: ZIP: FASTQ GZ: info regarding R1 VBs: txt_data.len32 of each VB 
     Buffer R1_last_qname_index;        // Z_FILE: ZIP: FASTQ GZ: info regarding R1 VBs: last qname of each VB, canonical form, nul-separated: index into R1_last_qname. Note: only accessible in main thread (bc may realloc)
     Buffer R1_last_qname;              // Z_FILE: ZIP: FASTQ GZ: data of R1_last_qname
+    Buffer R1_cache;                   // Z_FILE: ZIP: FASTQ --pair: in-memory copy of the R1 sections needed by R2 (pair-assisted and pair-identical), saving R2 a read-back from disk
+    Buffer R1_cache_ents;              // Z_FILE: ZIP: FASTQ --pair: an R1CacheEnt for each section in R1_cache. Entries of each VB are consecutive.
+    Buffer R1_cache_index;             // Z_FILE: ZIP: FASTQ --pair: for each R1 VB: 1 + index of its first entry in R1_cache_ents, or 0 if not cached
     VBIType R1_first_vb_i;             // Z_FILE: ZIP: first vb_i of R1. Always 1 for --pair, more for --deep.
 
     // Information content stats 
@@ -21,6 +21,7 @@
 #include "stream.h"
 #include "mgzip.h"
 #include "bases_filter.h"
+#include "expr_filter.h"
 #include "license.h"
 #include "tar.h"
 #include "biopsy.h"
@@ -28,6 +29,9 @@
 #include "arch.h"
 #include "user_message.h"
 #include "codec.h"
+#include "acgt.h"
+#include "digest.h"
+#include "shard.h"
 
 // flags - factory default values (all others are 0)
 Flags flag = { 
@@ -379,8 +383,12 @@ void flags_zip_set_input_type (rom type_str)
     }
 }
 
+static Flags default_flags; // flags as set before processing the command line
+
 void flags_init_from_command_line (int argc, char **argv)
 {
+    default_flags = flag;
+
     // process command line options
     while (1) {
         #define PADDED(f) (int *)&flag.f
@@ -399,7 +407,10 @@ void flags_init_from_command_line (int argc, char **argv)
         #define _DL {"replace",          no_argument,       &flag.replace,          1 }
         #define _nb {"no-bgzf",          no_argument,       &flag.no_bgzf,          1 }
         #define _nz {"no-zriter",        no_argument,       &flag.no_zriter,        1 }
+        #define _Rs {"resumable",        no_argument,       &flag.resumable,        1 }
+        #define _Rm {"resume",           no_argument,       &flag.resume,           1 }
         #define _nc {"no-cache",         no_argument,       &flag.no_cache,         1 }
+        #define _ri {"ref-image",        no_argument,       &flag.ref_image,        1 }
         #define _nu {"no-upgrade",       no_argument,       &flag.no_upgrade,       1 }
         #define _hc {"hold-cache",       required_argument, 0, 145                    } // undocumented
         #define _V  {"version",          no_argument,       &command,         VERSION }
@@ -425,6 +436,15 @@ void flags_init_from_command_line (int argc, char **argv)
         #define _Nt {"no-test",          no_argument,       &flag.no_test,          1 }
         #define _fa {"fast",             no_argument,       &flag.fast,             1 }
         #define _bs {"best",             no_argument,       &flag.best,             1 }
+        #define _cP {"codec-profile",    required_argument, 0, 138                    }
+        #define _sK {"sample-blocks",    optional_argument, 0, 161                    }
+        #define _aG {"aggregates",       no_argument,       &flag.aggregates,       1 }
+        #define _dT {"dict-template",    required_argument, 0, 163                    }
+        #define _Pr {"progressive",      no_argument,       &flag.progressive,      1 }
+        #define _SB {"shard-by",         required_argument, 0, 164                    }
+        #define _OP {"output-pattern",   required_argument, 0, 165                    }
+        #define _SO {"sort",             no_argument,       &flag.sort,             1 }
+        #define _SM {"sort-memory",      required_argument, 0, 166                    }
         #define _lm {"low-memory",       no_argument,       &flag.low_memory,       1 }
         #define _al {"add-line-numbers", no_argument,       &flag.add_line_numbers, 1 }
         #define _as {"add-seq",          no_argument,       &flag.add_seq,          1 }
@@ -449,6 +469,10 @@ void flags_init_from_command_line (int argc, char **argv)
         #define _Qf {"qnames",           required_argument, 0, 149                    }
         #define _QF {"qname",            required_argument, 0, 149                    }
         #define _SF {"seqs-file",        required_argument, 0, 147                    }
+        #define _Ar {"arrow",            required_argument, 0, 156                    }
+        #define _Sv {"server",           required_argument, 0, 157                    }
+        #define _cF {"concurrent-files", required_argument, 0, 158                    }
+        #define _sV {"sub-vb-index",     required_argument, 0, 159                    }
         #define _Rg {"gpos",             no_argument,       &flag.gpos,             1 }
         #define _s  {"samples",          required_argument, 0, 's'                    }
         #define _sf {"FLAG",             required_argument, 0, 17                     }
@@ -462,6 +486,7 @@ void flags_init_from_command_line (int argc, char **argv)
         #define _x  {"index",            no_argument,       &flag.index_txt,        1 }
         #define _D  {"subdirs"  ,        no_argument,       &flag.subdirs,          1 }
         #define _g  {"grep",             required_argument, 0, 25                     }
+        #define _FX {"filter",           required_argument, 0, 162                    }
         #define _gw {"grep-w",           required_argument, 0, 'g'                    }
         #define _n  {"lines",            required_argument, 0, 'n'                    }
         #define _nh {"head",             required_argument, 0, 22                     } // genozip
@@ -573,6 +598,7 @@ void flags_init_from_command_line (int argc, char **argv)
         #define _dG {"debug-gencomp",    no_argument,       &flag.debug_gencomp,    1 }  
         #define _dN {"no-gencomp",       no_argument,       &flag.no_gencomp,       1 }  
         #define _dF {"force-gencomp",    no_argument,       &flag.force_gencomp,    1 }  
+        #define _sg {"sag-single-pass",  no_argument,       &flag.sag_single_pass,  1 }  
         #define _RR {"force-reread" ,    no_argument,       &flag.force_reread,     1 }  
         #define _DF {"force-deep",       no_argument,       &flag.force_deep,       1 }  
         #define _fP {"force-PLy",        no_argument,       &flag.force_PLy,        1 }  
@@ -609,6 +635,7 @@ void flags_init_from_command_line (int argc, char **argv)
         #define _Dh {"debug-huffman",    required_argument, 0, 155                    }
         #define _Hh {"show-huffman",     required_argument, 0, 131                    }
         #define _sp {"debug-split",      no_argument,       &flag.debug_split,      1 }
+        #define _dY {"debug-resume",     no_argument,       &flag.debug_resume,     1 }
         #define _Du {"debug-upgrade",    no_argument,       &flag.debug_upgrade,    1 }
         #define _De {"debug-expiration", no_argument,       &flag.debug_expiration, 1 }
         #define _np {"show-snips",       no_argument,       &flag.show_snips,       1 }
@@ -624,11 +651,18 @@ void flags_init_from_command_line (int argc, char **argv)
         #define _lp {"license-prepare",  required_argument, 0, 148,                   }
         #define _00 {0, 0, 0, 0                                                       }
         #define _gg {"generate-il1m",    no_argument,       0, 153                    }
+#ifdef DEBUG // developer builds only (use "make opt" for meaningful timings). Note: _bA includes its comma
+        #define _bA {"bench-acgt",       no_argument,       0, 160                    },
+        #define _bC {"bench-checksum",   no_argument,       0, 167                    },
+#else
+        #define _bA
+        #define _bC
+#endif
 
         typedef const struct option Option;
-        static Option genozip_lo[]   = { _lg, _i, _I, _d, _f, _h, _x, _D,    _L1, _L2, _q, _Q, _qq, _t, _Nt, _DL, _nb, _nz, _nc,_nu,  _V, _z,                                                                       _m, _th,     _o, _p, _e, _E,                                                                       _H1,                                         _sL, _ss, _SS,      _sd, _sT,      _sN, _sb, _Sb, _lc, _lh, _lH, _s2, _s7, _S7, _S0, _S8, _S9, _sa, _st, _sm, _sh, _si, _Si, _Sh, _sr,      _su, _so, _gz, _sv, _sn, _pn, _ai,                    _B, _xt, _dm, _dp, _dL, _dD, _dq, _dB, _dt, _dw, _dM, _dr, _dR, _dP, _dG, _dN, _dF, _RR, _DF, _dQ, _dH, _Hh, _dO, _dC, _fQ, _fC, _fO, _fS, _fH, _fN, _dU, _dl, _dc, _dg,      _dh,_dS, _bS, _9, _88, _pe, _Np, _fa, _bs, _lm,                        _nh, _rg, _rG,                          _hC, _rA,           _rS, _me, _s5, _S5, _sM, _sA, _sB, _sP, _sc, _Sc, _AL, _sI, _cn,                                    _s6,          _oe, _al, _as, _Lf, _dd, _T, _TT, _TL, _wM, _wm, _WM, _WB, _bi, _bl, _sk, _VV, _DV,      _Dh, _Ds, _DS, _sp, _Du, _De, _DD, _DP, _BA, _SH, _Dd, _ba,      _to, _ts,      _hc, _dv, _TR, _NE, _lp, _Sd, _St, _um,      _fP, _nF, _nI, _gg, _00 };
-        static Option genounzip_lo[] = { _lg,         _d, _f, _h, _x, _D,    _L1, _L2, _q, _Q,      _t,      _DL,           _nc,      _V, _z,                                                                       _m, _th, _u, _o, _p, _e,                                                                                                                        _sL, _ss, _SS, _sG, _sd, _sT, _sS,      _sb,      _lc, _lh, _lH, _s2, _s7, _S7, _S0, _S8, _S9, _sa, _st, _sm, _sh, _si, _Si, _Sh, _sr, _SR, _su,           _sv, _sn, _pn,      _ov,                   _xt, _dm, _dp,      _dD,      _dB, _dt,                _dR,                                         _Hh,                                                   _dc,                                                      _lm,                                       _sR, _pR,                _hC, _rA,           _rS, _me, _s5, _S5, _sM, _sA, _sB,           _Sc, _AL, _sI, _cn, _cN,                               _s6,          _oe,                _dd, _T, _TT,                                                   _Dp,                _sp,           _DD,                _Dd, _ba,      _to, _ts, _RC,      _dv, _TR, _NE,                     _np,                     _00 };
-        static Option genocat_lo[]   = { _lg,         _d, _f, _h,     _D,    _L1, _L2, _q, _Q,                              _nc,      _V, _z, _zr, _zR, _zb, _zB, _zs, _zS, _zq, _zQ, _zf, _zF, _zc, _zC, _zv, _zV,     _th,     _o, _p, _e,     _il, _r, _R, _Rg, _qf, _qF, _Qf, _QF, _SF, _s, _sf, _sq, _G, _1, _H0, _H1, _H2, _H3, _Gt, _So, _Io, _IU, _iu, _GT, _sL, _ss, _SS, _sG, _sd, _sT, _sS,      _sb,      _lc, _lh, _lH, _s2, _s7, _S7, _S0, _S8, _S9, _sa, _st, _sm, _sh, _si, _Si, _Sh, _sr, _SR, _su,           _sv, _sn, _pn,      _ov, _R1, _R2, _RX,    _xt, _dm, _dp,      _dD,      _dB, _dt,                _dR,                                         _Hh,                                                   _dc,      _ds,                                            _lm, _fs, _g, _gw, _n, _nt, _nH,           _sR, _pR,      _sC, _pC, _hC, _rA, _rI, _pI, _rS, _me, _s5, _S5, _sM, _sA, _sB,           _Sc, _AL, _sI, _cn, _cN, _pg, _PG, _SX, _ix, _ct, _vl, _s6,          _oe, _al,           _dd, _T,                                                        _Dp,                _sp,           _DD,                _Dd, _ba, _DT,           _RC,      _dv, _TR, _NE,                     _np,                     _00 };
+        static Option genozip_lo[]   = { _lg, _i, _I, _d, _f, _h, _x, _D,    _L1, _L2, _q, _Q, _qq, _t, _Nt, _DL, _nb, _nz, _Rs, _Rm, _nc, _ri,_nu,  _V, _z,                                                                       _m, _th,     _o, _p, _e, _E,                                                                       _H1,                                         _sL, _ss, _SS,      _sd, _sT,      _sN, _sb, _Sb, _lc, _lh, _lH, _s2, _s7, _S7, _S0, _S8, _S9, _sa, _st, _sm, _sh, _si, _Si, _Sh, _sr,      _su, _so, _gz, _sv, _sn, _pn, _ai,                    _B, _xt, _dm, _dp, _dL, _dD, _dq, _dB, _dt, _dw, _dM, _dr, _dR, _dP, _dG, _dN, _dF, _sg, _RR, _DF, _dQ, _dH, _Hh, _dO, _dC, _fQ, _fC, _fO, _fS, _fH, _fN, _dU, _dl, _dc, _dg,      _dh,_dS, _bS, _9, _88, _pe, _Np, _fa, _bs, _cP, _sK, _aG, _dT, _lm,                   _nh, _rg, _rG,                          _hC, _rA,           _rS, _me, _s5, _S5, _sM, _sA, _sB, _sP, _sc, _Sc, _AL, _sI, _cn,                                    _s6,          _oe, _al, _as, _Lf, _dd, _T, _TT, _TL, _wM, _wm, _WM, _WB, _bi, _bl, _sk, _VV, _DV,      _Dh, _Ds, _DS, _sp, _Du, _De, _DD, _DP, _BA, _SH, _Dd, _ba,      _to, _ts,      _hc, _dv, _TR, _NE, _lp, _Sd, _St, _um,      _fP, _nF, _nI, _gg, _bA  _bC  _Sv, _cF, _sV, _dY, _00 };
+        static Option genounzip_lo[] = { _lg,         _d, _f, _h, _x, _D,    _L1, _L2, _q, _Q,      _t,      _DL,           _nc, _ri,      _V, _z,                                                                       _m, _th, _u, _o, _p, _e,                                                                                                                        _sL, _ss, _SS, _sG, _sd, _sT, _sS,      _sb,      _lc, _lh, _lH, _s2, _s7, _S7, _S0, _S8, _S9, _sa, _st, _sm, _sh, _si, _Si, _Sh, _sr, _SR, _su,           _sv, _sn, _pn,      _ov,                   _xt, _dm, _dp,      _dD,      _dB, _dt,                _dR,                                         _Hh,                                                   _dc,                                                      _lm,                                       _sR, _pR,                _hC, _rA,           _rS, _me, _s5, _S5, _sM, _sA, _sB,           _Sc, _AL, _sI, _cn, _cN,                               _s6,          _oe,                _dd, _T, _TT,                                                   _Dp,                _sp,           _DD,                _Dd, _ba,      _to, _ts, _RC,      _dv, _TR, _NE,                     _np,                     _dT, _Pr, _00 };
+        static Option genocat_lo[]   = { _lg,         _d, _f, _h,     _D,    _L1, _L2, _q, _Q,                              _nc, _ri,      _V, _z, _zr, _zR, _zb, _zB, _zs, _zS, _zq, _zQ, _zf, _zF, _zc, _zC, _zv, _zV,     _th,     _o, _p, _e,     _il, _r, _R, _Rg, _qf, _qF, _Qf, _QF, _SF, _s, _sf, _sq, _G, _1, _H0, _H1, _H2, _H3, _Gt, _So, _Io, _IU, _iu, _GT, _sL, _ss, _SS, _sG, _sd, _sT, _sS,      _sb,      _lc, _lh, _lH, _s2, _s7, _S7, _S0, _S8, _S9, _sa, _st, _sm, _sh, _si, _Si, _Sh, _sr, _SR, _su,           _sv, _sn, _pn,      _ov, _R1, _R2, _RX,    _xt, _dm, _dp,      _dD,      _dB, _dt,                _dR,                                         _Hh,                                                   _dc,      _ds,                                            _lm, _fs, _g, _gw, _FX, _n, _nt, _nH,           _sR, _pR,      _sC, _pC, _hC, _rA, _rI, _pI, _rS, _me, _s5, _S5, _sM, _sA, _sB,           _Sc, _AL, _sI, _cn, _cN, _pg, _PG, _SX, _ix, _ct, _vl, _s6, _Ar,     _oe, _al,           _dd, _T,                                                        _Dp,                _sp,           _DD,                _Dd, _ba, _DT,           _RC,      _dv, _TR, _NE,                     _np,                     _dT, _Pr, _SB, _OP, _SO, _SM, _00 };
         static Option genols_lo[]    = { _lg,             _f, _h,        _l, _L1, _L2, _q,                                            _V,                                                                                            _p,                                                                                                                                                                                                                                _st, _sm,                                                                                              _dm,                          _dt,                                                                                                                                                                                                                                                                                          _sM,                                                                                 _b, _LC, _oe,                _dd, _T,                                                                            _sp,           _DD,                                                   _dv,      _NE,                                              _00 };
         static Option *long_options[NUM_EXE_TYPES] = { genozip_lo, genounzip_lo, genocat_lo, genols_lo }; // same order as ExeType
 
@@ -679,6 +713,7 @@ verify_command:
             case 'F' : flag.fast          = 1       ; break;
             case 'g' : flag.grepw = true; // fall-through
             case 25  : flags_set_grep (optarg)      ; break;
+            case 162 : expr_filter_compile (optarg) ; break;
             case 'G' : flag.drop_genotypes= 1       ; break;
             case 'H' : flag.no_header     = 1       ; break;
             case 'i' : flags_zip_set_input_type (optarg) ; break;
@@ -746,13 +781,24 @@ verify_command:
             case 135 : flag.show_gheader = optarg ? atoi(optarg) : 1; break; // =1 show gheader as in file, =2 show shows section list after possible modiciation by writer_create_plan 
             case 136 : flag.show_sag = optarg ? atoi(optarg)+1 : -1; break;   //-1=show all, >=1 - show grp_i=show_sag-1 
             case 137 : flag_set_biopsy_line (optarg); break;
-            case 138 : /* 138 is not currently used - available */; break;
+            case 138 : flag.codec_profile = optarg; break;
+            case 163 : flag.dict_template = optarg; break;
+            case 164 : shard_set_shard_by (optarg); break;
+            case 165 : shard_set_output_pattern (optarg); break;
+            case 166 : ASSINP (str_get_int_range64 (optarg, 0, 64, 1000000000, (int64_t *)&flag.sort_memory),
+                                "--sort-memory: bad value \"%s\", expecting a number of MB from 64 to 1000000000", optarg); break;
             case 139 : flag_set_show_deep (optarg)  ; break;
             case 141 : flag.show_vblocks = (optarg ? optarg : "") ; break;
             case 142 : flag.t_offset = atoll (optarg); break;
             case 143 : flag.t_size   = atoll (optarg); break;
             case 144 : flag.qnames_file = optarg; break;
             case 149 : flag.qnames_opt = optarg; break;
+            case 156 : flag.arrow = optarg; break;
+            case 157 : flag.server = optarg; break;
+            case 158 : ASSINP (str_get_int_range32 (optarg, 0, 1, 256, (int32_t *)&flag.concurrent_files),
+                                "--concurrent-files: bad value \"%s\", expecting an integer from 1 to 256", optarg); break;
+            case 159 : ASSINP (str_get_int_range32 (optarg, 0, 16, 1000000, (int32_t *)&flag.sub_vb_index),
+                                "--sub-vb-index: bad value \"%s\", expecting a number of lines from 16 to 1000000", optarg); break;
             case 147 : seq_filter_initialize (optarg); break;
             case 145 : ref_cache_hold (optarg); // doesn't return
             case 146 : flag.one_component = atoi (optarg); break;
@@ -760,6 +806,14 @@ verify_command:
             case 151 : ASSINP (str_get_int_range64 (optarg, strlen (optarg), 1, 0xffffffff, &flag.sendto), "Expecting the value of --sendto=%s to a number", optarg); break;
             case 152 : user_message_init (optarg); break;
             case 153 : il1m_compress(); // doesn't return
+#ifdef DEBUG
+            case 160 : acgt_benchmark(); // doesn't return
+            case 167 : digest_benchmark(); // doesn't return
+#endif
+            case 161 : if (!optarg) flag.sample_blocks = 256; // default block size
+                       else ASSINP (str_get_int_range32 (optarg, 0, 1, CONTAINER_MAX_REPEATS, (int32_t *)&flag.sample_blocks),
+                                    "--sample-blocks=%s: expecting the number of samples per block, a value between 1 and %u", optarg, CONTAINER_MAX_REPEATS);
+                       break;
             case 154 : flag_set_deep (optarg); break; 
             case 0   : break; // a long option that doesn't have short version will land here - already handled so nothing to do
                  
@@ -829,6 +883,7 @@ static void flags_test_conflicts (unsigned num_files /* optional */)
         CONFLICT (flag.reference,   flag.make_reference,    "--make-reference", OT("reference", "e"));
         CONFLICT (flag.index_txt,   flag.make_reference,    "--make-reference", OT("index", "x"));
         CONFLICT (flag.no_gencomp,  flag.force_gencomp,     "--no-gencomp",     "--force-gencomp");
+        CONFLICT (flag.no_gencomp,  flag.sag_single_pass,   "--no-gencomp",     "--sag-single-pass");
         CONFLICT (flag.biopsy,      flag.out_filename,      "--biopsy",         OT("output", "o"));
         CONFLICT (flag_has_biopsy_line, flag.out_filename,  "--biopsy-line",    OT("output", "o"));
         CONFLICT (flag_has_head,    flag.force_gencomp,     "--head",           "--force-gencomp");
@@ -848,6 +903,24 @@ static void flags_test_conflicts (unsigned num_files /* optional */)
         CONFLICT (flag.pair,        tar_zip_is_tar(),       OT("pair", "2"),    "--tar");
         CONFLICT (flag.pair,        flag.show_gz,           OT("pair", "2"),    "--show-gz");
         CONFLICT (flag.show_gz,     tar_zip_is_tar(),       "--show-gz",        "--tar");
+        CONFLICT (flag.concurrent_files > 1, tar_zip_is_tar(), "--concurrent-files", "--tar");
+        CONFLICT (flag.concurrent_files > 1, flag.pair,     "--concurrent-files", OT("pair", "2"));
+        CONFLICT (flag.concurrent_files > 1, flag.deep,     "--concurrent-files", OT("deep", "3"));
+        CONFLICT (flag.concurrent_files > 1, flag.bam_assist, "--concurrent-files", OT("bamass", "A"));
+        CONFLICT (flag.concurrent_files > 1, flag.out_filename, "--concurrent-files", OT("output", "o"));
+        CONFLICT (flag.concurrent_files > 1, flag.biopsy,   "--concurrent-files", "--biopsy");
+        CONFLICT (flag.resumable,   flag.pair,              "--resumable",      OT("pair", "2"));
+        CONFLICT (flag.resumable,   flag.deep,              "--resumable",      OT("deep", "3"));
+        CONFLICT (flag.resumable,   flag.bam_assist,        "--resumable",      OT("bamass", "A"));
+        CONFLICT (flag.resumable,   tar_zip_is_tar(),       "--resumable",      "--tar");
+        CONFLICT (flag.resumable,   flag.make_reference,    "--resumable",      "--make-reference");
+        CONFLICT (flag.resumable,   flag.biopsy,            "--resumable",      "--biopsy");
+        CONFLICT (flag.resumable,   flag.seg_only,          "--resumable",      "--seg-only");
+        CONFLICT (flag.resumable,   flag.force_gencomp,     "--resumable",      "--force-gencomp");
+        CONFLICT (flag.resumable,   flag.sag_single_pass,   "--resumable",      "--sag-single-pass");
+        ASSINP (!flag.resumable || num_files <= 1, "%s can only be used with a single input file", "--resumable/--resume");
+        ASSINP0 (!flag.debug_resume || flag.resumable, "--debug-resume requires --resumable");
+        ASSINP0 (flag.concurrent_files <= 1 || !flag.is_windows, "--concurrent-files is not supported on Windows");
 
         // see comment in fastq_deep_zip_finalize
         WARN_IF (flag.no_test && flag.deep, "It is not recommended to use %s in combination with --deep, as --deep relies on testing to catch rare edge cases", 
@@ -856,6 +929,21 @@ static void flags_test_conflicts (unsigned num_files /* optional */)
 
     if (IS_PIZ) {
         CONFLICT (flag.unbind,      flag.out_filename,   OT("unbind", "u"),     OT("output", "o"));
+        CONFLICT (flag.shard_by,    flag.out_filename,   "--shard-by",          OT("output", "o"));
+        CONFLICT (flag.shard_by,    flag.lines_first != NO_LINE, "--shard-by",  OT("lines", "n"));
+        CONFLICT (flag.shard_by,    flag.tail,           "--shard-by",          "--tail");
+        CONFLICT (flag.shard_by,    flag.regions,        "--shard-by",          OT("regions", "r"));
+        CONFLICT (flag.shard_by,    flag.one_vb,         "--shard-by",          "--one-vb");
+        CONFLICT (flag.shard_by,    flag.count,          "--shard-by",          "--count");
+        CONFLICT (flag.shard_by,    flag.header_only,    "--shard-by",          "--header-only");
+        ASSINP0 (!flag.shard_by == !flag.output_pattern, "--shard-by and --output-pattern must be used together");
+        ASSINP0 (!flag.shard_by || num_files <= 1, "--shard-by can only be used with a single input file");
+        ASSINP0 (!flag.shard_by || !flag.is_windows, "--shard-by is not supported on Windows");
+        CONFLICT (flag.sort,        flag.lines_first != NO_LINE, "--sort",      OT("lines", "n"));
+        CONFLICT (flag.sort,        flag.tail,           "--sort",              "--tail");
+        CONFLICT (flag.sort,        flag.interleaved,    "--sort",              "--interleaved");
+        CONFLICT (flag.sort,        flag.arrow,          "--sort",              "--arrow");
+        ASSINP0 (!flag.sort_memory || flag.sort, "--sort-memory can only be used with --sort");
         CONFLICT (flag.samples,     flag.drop_genotypes, OT("samples", "s"),    OT("drop-genotypes", "G"));
         CONFLICT (flag.one_vb,      flag.interleaved,    "--interleaved",       "--one-vb");
         CONFLICT (flag.one_component, flag.interleaved,  "--interleaved",       "--R1/--R2");
@@ -898,6 +986,19 @@ static void flags_test_conflicts (unsigned num_files /* optional */)
         CONFLICT (flag.show_stats,  flag.regions,        OT("stats", "w"),      OT("regions", "r"));
         CONFLICT (flag.show_stats,  flag.samples,        OT("stats", "w"),      OT("samples", "s"));
         CONFLICT (flag.qnames_file, flag.qnames_opt,     "--qnames",            "--qnames-file");
+        CONFLICT (flag.arrow,       flag.test,           "--arrow",             OT("test", "t"));
+        CONFLICT (flag.arrow,       flag.bgzf != BGZF_NOT_INITIALIZED, "--arrow", OT("bgzf", "z"));
+        CONFLICT (flag.arrow,       flag.count,          "--arrow",             "--count");
+        CONFLICT (flag.arrow,       flag.show_coverage,  "--arrow",             "--coverage");
+        CONFLICT (flag.arrow,       flag.idxstats,       "--arrow",             "--idxstats");
+        CONFLICT (flag.arrow,       flag.header_only,    "--arrow",             "--header-only");
+        CONFLICT (flag.arrow,       flag.explicit_head,  "--arrow",             "--head");
+        CONFLICT (flag.arrow,       flag.tail,           "--arrow",             "--tail");
+        CONFLICT (flag.arrow,       flag.lines_first != NO_LINE, "--arrow",     OT("lines", "n"));
+        CONFLICT (flag.arrow,       flag.downsample,     "--arrow",             "--downsample");
+        CONFLICT (flag.arrow,       flag.interleaved,    "--arrow",             "--interleaved");
+        CONFLICT (flag.arrow,       flag.show_stats,     "--arrow",             OT("stats", "w"));
+        ASSINP0 (!flag.arrow || num_files <= 1, "--arrow can only be used with a single input file");
         
         // options that require --reference
         if (!flag.reference) {
@@ -957,6 +1058,15 @@ void flags_zip_verify_dt_specific (DataType dt)
     FLAG_ONLY_FOR_2DTs(SAM, FASTQ, pair,    "pair");
     FLAG_ONLY_FOR_2DTs(FASTQ, FASTA, multiseq, "multiseq");
 
+    // VCF
+    FLAG_ONLY_FOR_2DTs(VCF, BCF, sample_blocks, "sample-blocks");
+
+    ASSINP0 (!flag.aggregates || dt == DT_SAM || dt == DT_BAM || dt == DT_VCF || dt == DT_BCF,
+             "--aggregates is only supported for SAM, BAM, VCF and BCF files");
+
+    ASSINP0 (!flag.dict_template || dt == DT_VCF || dt == DT_BCF || dt == DT_FASTQ,
+             "--dict-template is only supported for VCF, BCF and FASTQ files");
+
     // VCF
     FLAG_ONLY_FOR_DT(VCF, add_line_numbers, "add-line-numbers");
 
@@ -1125,6 +1235,8 @@ void flags_update (unsigned num_files, rom *filenames)
         flag.md5 = false;
     }
     
+    flag.resumable |= flag.resume;
+
     flags_test_conflicts (num_files);
 
     // verify stuff needed for --pair and --deep
@@ -1179,7 +1291,7 @@ void flags_update (unsigned num_files, rom *filenames)
          flag.dump_one_b250_dict_id.num || // all other sections (except CHROM) are blocked from reading in piz_default_skip_section
          flag.show_index || flag.dump_section || flag.show_one_counts.num || flag.show_data_type ||
          flag.show_aliases || flag.show_txt_contigs || flag.show_gheader || flag.show_reading_list || flag.show_recon_plan || flag.show_ref_contigs ||
-        (flag.count && !flag.bases && !flag.grep) ||
+        (flag.count && !flag.bases && !flag.grep && !flag.filter) ||
          flag.collect_coverage); // note: this is updated in flags_update_piz_one_z_file
 
     flag.dont_load_ref_file |= is_genozip &&
@@ -1208,6 +1320,10 @@ void flags_update (unsigned num_files, rom *filenames)
 
     if ((flag.biopsy || flag_has_biopsy_line) && !flag.force_gencomp)
         flag.no_gencomp = true;
+
+    // --resumable: generated components are absorbed in an order that depends on thread timing, so they can't be re-created by --resume
+    if (flag.resumable)
+        flag.no_gencomp = true;
 }
 
 // ZIP: called ONCE per z_file, only for the MAIN component, after opening txt and z files, but before calling zip_one_file 
@@ -1221,6 +1337,9 @@ void flags_update_zip_one_file (void)
         ASSINP (!has_password(), "option --make-reference is incompatible with %s", OT("password", "p"));
     }
 
+    // --resume verifies the sections of the partial z_file, which it can't do if they are encrypted
+    ASSINP (!flag.resumable || !has_password(), "option --resumable is incompatible with %s", OT("password", "p"));
+
     if (flag.vblock && TXT_IS_VB_SIZE_BY_MGZIP) {
         WARN ("%s option is ignored, because %s is read using the efficient %s method. Tip: use --no-bgzf to override this.", 
               OT("vblock", "B"), txt_name, codec_name (txt_file->effective_codec));
@@ -1379,7 +1498,7 @@ static void flags_piz_set_out_dt (void)
     }
 }
 
-static bool flags_has_reconstructor_filter (void)
+static bool flags_has_reconstructor_filter_ex (bool incl_regions)
 {
     return is_genocat && 
         ((Z_DT(VCF) && (flag.snps_only || flag.indels_only)) || 
@@ -1390,7 +1509,15 @@ static bool flags_has_reconstructor_filter (void)
          // SAM specific line droppers
          (Z_DT(SAM)   && (flag.sam_flag_filter || flag.sam_mapq_filter || flag.bases || flag.qnames_file || flag.qnames_opt || flag.seq_filter || (!flag.deep && OUT_DT(FASTQ)))) || 
          // General filters
-         flag.grep || flag.regions);
+         flag.grep || flag.filter || (incl_regions && flag.regions));
+}
+
+#define flags_has_reconstructor_filter() flags_has_reconstructor_filter_ex (true)
+
+// true if --regions is the only option that causes the reconstructor to drop lines
+bool flags_regions_is_only_reconstructor_filter (void)
+{
+    return flag.regions && !flags_has_reconstructor_filter_ex (false);
 }
 
 // true if --count happens during writer_create_plan - no reconstruction needed
@@ -1426,6 +1553,14 @@ void flags_update_piz_one_z_file (int z_file_i /* -1 if unknown - called form fi
 
     flags_piz_set_out_dt();
 
+    // --arrow: values are captured from textual reconstruction, and the Arrow stream is not BGZF-compressed
+    if (flag.arrow) {
+        if (DTPO(is_binary) && DTPO(txt_type) != DT_NONE) 
+            flag.out_dt = DTPO(txt_type);
+        
+        flag.bgzf = 0;
+    }
+
     ASSINP (!flag.test || z_file->z_flags.has_digest, 
             "--test cannot be used with %s, as it was compressed without a digest. See " WEBSITE_DIGEST, z_name);
 
@@ -1583,7 +1718,7 @@ void flags_update_piz_one_z_file (int z_file_i /* -1 if unknown - called form fi
         flag.no_header = 2; // 2 = assigned here and not from command line
 
     bool maybe_txt_header_modified = is_genocat && 
-        (flag.no_header || flag.lines_first != NO_LINE || // options that may cause dropping of the txt header
+        (flag.no_header || flag.lines_first != NO_LINE || flag.arrow || // options that may cause dropping of the txt header
          (Z_DT(VCF) && (flag.header_one || flag.samples || flag.drop_genotypes))); // VCF specific options that modify the txt header
 
     bool maybe_vb_dropped_by_writer = is_genocat && // dropped by piz_dispatch_one_vb
@@ -1608,6 +1743,8 @@ void flags_update_piz_one_z_file (int z_file_i /* -1 if unknown - called form fi
     flag.maybe_vb_modified_by_reconstructor = is_genocat && 
          // translating to another data
         (!flag.reconstruct_as_src || 
+         // lines replaced by Arrow record batches
+         flag.arrow ||
          // lines may be dropped by reconstructor
          flag.maybe_lines_dropped_by_reconstructor || 
          // VCF specific VB modifiers
@@ -1621,7 +1758,7 @@ void flags_update_piz_one_z_file (int z_file_i /* -1 if unknown - called form fi
 
     // cases where Writer may re-order lines resulting in different ordering than within the VBs
     flag.maybe_lines_out_of_order = is_genocat && 
-         (OUT_DT(FASTQ)/*inc. deep*/ && flag.pair && flag.interleaved);
+         ((OUT_DT(FASTQ)/*inc. deep*/ && flag.pair && flag.interleaved) || flag.sort);
 
     // true if the PIZ output txt file will NOT be identical to the source file as recorded in z_file
     flag.piz_txt_modified = maybe_txt_header_modified                  || 
@@ -1647,7 +1784,7 @@ void flags_update_piz_one_z_file (int z_file_i /* -1 if unknown - called form fi
     // cases where we don't read unnecessary contexts, and should just reconstruct them as an empty
     // string (in other cases, it would be an error)
     flag.missing_contexts_allowed = flag.collect_coverage || flag.count || flag.drop_genotypes ||
-                                    flag.qual_only || flag.seq_only || flag.header_only_fast;
+                                    flag.qual_only || flag.seq_only || flag.header_only_fast || flag.arrow;
 
     ASSINP0 (!flag.interleaved || flag.deep_fq_only || flag.pair, 
              "--interleaved is supported only for paired FASTQ files and files compressed with --deep");
@@ -1681,6 +1818,10 @@ void flags_update_piz_one_z_file (int z_file_i /* -1 if unknown - called form fi
 
     // --add-line-numbers is only possible on SAM
     ASSINP0 (!flag.add_line_numbers || OUT_DT(SAM), "--add_line_numbers works on SAM/BAM data, when outputting it as SAM");
+
+    // --sort is only possible on SAM/BAM, when outputting it as SAM or BAM
+    ASSINP (!flag.sort || OUT_DT(SAM) || OUT_DT(BAM), 
+            "--sort is not supported for %s because it only works on SAM and BAM data, when outputting it as SAM or BAM", z_name);
     
     // --header-one only works on FASTA and VCF
     ASSINP (!flag.header_one || OUT_DT(FASTA) || OUT_DT(VCF) || OUT_DT(BCF), "--header-one is not supported for %s files", z_dt_name());
@@ -1689,6 +1830,9 @@ void flags_update_piz_one_z_file (int z_file_i /* -1 if unknown - called form fi
     ASSINP (!flag.grep || !DTPO(is_binary), "--grep is not supported when outputting %s data%s", 
             dt_name (flag.out_dt), OUT_DT(BAM) || OUT_DT(CRAM) ? ". Tip: add --sam": "");
 
+    // --filter evaluates fields of lines
+    ASSINP (!flag.filter || !(Z_DT(FASTA) || Z_DT(REF) || Z_DT(GNRIC)), "--filter is not supported for %s files", z_dt_name());
+
     // --gpos requires --reference
     ASSINP0 (!flag.gpos || flag.reference, "--gpos requires --reference");
     
@@ -1823,6 +1967,16 @@ bool flags_pipe_in_process_died (void)
 #endif
 }
 
+// genozip --server job process: forget the server's own command line, before processing the job's command line
+void flags_reset_for_server_job (void)
+{
+    flag    = default_flags;
+    command = NO_COMMAND;
+    optind  = 0; // getopt_long: restart scanning, and reinitialize its internal state
+
+    buf_free (command_line);
+}
+
 void flags_finalize (void)
 {
     buf_destroy (command_line);
@@ -57,6 +57,10 @@ typedef struct {
     int fast, best, low_memory, make_reference, multiseq, md5, secure_DP, not_paired,
         deep; // deep is set with --deep in ZIP and from SectionHeaderGenozipHeader.flags.genozip_header.dts2_deep in PIZ
     rom vblock, bam_assist;
+    rom codec_profile; // ZIP: file of codec selections - loaded to skip codec trials, and saved updated
+    uint32_t sample_blocks; // ZIP: VCF: number of samples per block in a sample-blocked layout, 0 if not blocked
+    int aggregates; // ZIP: SAM, BAM, VCF: add a SEC_AGGREGATES section with per-VB per-chrom counts, set by --aggregates
+    rom dict_template; // ZIP/PIZ: VCF, FASTQ: a .genozip file whose dictionaries prime the dictionaries of the compressed file
     int64_t sendto;
     
     // ZIP: data modifying options
@@ -87,6 +91,13 @@ typedef struct {
     rom regions_file, qnames_file, qnames_opt;
     int64_t lines_first, lines_last, tail;  // set by --head, --tail, --lines 
     rom grep; int grepw; unsigned grep_len; // set by --grep and --grep-w
+    rom filter; // --filter expression, compiled in expr_filter.c
+    rom arrow;       // genocat: fields to output as an Arrow IPC stream, set by --arrow
+    enum { SHARD_NONE, SHARD_BY_CHROM, SHARD_BY_VB_COUNT, SHARD_BY_SIZE } shard_by; // genocat: split output into multiple files, set by --shard-by
+    uint64_t shard_by_param; // --shard-by=vb-count:N - VBs per shard ; --shard-by=size:N - MB per shard
+    rom output_pattern; // genocat --shard-by: output filename, in which %s is replaced by the shard name, set by --output-pattern
+    int sort;        // genocat: output SAM/BAM alignments in coordinate order, set by --sort
+    uint64_t sort_memory; // genocat --sort: maximum memory, in MB, of in-memory sorted data before it is spilled to a temporary file, set by --sort-memory
     uint32_t one_vb, downsample, shard ;
     CompIType one_vb_comp_i; // PIZ: COMP_NONE is --one-vb is
     enum { SAM_FLAG_INCLUDE_IF_ALL=1, SAM_FLAG_INCLUDE_IF_NONE, SAM_FLAG_EXCLUDE_IF_ALL } sam_flag_filter;
@@ -112,13 +123,20 @@ typedef struct {
         list,        // a genols option
         no_bgzf,     // if this is a GZIP file, treat as normal GZIP, not BGZF
         no_zriter, explicit_no_zriter,  // ZIP: don't use background threads to write z_file
+        resumable,   // ZIP: periodically write a checkpoint, so that an interrupted compression can be continued with --resume
+        resume,      // ZIP: continue an interrupted --resumable compression from its last checkpoint (implies --resumable)
         no_cache,    // don't load cache, or delete cache
+        ref_image,   // create a pre-expanded image of the reference file, that subsequent runs can mmap instead of loading the reference
+        progressive, // PIZ: minimize time-to-first-byte: start writing while still loading SA Groups, and flush output early
         no_upgrade,  // disable upgrade checks
         no_eval,     // don't allow features on eval basis (used for testing permissions)
         from_url,    // used for stats
         do_activate; // activate license
     rom test_i;      // test of test.sh currently running (undocumented)
     rom threads_str, out_filename, out_dirname, files_from;
+    rom server;      // genozip --server: Unix socket on which to listen for jobs
+    uint32_t concurrent_files; // genozip: number of input files compressed concurrently, set by --concurrent-files
+    uint32_t sub_vb_index; // ZIP: generate a sub-VB random access index, with a granularity of this many lines, set by --sub-vb-index
     rom lic_param;   // format: width,type - invoked by Makefile
     FileType stdin_type; // set by the --input command line option
     bool explicitly_generic; // user explicitly set the type to generic
@@ -146,11 +164,11 @@ typedef struct {
         show_threads, show_uncompress, biopsy, skip_segconf, show_data_type,
         debug_progress, show_hash, debug_memory, debug_threads, debug_stats, debug_generate, debug_recon_size, debug_seg,
         debug_LONG, show_qual, debug_qname, debug_read_ctxs, debug_sag, debug_gencomp, debug_lines, debug_latest,
-        debug_peek, stats_submit, debug_submit, show_segconf_has, debug_split, debug_upgrade, debug_expiration,
+        debug_peek, stats_submit, debug_submit, show_segconf_has, debug_split, debug_resume, debug_upgrade, debug_expiration,
         debug_debug,  // a flag with no functionality - used for ad-hoc debugging  
         debug_valgrind, debug_tar, // ad-hoc debug printing in prod
         show_compress, show_sec_gencomp, show_scan,
-        no_gencomp, force_gencomp, force_reread, force_deep, force_PLy, no_domqual, no_pacb, no_longr, no_homp, no_smux, no_faf, no_interleaved,
+        no_gencomp, force_gencomp, sag_single_pass, force_reread, force_deep, force_PLy, no_domqual, no_pacb, no_longr, no_homp, no_smux, no_faf, no_interleaved,
         force_qual_codec, verify_codec, 
         seg_only, show_bam, xthreads,
         #define SHOW_CONTAINERS_ALL_VBs (-1)
@@ -233,12 +251,13 @@ typedef struct {
          deep_no_qual,       // ZIP: don't deep QUAL data
          removing_cache,     // genocat: running --no-cache with only -e <ref-file> to remove cache
          let_OS_cleanup_on_exit, // don't release resources as we are about to exit - the OS does it faster
-         reading_reference;  // system is currently reading a reference
+         reading_reference,  // system is currently reading a reference
+         reading_dict_template; // system is currently reading the --dict-template file
     int only_headers,        // genocat --show_headers (not genounzip) show only headers (value is section_type+1 or SHOW_ALL_HEADERS)
         check_latest;        // PIZ: run with "genozip --decompress --test": ZIP passes this to PIZ upon testing of the last file
     enum { NO_PREPROC, PREPROC_RUNNING, PREPROC_FINALIZING } preprocessing; // we're currently dispatching compute threads for preprocessing (PIZ: loading SA Groups, ZIP: loading bamass ents)
 
-#define flag_loading_auxiliary (flag.reading_reference) // PIZ: currently reading auxiliary file (reference etc)
+#define flag_loading_auxiliary (flag.reading_reference || flag.reading_dict_template) // PIZ: currently reading auxiliary file (reference, dictionary template)
 
     rom unbind;
     rom log_filename;  // output to info_stream goes here
@@ -285,6 +304,7 @@ extern bool option_is_short[];
 
 extern void flags_init_from_command_line (int argc, char **argv);
 extern void flags_finalize (void);
+extern void flags_reset_for_server_job (void);
 extern void flags_update (unsigned num_files, rom *filenames);
 extern void flags_update_zip_one_file (void);
 extern void flags_update_piz_one_z_file (int z_file_i);
@@ -298,6 +318,7 @@ extern bool flags_pipe_in_process_died (void);
 extern bool flags_is_genocat_global_area_only (void);
 extern rom pair_type_name (PairType p);
 extern bool flags_writer_counts (void);
+extern bool flags_regions_is_only_reconstructor_filter (void);
 static inline bool flag_is_show_vblocks (rom task)
 {
     return flag.show_vblocks && (!task || !flag.show_vblocks[0] || !strcmp (flag.show_vblocks, task));
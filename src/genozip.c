@@ -11,6 +11,9 @@
 #include <dirent.h>
 #include <errno.h>
 #include <sys/types.h>
+#ifndef _WIN32
+#include <sys/wait.h>
+#endif
 #ifdef __APPLE__ 
 #include "mac_compat.h"
 #endif
@@ -29,6 +32,9 @@
 #include "tip.h"
 #include "refhash.h"
 #include "random_access.h"
+#include "aggregates.h"
+#include "dict_template.h"
+#include "shard.h"
 #include "codec.h"
 #include "threads.h"
 #include "bases_filter.h"
@@ -39,6 +45,8 @@
 #include "dispatcher.h"
 #include "biopsy.h"
 #include "regions.h"
+#include "server.h"
+#include "zip_resume.h"
 
 // globals - set in main() and immutable thereafter
 char global_cmd[256]; 
@@ -126,7 +134,8 @@ void noreturn main_exit (bool show_stack, bool is_error)
 
             // note: logic to avoid a race condition causing the file not to be removed - if another thread seg-faults
             // because it can't access a z_file filed after z_file is freed, and threads_sigsegv_handler aborts
-            if (is_error && !flag.debug_or_test && file_exists (save_name)) 
+            // note: a --resumable z_file that has a checkpoint is kept, so it can be continued with --resume
+            if (is_error && !flag.debug_or_test && file_exists (save_name) && !zip_resume_has_checkpoint()) 
                 file_remove (save_name, true);
         }
 
@@ -395,6 +404,8 @@ static void main_test_after_genozip (rom z_filename, DataType z_dt, bool is_last
                                       flag.license_filename ? flag.license_filename : SKIP_ARG,
                                       IS_REF_EXTERNAL    ? "--reference"      : SKIP_ARG, 
                                       IS_REF_EXTERNAL    ? ref_get_filename()   : SKIP_ARG, 
+                                      flag.dict_template ? "--dict-template"  : SKIP_ARG,
+                                      flag.dict_template ? flag.dict_template : SKIP_ARG,
                                       // note: no need for --check-latest as this call returns, and we check-latest and print the tip it in ZIP
                                       NULL);
                                       // ↓↓↓ Don't forget to add below too ↓↓↓
@@ -451,6 +462,9 @@ static void main_test_after_genozip (rom z_filename, DataType z_dt, bool is_last
 
         if (IS_REF_EXTERNAL) {  argv[argc++] = "--reference"; 
                                 argv[argc++] = ref_get_filename(); }
+
+        if (flag.dict_template) { argv[argc++] = "--dict-template"; 
+                                argv[argc++] = flag.dict_template; }
         argv[argc] = NULL;
                                 // ↑↑↑ Don't forget to add above too ↑↑↑
 
@@ -733,6 +747,140 @@ static void main_load_reference (rom filename, bool is_first_file, bool is_last_
     RESTORE_VALUE (txt_file);
 }
 
+// genozip --concurrent-files: compress files in separate processes, up to flag.concurrent_files at a time, dividing the
+// threads between them. A new file starts as soon as another completes, so the ramp-up and tail of files overlap.
+// The reference and refhash are loaded before forking, and hence shared copy-on-write by all processes.
+static void main_genozip_concurrently (rom *input_files, unsigned num_files)
+{
+#ifndef _WIN32
+    // validate all files before forking, so we don't fail after some files were already compressed
+    for (unsigned i=0; i < num_files; i++)
+        ASSINP0 (strcmp (input_files[i] + (input_files[i][0] == '\1'/*skip "MALLOC indicator"*/), "-"), 
+                 "--concurrent-files cannot be used with input from stdin");
+
+    unsigned max_concurrent = MIN_(flag.concurrent_files, num_files);
+    global_max_threads = MAX_(global_max_threads / max_concurrent, 1); 
+
+    pid_t pids[max_concurrent];
+    unsigned n_running=0, n_failed=0;
+
+    file_i = 0;
+    while (file_i < num_files || n_running) {
+
+        // case: no more room or no more files - wait for a file to complete
+        if (n_running == max_concurrent || file_i == num_files) {
+            int status;
+            pid_t pid = waitpid (-1, &status, 0);
+            if (pid < 0) {
+                ASSERT (errno == EINTR, "waitpid failed: %s", strerror (errno));
+                continue;
+            }
+
+            for (unsigned i=0; i < n_running; i++)
+                if (pids[i] == pid) {
+                    if (!WIFEXITED (status) || WEXITSTATUS (status) != EXIT_OK) n_failed++;
+                    pids[i] = pids[--n_running];
+                    break;
+                }
+
+            continue; // note: if pid is not one of ours (eg a stream) - we just ignore it
+        }
+
+        rom txt_filename = input_files[file_i];
+        if (txt_filename[0] == '\1') txt_filename++; // skip "MALLOC indicator"
+
+        main_load_reference (txt_filename, !file_i, false); // loads only once, possibly adding the refhash for a later file
+
+        fflush (stdout);
+        fflush (stderr);
+
+        pid_t pid = fork();
+        ASSERT (pid >= 0, "fork failed: %s", strerror (errno));
+
+        // case: child process - compress one file. note: not reporting it as the last file, so that --test runs as a
+        // separate process rather than replacing this one
+        if (!pid) {
+            file_put_data_reset_after_fork();
+            main_genozip (txt_filename, NULL, file_i, false);
+            
+            threads_finalize();
+            fflush (stdout);
+            fflush (stderr);
+            exit (EXIT_OK);
+        }
+
+        pids[n_running++] = pid;
+        file_i++;
+    }
+
+    ASSINP (!n_failed, "Failed to compress %u of %u files", n_failed, num_files);
+#endif
+}
+
+// genocat --shard-by: a first pass reads the global area and calculates the shards, and then each shard is written by 
+// a separate process, up to global_max_threads/4 at a time, dividing the threads between them - so that the writer 
+// thread and BGZF compression of a single output file are not a bottleneck. A reference loaded before forking is 
+// shared copy-on-write by all processes.
+static void main_genocat_shards (rom z_filename, int z_file_i, bool is_last_z_file)
+{
+#ifndef _WIN32
+    main_genounzip (z_filename, NULL, z_file_i, false); // calculates the shards (see piz_z_file_initialize)
+
+    uint32_t num_shards = shard_piz_get_num_shards();
+    unsigned max_concurrent = MIN_(num_shards, MAX_(global_max_threads / 4, 1));
+    global_max_threads = MAX_(global_max_threads / max_concurrent, 1);
+
+    pid_t pids[max_concurrent];
+    unsigned n_running=0, n_failed=0;
+
+    uint32_t shard_i = 0;
+    while (shard_i < num_shards || n_running) {
+
+        // case: no more room or no more shards - wait for a shard to complete
+        if (n_running == max_concurrent || shard_i == num_shards) {
+            int status;
+            pid_t pid = waitpid (-1, &status, 0);
+            if (pid < 0) {
+                ASSERT (errno == EINTR, "waitpid failed: %s", strerror (errno));
+                continue;
+            }
+
+            for (unsigned i=0; i < n_running; i++)
+                if (pids[i] == pid) {
+                    if (!WIFEXITED (status) || WEXITSTATUS (status) != EXIT_OK) n_failed++;
+                    pids[i] = pids[--n_running];
+                    break;
+                }
+
+            continue; // note: if pid is not one of ours (eg a stream) - we just ignore it
+        }
+
+        fflush (stdout);
+        fflush (stderr);
+
+        pid_t pid = fork();
+        ASSERT (pid >= 0, "fork failed: %s", strerror (errno));
+
+        // case: child process - write one shard
+        if (!pid) {
+            file_put_data_reset_after_fork();
+            shard_piz_set_flags (shard_i);
+            main_genounzip (z_filename, flag.out_filename, z_file_i, is_last_z_file);
+            
+            threads_finalize();
+            fflush (stdout);
+            fflush (stderr);
+            exit (EXIT_OK);
+        }
+
+        pids[n_running++] = pid;
+        shard_i++;
+    }
+
+    ASSINP (!n_failed, "Failed to write %u of %u shards", n_failed, num_shards);
+#endif
+}
+
 static void set_exe_type (rom argv0)
 {
     rom bn = filename_base (argv0, false, NULL, NULL, 0);
@@ -745,6 +893,43 @@ else                                   exe_type = EXE_GENOZIP; // default
     FREE (bn);
 }
 
+static void main_process_command_line (int argc, char **argv)
+{
+    flags_init_from_command_line (argc, argv); // also sets command and hence IS_ZIP, IS_PIZ etc
+
+    MAIN0 ("Starting main"); // after top_debug is set
+
+    if (is_genozip && IS_PIZ) exe_type = EXE_GENOUNZIP; // treat "genozip -d" as genounzip
+
+    // --make-reference might be called by genocat or genounzip from ref_fasta_to_ref - we treat it as genozip
+    if (flag.make_reference) {
+        exe_type = EXE_GENOZIP;
+        command  = ZIP;
+    }
+
+    flags_store_command_line (argc, argv); // can only be called after --password is processed
+}
+
+// genozip --server: load the reference and refhash, to be inherited by all jobs
+static void main_server_load_reference (int argc)
+{
+    ASSINP0 (is_genozip && IS_ZIP, "--server can only be used with genozip");
+    ASSINP0 (optind == argc, "--server does not accept input files");
+
+    if (!IS_REF_EXTERNAL && !IS_REF_EXT_STORE) return;
+
+    primary_command = ZIP;
+    flag.aligner_available = true; // load refhash too, for jobs compressing FASTQ or SAM/BAM with --best or --deep
+
+    MAIN ("Loading external reference: %s", ref_get_filename());
+    ref_load_external_reference (NULL);
+
+    if (!refhash_buf.count) {
+        MAIN0 ("Loading refhash");
+        refhash_load_standalone();
+    }
+}
+
 // command line contains no files - special actions
 static void main_no_files (int argc)
 {
@@ -796,29 +981,36 @@ int main (int argc, char **argv)
 
     filename_base (argv[0], true, "(executable)", global_cmd, sizeof(global_cmd)); // global var
 
+    // --use-server=SOCKET: submit this command to a genozip server, and exit with its exit status
+    server_run_client_if_requested (argc, argv);
+
     info_stream = stdout; // may be changed during initialization
     profiler_initialize();
     arch_initialize (argv[0]);
     evb = vb_initialize_nonpool_vb (VB_ID_EVB, DT_NONE, "main_thread");
     threads_initialize(); // requires evb
     random_access_initialize();
+    aggregates_initialize();
     codec_initialize();
     dt_initialize();
 
-    flags_init_from_command_line (argc, argv); // also sets command and hence IS_ZIP, IS_PIZ etc
+    main_process_command_line (argc, argv);
 
-    MAIN0 ("Starting main"); // after top_debug is set
+    // genozip --server: load the reference once, and then wait for jobs. Each job runs in a process forked 
+    // from the server, which returns here with the job's command line.
+    if (flag.server) {
+        main_server_load_reference (argc);
+        server_run (flag.server, &argc, &argv); 
 
-    if (is_genozip && IS_PIZ) exe_type = EXE_GENOUNZIP; // treat "genozip -d" as genounzip
+        set_exe_type (argv[0]);
+        filename_base (argv[0], true, "(executable)", global_cmd, sizeof(global_cmd));
+        flags_reset_for_server_job();
+        ref_server_job_initialize();
 
-    // --make-reference might be called by genocat or genounzip from ref_fasta_to_ref - we treat it as genozip
-    if (flag.make_reference) {
-        exe_type = EXE_GENOZIP;
-        command  = ZIP;
+        main_process_command_line (argc, argv);
+        ASSINP0 (!flag.server, "--server cannot be used in a job submitted to a genozip server");
     }
 
-    flags_store_command_line (argc, argv); // can only be called after --password is processed
-
     // handle all commands except for ZIP, PIZ or LIST
     if (command == VERSION) { main_print_version();    return 0; }
     if (command == LICENSE) { license_display (false); return 0; }
@@ -865,13 +1057,20 @@ int main (int argc, char **argv)
     // section of the license. Rather, please contact sales@genozip.com to discuss which license would be appropriate for your case.
     if (IS_ZIP) license_load(); 
 
+    // --dict-template: load the template's dictionaries once, for all files
+    if (IS_ZIP || IS_PIZ) dict_template_load();
+
     // if we're genozipping with tar, initialize tar file
     if (IS_ZIP && tar_zip_is_tar()) 
         tar_initialize (&input_files_buf);
 
     n_files = MAX_(input_files_len, 1);
     unsigned z_file_i=0;
-    for (file_i=0; file_i < n_files; file_i++) {
+
+    if (IS_ZIP && flag.concurrent_files > 1 && input_files_len > 1)
+        main_genozip_concurrently (input_files, input_files_len);
+
+    else for (file_i=0; file_i < n_files; file_i++) {
 
         // get file name
         rom next_input_file = input_files_len ? input_files[file_i] : NULL;  // NULL means stdin
@@ -907,7 +1106,8 @@ int main (int argc, char **argv)
                                         file_i, !next_input_file || is_last_txt_file); 
                             break;
 
-                case PIZ  : main_genounzip (next_input_file, flag.out_filename, file_i, is_last_z_file); 
+                case PIZ  : if (flag.shard_by) main_genocat_shards (next_input_file, file_i, is_last_z_file);
+                            else               main_genounzip (next_input_file, flag.out_filename, file_i, is_last_z_file); 
                             break;           
 
                 case SHOW_HEADERS : genocat_show_headers (next_input_file); break;
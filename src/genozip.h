@@ -343,6 +343,9 @@ typedef packed_enum { // 1 byte
     SEC_USER_MESSAGE    = 20, // Global section: introduced 15.0.30
     SEC_GENCOMP         = 21, // Section belonging to the SAM component (optional): used for SAM gencomp since v15.0.64
     SEC_HUFFMAN         = 22, // Section belonging to the SAM component (optional): huffman compression codes of QNAME (could be used for other data in the future)
+    SEC_RA_LINES        = 23, // Global section (optional): sub-VB random access index, generated with --sub-vb-index. introduced 15.0.74
+    SEC_AGGREGATES      = 24, // Global section (optional): per-VB per-chrom line and base counts, generated with --aggregates. introduced 15.0.74
+    SEC_DICT_TEMPLATE   = 25, // Global section (optional): dictionary words primed from a --dict-template file, which are not included in SEC_DICT. introduced 15.0.74
     NUM_SEC_TYPES 
 } SectionType;
 
@@ -128,3 +128,26 @@ libdeflate_adler32(u32 adler, const void *buffer, size_t len)
 		return 1;
 	return adler32_impl(adler, buffer, len);
 }
+
+/*
+ * libdeflate_adler32_combine() returns the Adler-32 of the concatenation of two
+ * buffers, given the Adler-32 of each (the second starting from the initial
+ * value 1) and the length of the second. Same as zlib's adler32_combine(). // divon
+ */
+LIBDEFLATEAPI u32
+libdeflate_adler32_combine(u32 adler1, u32 adler2, u64 len2)
+{
+	u32 rem = (u32)(len2 % DIVISOR);
+	u64 s1 = adler1 & 0xFFFF;
+	u64 s2 = (rem * s1) % DIVISOR;
+
+	s1 += (adler2 & 0xFFFF) + DIVISOR - 1;
+	s2 += (adler1 >> 16) + (adler2 >> 16) + DIVISOR - rem;
+
+	if (s1 >= DIVISOR) s1 -= DIVISOR;
+	if (s1 >= DIVISOR) s1 -= DIVISOR;
+	if (s2 >= ((u64)DIVISOR << 1)) s2 -= ((u64)DIVISOR << 1);
+	if (s2 >= DIVISOR) s2 -= DIVISOR;
+
+	return (u32)(s1 | (s2 << 16));
+}
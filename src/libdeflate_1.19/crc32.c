@@ -260,3 +260,48 @@ libdeflate_crc32(u32 crc, const void *p, size_t len)
 		return 0;
 	return ~crc32_impl(~crc, p, len);
 }
+
+/*
+ * libdeflate_crc32_combine() returns the CRC-32 of the concatenation of two
+ * buffers, given the CRC-32 of each (the second starting from the initial value
+ * 0) and the length of the second: crc1 is multiplied by x^(8*len2) modulo the
+ * CRC polynomial, as in zlib's crc32_combine(). // divon
+ */
+
+/* x^(2^n) modulo the (reflected) CRC polynomial, for n=0..31 */
+static const u32 crc32_x2n_table[32] = {
+	0x40000000, 0x20000000, 0x08000000, 0x00800000, 0x00008000, 0xedb88320, 0xb1e6b092, 0xa06a2517,
+	0xed627dae, 0x88d14467, 0xd7bbfe6a, 0xec447f11, 0x8e7ea170, 0x6427800e, 0x4d47bae0, 0x09fe548f,
+	0x83852d0f, 0x30362f1a, 0x7b5a9cc3, 0x31fec169, 0x9fec022a, 0x6c8dedc4, 0x15d6874d, 0x5fde7a4e,
+	0xbad90e37, 0x2e4e5eef, 0x4eaba214, 0xa8a472c0, 0x429a969e, 0x148d302a, 0xc40ba6d0, 0xc4e22c3c
+};
+
+/* a*b modulo the CRC polynomial, in the reflected representation */
+static u32 crc32_multmodp(u32 a, u32 b)
+{
+	u32 m = (u32)1 << 31, p = 0;
+
+	for (;;) {
+		if (a & m) {
+			p ^= b;
+			if ((a & (m - 1)) == 0)
+				break;
+		}
+		m >>= 1;
+		b = (b & 1) ? (b >> 1) ^ 0xedb88320 : b >> 1;
+	}
+	return p;
+}
+
+LIBDEFLATEAPI u32
+libdeflate_crc32_combine(u32 crc1, u32 crc2, u64 len2)
+{
+	u32 p = (u32)1 << 31; /* x^0 */
+	unsigned k = 3;       /* len2 is in bytes, ie 2^3 bits */
+
+	for (; len2; len2 >>= 1, k++)
+		if (len2 & 1)
+			p = crc32_multmodp(crc32_x2n_table[k & 31], p);
+
+	return crc32_multmodp(p, crc1) ^ crc2;
+}
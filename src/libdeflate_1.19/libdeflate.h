@@ -339,6 +339,18 @@ static inline uint32_t adler32 (uint32_t adler, const void *buffer, size_t len)
 	return libdeflate_adler32 (adler, buffer, len); // faster that ISA-L's tested - on Linux and Windows
 }
 
+/*
+ * libdeflate_adler32_combine() returns the Adler-32 checksum of two concatenated
+ * buffers, given the checksum of each and the length of the second. // divon
+ */
+LIBDEFLATEAPI uint32_t
+libdeflate_adler32_combine(uint32_t adler1, uint32_t adler2, uint64_t len2);
+
+static inline uint32_t adler32_combine (uint32_t adler1, uint32_t adler2, uint64_t len2) // divon
+{
+	return libdeflate_adler32_combine (adler1, adler2, len2);
+}
+
 /*
  * libdeflate_crc32() updates a running CRC-32 checksum with 'len' bytes of data
  * and returns the updated checksum.  When starting a new checksum, the required
@@ -353,6 +365,18 @@ static inline uint32_t crc32 (uint32_t crc, const void *buffer, size_t len) // d
 	return libdeflate_crc32 (crc, buffer, len); // approx the same speed as ISA-L's
 }
 
+/*
+ * libdeflate_crc32_combine() returns the CRC-32 checksum of two concatenated
+ * buffers, given the checksum of each and the length of the second. // divon
+ */
+LIBDEFLATEAPI uint32_t
+libdeflate_crc32_combine(uint32_t crc1, uint32_t crc2, uint64_t len2);
+
+static inline uint32_t crc32_combine (uint32_t crc1, uint32_t crc2, uint64_t len2) // divon
+{
+	return libdeflate_crc32_combine (crc1, crc2, len2);
+}
+
 /* ========================================================================== */
 /*                           Custom memory allocator                          */
 /* ========================================================================== */
@@ -1579,6 +1579,19 @@ void bgzf_dispatch_compress (Dispatcher dispatcher, STRp (uncomp), CompIType com
     }
 }
 
+// writer thread: BGZF-compress a small in-memory file (eg a .tbi index) into vb->comp_txt_data, followed by an EOF block
+void bgzf_compress_buf (VBlockP vb, STRp(data))
+{
+    bgzf_alloc_compressor (vb, txt_file->mgzip_flags);
+
+    for (uint32_t i=0; i < data_len; i += BGZF_CREATED_BLOCK_SIZE)
+        bgzf_compress_one_block (vb, data + i, MIN_(BGZF_CREATED_BLOCK_SIZE, data_len - i), i / BGZF_CREATED_BLOCK_SIZE, i);
+
+    bgzf_compress_one_block (vb, NULL, 0, 0, data_len); // EOF block
+
+    bgzf_free_compressor (vb, txt_file->mgzip_flags);
+}
+
 rom bgzf_library_name (MgzipLibraryType library, bool long_name)
 {
     return (library < 0 || library >= NUM_ALL_BGZF_LIBRARIES) ? "INVALID_BGZF_LIBRARY"
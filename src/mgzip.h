@@ -159,6 +159,7 @@ extern FlagsMgzip mgzip_piz_calculate_mgzip_flags (CompIType comp_i, Codec src_c
 extern void bgzf_piz_set_txt_file_bgzf_info (FlagsMgzip mgzip_flags, bytes codec_info);
 extern void bgzf_dispatch_compress (Dispatcher dispatcher, STRp (uncomp), CompIType comp_i, bool is_last);
 extern void bgzf_write_finalize (void);
+extern void bgzf_compress_buf (VBlockP vb, STRp(data));
 
 // misc
 extern rom bgzf_library_name (MgzipLibraryType library, bool long_name);
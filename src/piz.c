@@ -11,6 +11,9 @@
 #include "dispatcher.h"
 #include "piz.h"
 #include "random_access.h"
+#include "aggregates.h"
+#include "dict_template.h"
+#include "shard.h"
 #include "regions.h"
 #include "ref_iupacs.h"
 #include "refhash.h"
@@ -29,6 +32,7 @@
 #include "user_message.h"
 #include "huffman.h"
 #include "filename.h"
+#include "arrow.h"
 
 TRANSLATOR_FUNC (piz_obsolete_translator)
 {
@@ -209,7 +213,7 @@ bool piz_default_skip_section (SectionType st, DictId dict_id)
     ||  (flag.show_one_counts.num && typeless_dnum != flag.show_one_counts.num)
 
     // if --counts, we filter here - TOPLEVEL only - unless there's a skip_section function which will do the filtering
-    ||  (flag.count && !DTPZ(is_skip_section) && dict_id.num != DTFZ(toplevel).num) 
+    ||  (flag.count && !flag.filter && !DTPZ(is_skip_section) && dict_id.num != DTFZ(toplevel).num) 
     );
 
     skip |= flag.dont_load_ref_file && (ST(REFERENCE) || st == SEC_REF_HASH || ST(REF_IS_SET));
@@ -409,6 +413,9 @@ static void piz_reconstruct_one_vb (VBlockP vb)
 
     DT_FUNC (vb, piz_vb_recon_init)(vb);
 
+    // --regions: lines before the first or after the last one that might intersect the regions are dropped early 
+    random_access_set_recon_lines_range (vb);
+
     // reconstruct from top level snip
     Did top_level_did_i = ctx_get_existing_did_i (vb, vb->translation.toplevel); 
     reconstruct_from_ctx (vb, top_level_did_i, 0, true);
@@ -423,6 +430,8 @@ static void piz_reconstruct_one_vb (VBlockP vb)
 
     if (DTP(piz_after_recon)) DTP(piz_after_recon)(vb);
 
+    if (flag.arrow) arrow_piz_finalize_vb (vb);
+
     vb_set_is_processed (vb); /* tell dispatcher this thread is done and can be joined. this operation needn't be atomic, but it likely is anyway */ 
 
     if (flag.debug_or_test) buflist_test_overflows(vb, __FUNCTION__); 
@@ -572,6 +581,7 @@ DataType piz_read_global_area (void)
 
     // read all dictionaries - CHROM/RNAME is needed for regions_make_chregs(). 
     // Note: some dictionaries are skipped based on skip() and all flag logic should implemented there
+    dict_template_piz_prime(); // --dict-template: must be before SEC_DICT fragments are appended
     dict_io_read_all_dictionaries(); 
 
     if (!flag.header_only) {
@@ -608,6 +618,10 @@ DataType piz_read_global_area (void)
         random_access_load_ra_section (SEC_REF_RAND_ACC, CHROM, ref_get_stored_ra(), "ref_stored_ra", 
                                        flag.show_ref_index && !flag.reading_reference ? RA_MSG_REF : NULL);
 
+        random_access_load_ra_lines_section(); // only if needed for --regions
+
+        aggregates_load_section(); // only if needed for --count, --coverage or --idxstats
+
         // case: reading reference file
         if (flag.reading_reference) {
 
@@ -734,16 +748,9 @@ static void piz_handover_or_discard_vb (Dispatcher dispatcher, VBlockP *vb)
 {
     bool is_handed_over = false;
 
-    if ((*vb)->preprocessing) {
+    if ((*vb)->preprocessing) 
         DT_FUNC (z_file, piz_after_preproc_vb)(*vb);
 
-        if (flag.preprocessing == PREPROC_FINALIZING &&  
-            !dispatcher_get_num_running_compute_threads (dispatcher)) {
-            
-            DTPZ(piz_preproc_finalize) (dispatcher);
-        }
-    }
-
     else if (!flag.no_writer_thread)  // note: in SAM with gencomp - writer does the digest calculation
         is_handed_over = writer_handover_data (vb);
 
@@ -843,9 +850,17 @@ Dispatcher piz_z_file_initialize (void)
 
     if (flag.genocat_global_area_only) return NULL;
 
+    // genocat --shard-by: this pass only calculates the shards - they are written by child processes
+    if (flag.shard_by) {
+        shard_piz_calculate();
+        return NULL;
+    }
+
     if (!flag_loading_auxiliary && DTPZ(piz_after_global_area)) // must be before writer_create_plan messes up the section list
         DTPZ(piz_after_global_area)();
 
+    if (flag.arrow) arrow_piz_initialize();
+
     writer_z_initialize();
 
     if (flag.test || flag.md5) 
@@ -865,6 +880,22 @@ Dispatcher piz_z_file_initialize (void)
     return dispatcher;
 }
 
+// --progressive: true if the next section in the reading list may be dispatched while preprocessing is still running: 
+// the TXT_HEADER (which also starts the writer) and MAIN VBs, which don't use SA Groups. PRIM and DEPN VBs, and the end of 
+// the reading list, wait for preprocessing to complete. We always leave a free VB for preprocessing, so it can progress
+// even if the writer is holding MAIN VBs, waiting for PRIM/DEPN lines.
+static bool piz_can_dispatch_during_preproc (void)
+{
+    if (!flag.progressive) return false;
+
+    if (z_file->piz_reading_list.next >= z_file->piz_reading_list.len) return false;
+
+    Section sec = B(SectionEnt, z_file->piz_reading_list, z_file->piz_reading_list.next);
+
+    return IS_TXT_HEADER(sec) || 
+           (sec->comp_i == COMP_MAIN && vb_pool_get_num_in_use (POOL_MAIN, NULL) + 1 < vb_get_pool (POOL_MAIN, HARD_FAIL)->num_vbs);
+}
+
 // main thread: called once per txt_file created: i.e. once, except if unbinding a paired FASTQ, or a Deep file.
 void piz_one_txt_file (Dispatcher dispatcher, bool is_first_z_file, bool is_last_z_file,
                        CompIType first_comp_i, CompIType last_comp_i, // COMP_NONE unless flag.unbind
@@ -883,23 +914,31 @@ void piz_one_txt_file (Dispatcher dispatcher, bool is_first_z_file, bool is_last
       
     bool header_only_file = true; // initialize - true until we encounter a VB header
     uint64_t num_nondrop_lines = 0;
+    uint32_t num_preproc_vbs_running = 0;
+    bool prefer_recon = true; // --progressive: alternate between preprocessing and reconstruction VBs, starting with the TXT_HEADER
 
     // traverse section list as re-arranged by writer_create_plan
     while (!dispatcher_is_done (dispatcher)) {
 
         bool achieved_something = false;
-        
+        bool can_recon = !flag.preprocessing || piz_can_dispatch_during_preproc();
+
         // we're pre-processing data (SAM: loading sag)
-        if (flag.preprocessing && dispatcher_has_free_thread (dispatcher) && !vb_pool_is_full (POOL_MAIN)) {
+        if (flag.preprocessing && dispatcher_has_free_thread (dispatcher) && !vb_pool_is_full (POOL_MAIN) && 
+            !(can_recon && prefer_recon)) {
             achieved_something = DTPZ(piz_preprocess)(dispatcher);
 
-            if (!achieved_something) flag.preprocessing = PREPROC_FINALIZING; // some preprocessing VBs may still be running, but no new VBs are forthcoming
+            if (achieved_something) num_preproc_vbs_running++;
+            else                    flag.preprocessing = PREPROC_FINALIZING; // some preprocessing VBs may still be running, but no new VBs are forthcoming
+            
+            prefer_recon = true;
         }
 
         // In input is not exhausted, and a compute thread is available - read a vblock and dispatch it
-        else if (!flag.preprocessing && !dispatcher_is_input_exhausted (dispatcher) && 
+        else if (can_recon && !dispatcher_is_input_exhausted (dispatcher) && 
                  dispatcher_has_free_thread (dispatcher) && !vb_pool_is_full (POOL_MAIN)) {
             achieved_something = true;
+            prefer_recon = false;
 
             // note: z_file->piz_reading_list contains only TXT_HEADER and VB_HEADER sections needed to reconstruct this txt file
             Section sec = B(SectionEnt, z_file->piz_reading_list, z_file->piz_reading_list.next++); // bad pointer if beyond list
@@ -952,10 +991,16 @@ void piz_one_txt_file (Dispatcher dispatcher, bool is_first_z_file, bool is_last
             dispatcher_increment_progress ("preproc_or_recon", 1 + (!vb->preprocessing && flag.no_writer_thread)); // done preprocessing or reconstructing (+1 if skipping writing)
             if (!vb->preprocessing) 
                 piz_handle_reconstructed_vb (dispatcher, vb, &num_nondrop_lines);
-            else
+            else {
                 piz_handover_or_discard_vb (dispatcher, &vb);
+                num_preproc_vbs_running--;
+            }
         }
 
+        // all preprocessing VBs are joined (note: with --progressive, reconstruction VBs might still be running)
+        if (flag.preprocessing == PREPROC_FINALIZING && !num_preproc_vbs_running) 
+            DTPZ(piz_preproc_finalize) (dispatcher);
+
         if (!achieved_something) {
             START_TIMER;
             usleep (30000); // nothing for us to do right now - wait 30ms
@@ -990,9 +1035,10 @@ void piz_one_txt_file (Dispatcher dispatcher, bool is_first_z_file, bool is_last
 
     // --sex and --coverage - output results
     if (txt_file && !flag_loading_auxiliary) {
+        if (aggregates_can_replace_coverage()) aggregates_fill_coverage();
         if (flag.show_coverage) coverage_show_coverage();
         if (flag.idxstats) coverage_show_idxstats();
-        if (flag.count == CNT_TOTAL) iprintf ("%"PRIu64"\n", num_nondrop_lines);
+        if (flag.count == CNT_TOTAL) iprintf ("%"PRIu64"\n", num_nondrop_lines + aggregates_get_count());
     }
 
     if (is_genocat || (z_file->num_txts_so_far == z_file->num_txt_files)) // genocat always produces exactly one txt file 
@@ -14,9 +14,12 @@
 extern bool piz_default_skip_section (SectionType st, DictId dict_id);
 
 #define piz_is_skip_section(dt,st,comp_i,dict_id,f,preprocessing) \
-    (vb->data_type != DT_NONE && (piz_default_skip_section ((st), (dict_id)) || \
+    (vb->data_type != DT_NONE && !flag.reading_dict_template/*all dictionaries of the template are needed*/ && (piz_default_skip_section ((st), (dict_id)) || \
     (dt_props[dt].is_skip_section && dt_props[dt].is_skip_section ((st), (comp_i), (dict_id), (f), (preprocessing)))))
 
+#define piz_is_skip_zf_dict(dict_id) (z_file->data_type != DT_NONE && (piz_default_skip_section (SEC_DICT, (dict_id)) || \
+    (DTPZ(is_skip_section) && DTPZ(is_skip_section)(SEC_DICT, COMP_NONE, (dict_id), 0, SKIP_PURPOSE_RECON))))
+
 #define piz_is_skip_undicted_section(st) (z_file->data_type != DT_NONE && DTPZ(is_skip_section) && DTPZ(is_skip_section)((st), COMP_NONE, DICT_ID_NONE, 0, false))
 
 extern Dispatcher piz_z_file_initialize (void);
@@ -77,6 +77,14 @@ void profiler_add (ConstVBlockP vb)
     mutex_unlock (profile_mutex);
 }
 
+// PIZ writer thread: called when writing the first data to the txt file
+void profiler_set_time_to_first_byte (void)
+{
+    if (flag.show_time_comp_i == COMP_NONE || profile.time_to_first_byte) return;
+
+    profile.time_to_first_byte = CHECK_TIMER;
+}
+
 static inline uint32_t ms(uint64_t ns) { return (uint32_t)(ns / 1000000);}
 
 rom profiler_print_short (const ProfilerRec *p)
@@ -109,6 +117,9 @@ void profiler_add_evb_and_print_report (void)
 
     iprintf ("Wallclock: %s milliseconds\n", str_int_commas (ms (CHECK_TIMER)).s);
 
+    if (IS_PIZ && profile.time_to_first_byte)
+        iprintf ("Time to first byte: %s milliseconds\n", str_int_commas (ms (profile.time_to_first_byte)).s);
+
     if (IS_ZIP) {
         iprint0 ("GENOZIP main thread (zip_one_file):\n");
         PRINT (ref_load_stored_reference, 1);
@@ -93,6 +93,7 @@ typedef struct {
         struct { int64_t profiled; } count;
         rom next_name, next_subname;
         unsigned num_vbs, max_vb_size_mb, num_txt_files;
+        uint64_t time_to_first_byte; // PIZ: wallclock nanoseconds until the first data was written to the txt file
         float avg_compute_vbs[MAX_NUM_TXT_FILES_IN_ZFILE];  // ZIP/PIZ: average number of compute threads active at any given time during the lifetime of the ZIP/PIZ dispatcher
 } ProfilerRec;
 
@@ -163,6 +164,7 @@ extern void profiler_initialize (void);
 extern void profiler_add (ConstVBlockP vb);
 extern rom profiler_print_short (const ProfilerRec *p);
 extern void profiler_add_evb_and_print_report (void);
+extern void profiler_set_time_to_first_byte (void);
 
 extern void profiler_set_avg_compute_vbs (float avg_compute_vbs);
 extern StrTextSuperLong profiler_get_avg_compute_vbs (char sep);
@@ -22,6 +22,7 @@ static int last_seconds_so_far=-1;
 static rom component_name=NULL;
 static unsigned last_len=0; // so we know how many characters to erase on next update
 static uint32_t last_secs_remaining=0xffff0000;
+static StrTextSuperLong concurrent_prefix = {}; // --concurrent-files: prefix of the current component, printed when finalized
 
 static StrText progress_ellapsed_time (void)
 {
@@ -37,6 +38,12 @@ static void progress_update_status (rom prefix, rom status)
 {
     if (flag.quiet) return;
 
+    // --concurrent-files: other processes share the terminal, so we print only complete lines, in progress_finalize_component
+    if (flag.concurrent_files > 1) {
+        if (prefix && prefix[0]) snprintf (concurrent_prefix.s, sizeof (concurrent_prefix.s), "%s", prefix);
+        return;
+    }
+
     #define eraser "\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b"
     #define spaces "                                                                                                                                                                "
 
@@ -55,7 +62,7 @@ static void progress_update_status (rom prefix, rom status)
 // bring the cursor down to a newline, if needed
 void progress_newline(void) 
 {
-    if (!flag.quiet && !progress_newline_since_update) { 
+    if (!flag.quiet && !progress_newline_since_update && flag.concurrent_files <= 1) { 
         fputc ('\n', stderr);
         progress_newline_since_update = true;
     }
@@ -177,8 +184,14 @@ void progress_finalize_component (rom status)
 {
     if (!flag.quiet
         && component_name /* not already finalized */) {
-        progress_update_status (NULL, status);
-        iprint0 ("\n");
+        
+        if (flag.concurrent_files > 1)
+            iprintf ("%s%s\n", concurrent_prefix.s, status); // single line, so it doesn't interleave with other processes
+        
+        else {
+            progress_update_status (NULL, status);
+            iprint0 ("\n");
+        }
     }
 
     component_name = NULL;
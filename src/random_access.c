@@ -36,6 +36,18 @@ static void BGEN_random_access (BufferP ra_buf)
     }
 }
 
+static void BGEN_random_access_lines (BufferP ra_lines_buf)
+{
+    for_buf (RALinesEntry, ent, *ra_lines_buf) {
+        ent->vblock_i    = BGEN32 (ent->vblock_i);
+        ent->chrom_index = BGEN32 (ent->chrom_index);
+        ent->min_pos     = BGEN64 (ent->min_pos);
+        ent->max_pos     = BGEN64 (ent->max_pos);
+        ent->first_line  = BGEN32 (ent->first_line);
+        ent->last_line   = BGEN32 (ent->last_line);
+    }
+}
+
 static void random_access_show_index (ConstBufferP ra_buf, bool from_zip, Did chrom_did_i, rom msg)
 {
     iprintf ("\n%s:\n", msg);
@@ -103,6 +115,34 @@ void random_access_update_chrom (VBlockP vb, WordIndex chrom_node_index, STRp (c
     }
 }
 
+// ZIP with --sub-vb-index: add the current line's pos range to the sub-VB index. A new entry is started when the chrom 
+// changes or when crossing a boundary of flag.sub_vb_index lines
+static void random_access_update_lines (VBlockP vb, PosType64 min_pos, PosType64 max_pos)
+{
+    if (!flag.sub_vb_index || vb->chrom_node_index == WORD_INDEX_NONE) return;
+
+    RALinesEntry *ent = vb->ra_lines_buf.len ? BLST (RALinesEntry, vb->ra_lines_buf) : NULL;
+
+    if (ent && ent->chrom_index == vb->chrom_node_index && 
+        ent->first_line / flag.sub_vb_index == vb->line_i / flag.sub_vb_index) {
+        
+        ent->last_line = vb->line_i;
+        if (min_pos < ent->min_pos) ent->min_pos = min_pos;
+        if (max_pos > ent->max_pos) ent->max_pos = max_pos;
+    }
+
+    else {
+        buf_alloc (vb, &vb->ra_lines_buf, 1, 64, RALinesEntry, 2, "ra_lines_buf");
+
+        BNXT (RALinesEntry, vb->ra_lines_buf) = (RALinesEntry){ .vblock_i    = vb->vblock_i,
+                                                                .chrom_index = vb->chrom_node_index,
+                                                                .min_pos     = min_pos,
+                                                                .max_pos     = max_pos,
+                                                                .first_line  = vb->line_i,
+                                                                .last_line   = vb->line_i };
+    }
+}
+
 // ZIP only: update the pos in the existing chrom entry
 void random_access_update_pos (VBlockP vb, Did did_i_pos)
 {
@@ -124,6 +164,8 @@ void random_access_update_pos (VBlockP vb, Did did_i_pos)
     else if (this_pos < ra_ent->min_pos) ra_ent->min_pos = this_pos; 
     
     else if (this_pos > ra_ent->max_pos) ra_ent->max_pos = this_pos;
+
+    random_access_update_lines (vb, this_pos, this_pos);
 }
 
 // ZIP: update increment reference pos
@@ -144,6 +186,8 @@ void random_access_update_last_pos (VBlockP vb, PosType64 last_pos)
     
     RAEntry *ra_ent = B(RAEntry, vb->ra_buf, vb->chrom_node_index + 1); // chrom_node_index=-1 goes into entry 0 etc
     if (last_pos > ra_ent->max_pos) ra_ent->max_pos = last_pos;
+
+    random_access_update_lines (vb, last_pos, last_pos);
 }
 
 void random_access_update_first_last_pos (VBlockP vb, WordIndex chrom_node_index, STRp (first_pos), STRp (last_pos))
@@ -166,6 +210,8 @@ void random_access_update_to_entire_chrom (VBlockP vb, PosType64 first_pos_of_ch
     RAEntry *ra_ent = B(RAEntry, vb->ra_buf, vb->chrom_node_index + 1); // chrom_node_index=-1 goes into entry 0 etc
     ra_ent->min_pos = first_pos_of_chrom;
     ra_ent->max_pos = last_pos_of_chrom;
+
+    random_access_update_lines (vb, first_pos_of_chrom, last_pos_of_chrom);
 }
 
 // called by ZIP compute thread, while holding the z_file mutex: merge in the VB's ra_buf in the global z_file one
@@ -210,6 +256,20 @@ void random_access_merge_in_vb (VBlockP vb)
             dst_ra->chrom_index = WORD_INDEX_NONE; // to be updated in random_access_finalize_entries()
     }
 
+    // sub-VB index: same, but note that it never contains WORD_INDEX_NONE chroms 
+    if (vb->ra_lines_buf.len) {
+        buf_alloc (evb, &z_file->ra_lines_buf, vb->ra_lines_buf.len, 0, RALinesEntry, 2, "z_file->ra_lines_buf"); 
+
+        for_buf (RALinesEntry, src, vb->ra_lines_buf) {
+            WordIndex wi = node_index_to_word_index (vb, chrom_ctx, src->chrom_index);
+            if (wi == WORD_INDEX_NONE) continue; // this contig was canceled by seg_rollback
+
+            RALinesEntry *dst = &BNXT (RALinesEntry, z_file->ra_lines_buf);
+            *dst = *src;
+            dst->chrom_index = wi;
+        }
+    }
+
     COPY_TIMER(random_access_merge_in_vb);
 
     mutex_unlock (ra_mutex);
@@ -279,6 +339,33 @@ void random_access_finalize_entries (BufferP ra_buf)
     COPY_TIMER_EVB (random_access_finalize_entries);
 }
 
+static int random_access_lines_sorter (const void *a_, const void *b_)
+{
+    const RALinesEntry *a = (const RALinesEntry *)a_, *b = (const RALinesEntry *)b_;
+
+    if (a->vblock_i != b->vblock_i) return (a->vblock_i > b->vblock_i) ? 1 : -1;
+    return (a->first_line > b->first_line) ? 1 : (a->first_line < b->first_line) ? -1 : 0;
+}
+
+// ZIP main thread: sort sub-VB index by VB (VBs are merged out of order) and compress it into a SEC_RA_LINES section
+void random_access_compress_lines (void)
+{
+    // note: not for files with generated components, as lines are moved between VBs
+    if (!z_file->ra_lines_buf.len || z_has_gencomp) return;
+
+    qsort (STRb(z_file->ra_lines_buf), sizeof (RALinesEntry), random_access_lines_sorter);
+
+    BGEN_random_access_lines (&z_file->ra_lines_buf);
+    z_file->ra_lines_buf.len *= sizeof (RALinesEntry);
+
+    Codec codec = codec_assign_best_codec (evb, NULL, &z_file->ra_lines_buf, SEC_RA_LINES);
+    if (codec == CODEC_UNKNOWN) codec = CODEC_NONE; // really small
+
+    zfile_compress_section_data_ex (evb, NULL, SEC_RA_LINES, &z_file->ra_lines_buf, 0,0, codec, (SectionFlags){}, NULL); 
+
+    buf_free (z_file->ra_lines_buf); // not needed anymore
+}
+
 Codec random_access_compress (ConstBufferP ra_buf_, SectionType sec_type, Codec codec, rom msg)
 {
     START_TIMER;
@@ -344,6 +431,60 @@ bool random_access_is_vb_included (VBIType vb_i)
     return false; 
 }
 
+// PIZ main thread: check if any of the ranges of the VB satisfies is_included (used by --filter)
+bool random_access_is_vb_included_by (VBIType vb_i, RaIsIncludedFunc is_included)
+{
+    const RAEntry *ra = random_access_get_first_ra_of_vb (vb_i);
+    if (!ra) return false; // no RA data in this VB, eg all lines are unmapped 
+
+    for (; ra < BAFT (RAEntry, z_file->ra_buf) && ra->vblock_i == vb_i; ra++)
+        if (is_included (ra->chrom_index, ra->min_pos, ra->max_pos))
+            return true;
+
+    return false;
+}
+
+static BINARY_SEARCHER (random_access_get_first_ra_lines_of_vb_do, RALinesEntry, VBIType, vblock_i, false, IfNotExact_ReturnNULL)
+
+// PIZ main thread: load the sub-VB index, if the file has one and we need it
+void random_access_load_ra_lines_section (void)
+{
+    if (!random_access_has_filter() || z_has_gencomp || flag.interleaved || !VER2(15,74)) return; // SEC_RA_LINES introduced 15.0.74
+
+    Section sec = sections_first_sec (SEC_RA_LINES, SOFT_FAIL);
+    if (!sec) return; // file was compressed without --sub-vb-index
+
+    zfile_get_global_section (SectionHeader, sec, &z_file->ra_lines_buf, "z_file->ra_lines_buf");
+
+    z_file->ra_lines_buf.len /= sizeof (RALinesEntry);
+    BGEN_random_access_lines (&z_file->ra_lines_buf);
+}
+
+// PIZ compute thread: using the sub-VB index, set the range of lines of the VB that might intersect --regions:
+// lines from vb->recon_lines_limit onwards are dropped without being reconstructed, while lines before vb->recon_lines_first 
+// are dropped without consulting regions (they must still be reconstructed, as they advance the contexts' iterators and 
+// lookback/history state needed by subsequent lines). Both are left 0 if unknown (i.e. all lines need to be reconstructed)
+void random_access_set_recon_lines_range (VBlockP vb)
+{
+    vb->recon_lines_first = vb->recon_lines_limit = 0;
+
+    if (!z_file->ra_lines_buf.len || vb->comp_i != COMP_MAIN) return;
+
+    const RALinesEntry *ent = binary_search (random_access_get_first_ra_lines_of_vb_do, RALinesEntry, z_file->ra_lines_buf, vb->vblock_i);
+    if (!ent) return;
+
+    uint32_t first = 0xffffffff, limit = 0;
+    for ( ; ent < BAFT (RALinesEntry, z_file->ra_lines_buf) && ent->vblock_i == vb->vblock_i; ent++) 
+        if (regions_get_ra_intersection (ent->chrom_index, ent->min_pos, ent->max_pos)) {
+            first = MIN_(first, ent->first_line);
+            limit = MAX_(limit, ent->last_line + 1); 
+        }
+
+    // note: VB is included, so we expect at least one intersection. If not - we reconstruct just one line.
+    vb->recon_lines_first = limit ? first : 0;
+    vb->recon_lines_limit = limit ? limit : 1; 
+}
+
 // FASTA PIZ
 bool random_access_does_last_chrom_continue_in_next_vb (VBIType vb_i)
 {
@@ -398,4 +539,20 @@ void random_access_get_ra_info (VBIType vblock_i, WordIndex *chrom_index, PosTyp
     *chrom_index = ra->chrom_index;
     *min_pos     = ra->min_pos;
     *max_pos     = ra->max_pos;
+}
+
+// PIZ: get the pos range of a chrom in a VB. returns false if the VB has no RAEntry for this chrom
+bool random_access_get_vb_chrom_range (VBIType vblock_i, WordIndex chrom_index, PosType64 *min_pos, PosType64 *max_pos)
+{
+    const RAEntry *ra = random_access_get_first_ra_of_vb (vblock_i);
+    if (!ra) return false;
+
+    for (; ra < BAFT (RAEntry, z_file->ra_buf) && ra->vblock_i == vblock_i; ra++)
+        if (ra->chrom_index == chrom_index) {
+            *min_pos = ra->min_pos;
+            *max_pos = ra->max_pos;
+            return true;
+        }
+
+    return false;
 }
\ No newline at end of file
@@ -27,13 +27,19 @@ extern void random_access_merge_in_vb (VBlockP vb);
 extern void random_access_finalize_entries (BufferP ra_buf);
 extern Codec random_access_compress (ConstBufferP ra_buf, SectionType sec_type, Codec codec, rom msg);
 extern void random_access_get_ra_info (VBIType vblock_i, WordIndex *chrom_index, PosType64 *min_pos, PosType64 *max_pos);
+extern void random_access_compress_lines (void);
 
 // PIZ
 extern bool random_access_has_filter (void);
 extern bool random_access_is_vb_included (VBIType vb_i);
+typedef bool (*RaIsIncludedFunc)(WordIndex chrom_index, PosType64 min_pos, PosType64 max_pos);
+extern bool random_access_is_vb_included_by (VBIType vb_i, RaIsIncludedFunc is_included);
 extern uint32_t random_access_num_chroms_start_in_this_vb (VBIType vb_i);
 extern void random_access_alloc_ra_buf (VBlockP vb, WordIndex chrom_node_index);
 extern void random_access_load_ra_section (SectionType section_type, Did chrom_did_i, BufferP ra_buf, rom buf_name, rom show_index_msg);
+extern void random_access_load_ra_lines_section (void);
+extern void random_access_set_recon_lines_range (VBlockP vb);
+extern bool random_access_get_vb_chrom_range (VBIType vblock_i, WordIndex chrom_index, PosType64 *min_pos, PosType64 *max_pos);
 
 // PIZ - FASTA
 extern bool random_access_does_last_chrom_continue_in_next_vb (VBIType vb_i);
@@ -15,6 +15,7 @@
 #include <sys/ipc.h>
 #include <sys/shm.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #endif
 #ifdef __APPLE__
 #include <mach/mach.h>
@@ -142,6 +143,155 @@ void noreturn ref_cache_hold (rom handle_str)
     exit (0);
 }
 
+//----------------------------------------------------------------------------------------------------
+// Reference image: a file with the same layout as the cache, created with --ref-image. Subsequent runs
+// mmap it read-only instead of decompressing the reference - it is shared between processes via the
+// page cache, doesn't require SysV shm, and survives reboots.
+//----------------------------------------------------------------------------------------------------
+
+#define DECL_IMAGE_FN char image_fn[strlen (gref.filename) + 8]; snprintf (image_fn, sizeof (image_fn), "%s.img", gref.filename)
+
+static void ref_image_unmap (void)
+{
+#ifndef _WIN32
+    munmap (gref.image, gref.image_map_size);
+#else
+    UnmapViewOfFile (gref.image);
+#endif
+    gref.image = NULL;
+}
+
+// returns true if an up-to-date image was mapped, in which case the cache is CACHE_READY
+static bool ref_image_map (uint64_t genome_size, uint64_t refhash_size)
+{
+    DECL_IMAGE_FN;
+
+    struct stat64 ref_st, image_st;
+    if (stat64 (image_fn, &image_st) || stat64 (gref.filename, &ref_st) || image_st.st_size < REF_IMAGE_HEADER_SIZE) 
+        return false; // no image
+
+#ifndef _WIN32
+    int fd = open (image_fn, O_RDONLY);
+    if (fd < 0) return false;
+
+    void *map = mmap (NULL, image_st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close (fd); // the mapping remains valid after the file is closed
+    ASSRET (map != MAP_FAILED, false, "FYI: Reference image %s is not used: mmap failed: %s", image_fn, strerror (errno));
+
+#else
+    HANDLE file = CreateFileA (image_fn, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    HANDLE mapping = CreateFileMappingA (file, NULL, PAGE_READONLY, 0, 0, NULL);
+    void *map = mapping ? MapViewOfFile (mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (mapping) CloseHandle (mapping); // the view remains valid after the handles are closed
+    CloseHandle (file);
+    ASSRET (map, false, "FYI: Reference image %s is not used: MapViewOfFile failed: %s", image_fn, str_win_error());
+#endif
+
+    gref.image = (RefImageHeader *)map;
+    gref.image_map_size = image_st.st_size;
+    RefImageHeader *h = gref.image;
+
+    rom stale = !memcmp (h->signature, REF_IMAGE_SIGNATURE, sizeof (REF_IMAGE_SIGNATURE)) && h->magic == GENOZIP_MAGIC ? NULL : "not a reference image";
+    if (!stale && h->genozip_version != code_version_major())                       stale = "created by a different version of Genozip";
+    if (!stale && h->image_size != image_st.st_size)                                  stale = "truncated";
+    if (!stale && (h->ref_file_size != ref_st.st_size || h->ref_file_mtime != ref_st.st_mtime)) stale = "reference file has changed";
+    if (!stale && (!digest_is_equal (h->genome_digest, gref.genome_digest) || h->genome_nbases != gref.genome_nbases || 
+                   h->refhash_size != refhash_size || h->image_size != REF_IMAGE_HEADER_SIZE + genome_size + refhash_size))
+        stale = "doesn't match the reference file";
+
+    if (stale) {
+        WARN_ONCE ("FYI: Reference image %s is not used: %s.%s", image_fn, stale, flag.ref_image ? " It will be re-created." : " Re-create it with --ref-image.");
+        ref_image_unmap();
+        return false;
+    }
+
+    gref.cache       = (RefCache *)((char *)map + REF_IMAGE_HEADER_SIZE - sizeof (RefCache));
+    gref.cache_shm   = CACHE_SHM_NONE;
+    gref.cache_state = CACHE_READY;
+
+    if (flag.show_cache) iprintf ("show-cache: mapped reference image %s (%"PRIu64" bytes) read-only. READY.\n", image_fn, h->image_size);
+    return true;
+}
+
+static bool ref_image_write (FILE *file, const void *data, uint64_t len)
+{
+    // write in blocks (Windows hangs if the block is too big, a few GB)
+    for (uint64_t written=0; written < len; written += 1 MB) {
+        uint64_t this_len = MIN_(1 MB, len - written);
+        if (fwrite ((rom)data + written, 1, this_len, file) != this_len) return false;
+    }
+
+    return true;
+}
+
+// called after genome and refhash are loaded and verified, if --ref-image and the image was not already used
+void ref_image_create (void)
+{
+    if (gref.image) return; // image already exists and is up to date
+
+    DECL_IMAGE_FN;
+    uint64_t genome_size  = roundup_bits2bytes64 (gref.genome_nbases * 2);
+    uint64_t refhash_size = refhash_buf.len;
+
+    struct stat64 ref_st;
+    ASSERT (!stat64 (gref.filename, &ref_st), "stat64 failed on '%s': %s", gref.filename, strerror (errno));
+
+    char header[REF_IMAGE_HEADER_SIZE] = {};
+    RefImageHeader *h = (RefImageHeader *)header;
+    RefCache *cache = (RefCache *)&header[REF_IMAGE_HEADER_SIZE - sizeof (RefCache)];
+
+    *h = (RefImageHeader){ .signature       = REF_IMAGE_SIGNATURE,
+                           .magic           = GENOZIP_MAGIC,
+                           .genozip_version = code_version_major(),
+                           .genome_digest   = gref.genome_digest,
+                           .genome_nbases   = gref.genome_nbases,
+                           .refhash_size    = refhash_size,
+                           .image_size      = REF_IMAGE_HEADER_SIZE + genome_size + refhash_size,
+                           .ref_file_size   = ref_st.st_size,
+                           .ref_file_mtime  = ref_st.st_mtime };
+
+    *cache = (RefCache){ .magic           = GENOZIP_MAGIC,
+                         .genozip_version = code_version_major(),
+                         .shm_size        = sizeof (RefCache) + genome_size + refhash_size,
+                         .is_populated    = true };
+    filename_base (gref.filename, false, "<unknown>", cache->ref_basename, sizeof (cache->ref_basename));
+
+    // we write to a temporary file and rename, so that an image in its final name is guaranteed to be complete
+    char tmp_fn[sizeof (image_fn) + 16];
+    snprintf (tmp_fn, sizeof (tmp_fn), "%s.%u.tmp", image_fn, (unsigned)getpid());
+
+    FILE *file = fopen (tmp_fn, "wb");
+    ASSERTW (file, "FYI: Failed to create reference image %s: %s", tmp_fn, strerror (errno));
+    if (!file) return;
+
+    bool success = ref_image_write (file, header, REF_IMAGE_HEADER_SIZE) &&
+                   ref_image_write (file, gref.genome_buf.data, genome_size) &&
+                   ref_image_write (file, refhash_buf.data, refhash_size);
+    success = !fclose (file) && success;
+
+    if (success) {
+        file_remove (image_fn, true);
+        success = !rename (tmp_fn, image_fn);
+    }
+
+    if (success) {
+        if (!flag.quiet) iprintf ("Created reference image %s. Subsequent runs with this reference will map it instead of loading the reference.\n", image_fn);
+    }
+    else {
+        WARN ("FYI: Failed to create reference image %s: %s", image_fn, strerror (errno));
+        file_remove (tmp_fn, true);
+    }
+}
+
+// removes a bad image (the caller is expected to abort)
+void ref_image_remove (void)
+{
+    DECL_IMAGE_FN;
+    file_remove (image_fn, true);
+}
+
 // maps cache to reference if shm exists, or creates a new shm if it doesn't, or creates genome in memory if no shm
 // returns true if ref_cache can be used
 bool ref_cache_initialize_genome (void)
@@ -156,6 +306,12 @@ bool ref_cache_initialize_genome (void)
     ASSERT0 (flag.reading_reference && z_file && z_file->file, "not reading reference");
 
     uint64_t shm_size = sizeof (RefCache) + genome_size + refhash_size;
+
+    // a pre-expanded reference image, if one exists and is up to date, takes precedence over shm
+    if (!flag.removing_cache && ref_image_map (genome_size, refhash_size)) {
+        gref.genome = (BitsP)&gref.genome_buf;
+        goto cache_ok;
+    }
     
 #ifndef _WIN32
     key_t key = ftok (gref.filename, 20010802);
@@ -417,11 +573,17 @@ void ref_cache_detach (void)
         gref.genome_buf.type == BUF_SHM || refhash_buf.type == BUF_SHM) // actually detach only when both genome_buf and refhash are freed
         return;
 
+    if (gref.image) 
+        ref_image_unmap();
+
 #ifndef _WIN32 
-    shmdt (gref.cache);
+    else
+        shmdt (gref.cache);
 #else
-    UnmapViewOfFile (gref.cache);
-    CloseHandle (gref.cache_shm);
+    else {
+        UnmapViewOfFile (gref.cache);
+        CloseHandle (gref.cache_shm);
+    }
 #endif
 
     gref.cache = NULL;
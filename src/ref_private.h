@@ -37,9 +37,27 @@ typedef struct ref_cache {
     char genome_data[0];
 } RefCache;
 
+// a reference image is a file consisting of a RefImageHeader, and a RefCache placed such that it ends at REF_IMAGE_HEADER_SIZE, 
+// followed by the genome and the refhash - so that the genome is page-aligned and the image has the same layout as the cache
+#define REF_IMAGE_HEADER_SIZE 4096
+#define REF_IMAGE_SIGNATURE "GENOIMG"
+typedef struct {
+    char signature[8];            // REF_IMAGE_SIGNATURE
+    uint32_t magic;               // GENOZIP_MAGIC
+    uint8_t genozip_version;      // Genozip version that created this image
+    uint8_t unused[3];
+    Digest genome_digest;         // genome digest of the reference file from which this image was created
+    uint64_t genome_nbases;
+    uint64_t refhash_size;
+    uint64_t image_size;
+    uint64_t ref_file_size;       // size and modification time of the reference file - if the reference file changes, the image is stale
+    int64_t ref_file_mtime;
+} RefImageHeader;
+
 typedef struct RefStruct {
     // file 
     rom filename;                 // filename of external reference file
+    rom server_filename;          // genozip --server job: filename of the reference loaded by the server, until the job sets its reference
     Digest genome_digest;         // v15: digest of genome as it is loaded to memory. Up to v14: MD5 of original FASTA file (buggy)
     bool is_adler;                // true if genome_digest is Adler32, false if it MD5
     uint8_t genozip_version;      // Genozip version of the external reference file
@@ -94,6 +112,10 @@ typedef struct RefStruct {
 #endif
     RefCache *cache; // cache consists of a block memory containing a RefCache struct, followed by the genome, follewed by the refhash
 
+    // reference image: when mmap'ed, cache points into it and cache_state is CACHE_READY
+    RefImageHeader *image;
+    uint64_t image_map_size;
+
 } RefStruct;
 
 extern RefStruct gref;
@@ -117,3 +139,5 @@ extern void ref_make_calculate_digest (void);
 extern bool ref_cache_initialize_genome (void);
 extern void ref_cache_done_populating (void);
 extern void ref_cache_remove_do (bool cache_exists, bool verbose);
+extern void ref_image_create (void);
+extern void ref_image_remove (void);
@@ -707,6 +707,12 @@ bool ref_load_stored_reference (void)
                 ABORT ("Bad reference file: In-memory digest of genome is %s, different than calculated by make-reference: %s",
                        digest_display_(digest, gref.is_adler).s, digest_display_(gref.genome_digest, gref.is_adler).s);
 
+            // case: bad reference image - eg corrupted on disk
+            else if (gref.image) {
+                ref_image_remove();
+                ABORTINP ("Error: Found bad reference image %s.img. It has now been removed. Please try again.", gref.filename);
+            }
+
             // case: bad existing cache. this should never happen as this condition ^ should prevent cache from being
             // marked as "is_populated". This is just for extra safety.
             else {
@@ -739,6 +745,12 @@ bool ref_load_stored_reference (void)
         refhash_update_layers (delta_bytes);
     }
 
+    // --ref-image: materialize the genome and refhash into an image file that subsequent runs can mmap
+    if (flag.ref_image && external && flag.reading_reference && !flag.only_headers) {
+        refhash_load();
+        ref_image_create();
+    }
+
     // case: using REF_EXT_STORE with a cached reference file: generate a private genome, as it will be compacted for writing to SEC_REFERENCE
     if (flag.reading_reference && IS_REF_EXT_STORE && gref.genome_buf.type == BUF_SHM) {
         buf_free (gref.genome_buf); // free SHM buffer
@@ -1261,8 +1273,7 @@ void ref_set_reference (rom filename, ReferenceType ref_type, bool is_explicit)
     else 
         filename_len = strlen (filename);
 
-    static int num_explicit = 0; // user can have up to 1 --reference arguments
-    ASSINP0 (!is_explicit || (++num_explicit <= 1), "More than one --reference argument");
+    ASSINP0 (!is_explicit || !flag.explicit_ref, "More than one --reference argument"); // user can have up to 1 --reference arguments
     
     // case: pizzing subsequent files with implicit reference (reference from file header)
     if (!is_explicit && gref.filename) {
@@ -1272,6 +1283,14 @@ void ref_set_reference (rom filename, ReferenceType ref_type, bool is_explicit)
         ref_destroy_reference();
     }
 
+    // case: genozip --server job: reuse the reference loaded by the server if it is the same file, otherwise discard it
+    if (gref.server_filename) {
+        bool same_ref = !strcmp (filename, gref.server_filename);
+        FREE (gref.server_filename);
+
+        if (!same_ref) ref_destroy_reference();
+    }
+
     flag.reference    = ref_type; 
     flag.explicit_ref = is_explicit;
 
@@ -1283,6 +1302,13 @@ void ref_set_reference (rom filename, ReferenceType ref_type, bool is_explicit)
         str_replace_letter ((char*)gref.filename, filename_len, '\\', '/');
 }
 
+// genozip --server job process: the reference loaded by the server remains in memory until the job sets its own reference
+void ref_server_job_initialize (void)
+{
+    gref.server_filename = gref.filename;
+    gref.filename = NULL;
+}
+
 // called when loading an external reference
 void ref_set_ref_file_info (Digest genome_digest, bool is_adler, rom fasta_name, uint8_t genozip_version)
 {
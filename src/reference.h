@@ -65,6 +65,7 @@ extern bool ref_load_stored_reference (void);
 extern bool ref_is_loaded (void);
 extern bool ref_is_external_loaded (void);
 extern void ref_set_reference (rom filename, ReferenceType ref_type, bool is_explicit);
+extern void ref_server_job_initialize (void);
 extern void ref_set_ref_file_info (Digest genome_digest, bool is_adler, rom fasta_name, uint8_t genozip_version);
 extern void ref_unload_reference (void);
 extern void ref_destroy_reference (void);
@@ -220,6 +220,13 @@ void regions_add_by_file (rom regions_filename)
     regions_data_from_file = &data; // so we can destroy it if needed
 }
 
+// genocat --shard-by=chrom: add a region of an entire chrom. The name is not parsed, as chrom names may contain eg ':' or '-'
+void regions_add_chrom (rom chrom)
+{
+    buf_alloc (evb, &regions_buf, 1, 100, Region, 2, "regions_buf");
+    BNXT (Region, regions_buf) = (Region){ .chrom = chrom, .start_pos = 0, .end_pos = MAX_POS };
+}
+
 // convert the list of regions as parsed from --regions, to an array of chregs - one for each chromosome.
 // 1. convert the chrom string to a chrom word index
 // 2. for "all chrom" regions - include them in all chregs
@@ -12,6 +12,7 @@
 
 extern void regions_add (rom reg_str);
 extern void regions_add_by_file (rom regions_filename);
+extern void regions_add_chrom (rom chrom);
 extern void regions_make_chregs (ContextP chrom_ctx);
 extern void regions_transform_negative_to_positive_complement(void);
 extern bool regions_get_ra_intersection (WordIndex chrom_node_index, PosType64 min_pos, PosType64 max_pos);
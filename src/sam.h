@@ -715,6 +715,7 @@ extern StrTextSuperLong cram_get_samtools_option_T (void);
 // HEADER stuff
 extern bool sam_header_inspect (VBlockP txt_header_vb, BufferP txt_header, struct FlagsTxtHeader txt_header_flags);
 extern void sam_header_finalize (void);
+extern void sam_header_piz_set_SO_coordinate (BufferP txtheader_buf);
 extern void sam_zip_end_of_z (void);
 extern bool is_sam (STRp(header), bool *need_more);
 extern bool is_bam (STRp(header), bool *need_more);
@@ -773,3 +773,55 @@ TXTHEADER_TRANSLATOR (sam_header_sam2bam)
     else if (ref_num_contigs()) 
         foreach_contig (ref_get_ctgs(), sam_header_sam2bam_ref_info, txtheader_buf);
 }
+
+// genocat --sort: declare the output as coordinate-sorted in the @HD line, adding an @HD line if there isn't one.
+// Called after translation, so txtheader_buf is a SAM header if outputting SAM, or a BAM header if outputting BAM.
+void sam_header_piz_set_SO_coordinate (BufferP txtheader_buf)
+{
+    VBlockP vb = txtheader_buf->vb;
+    uint32_t text_start = OUT_DT(BAM) ? 8 : 0; // BAM: text follows magic and l_text
+    
+    ASSERT (txtheader_buf->len >= text_start, "txtheader_buf->len=%"PRIu64" is too short", txtheader_buf->len);
+
+    uint32_t l_text = OUT_DT(BAM) ? LTEN32 (*B32 (*txtheader_buf, 1)) : txtheader_buf->len32;
+    rom text = Bc (*txtheader_buf, text_start);
+    rom first_nl = l_text ? memchr (text, '\n', l_text) : NULL;
+    rom nl = str_isprefix_(text, l_text, _S("@HD\t")) ? first_nl : NULL;
+    bool is_crlf = first_nl && first_nl > text && first_nl[-1] == '\r'; // keep the header's line endings
+
+    // the parts of the text to be kept before and after the SO value
+    rom before_so_end = text, after_so_start = text;
+    rom insert = is_crlf ? "@HD\tVN:1.6\tSO:coordinate\r\n" : "@HD\tVN:1.6\tSO:coordinate\n"; // no @HD line - add one
+
+    if (nl) {
+        SAFE_NUL (nl);
+        rom so = strstr (text, "\tSO:");
+        SAFE_RESTORE;
+
+        // case: @HD has SO - replace its value 
+        if (so) {
+            before_so_end = after_so_start = so + 4;
+            while (*after_so_start != '\t' && *after_so_start != '\n' && *after_so_start != '\r') after_so_start++;
+            insert = "coordinate";
+        }
+
+        // case: @HD doesn't have SO - add it at the end of the line
+        else {
+            before_so_end = after_so_start = (*(nl-1) == '\r') ? nl-1 : nl; 
+            insert = "\tSO:coordinate";
+        }
+    }
+    
+    ASSERTNOTINUSE (vb->scratch);
+    buf_alloc (vb, &vb->scratch, 0, txtheader_buf->len + strlen (insert), char, 0, "scratch");
+
+    buf_add_more (vb, &vb->scratch, txtheader_buf->data, before_so_end - txtheader_buf->data, "scratch"); // BAM magic and l_text, and the text up to the SO value
+    buf_add_more (vb, &vb->scratch, insert, strlen (insert), "scratch");
+    buf_add_more (vb, &vb->scratch, after_so_start, BAFTc(*txtheader_buf) - after_so_start, "scratch"); // rest of the text, and BAM references
+
+    if (OUT_DT(BAM))
+        *B32 (vb->scratch, 1) = LTEN32 (l_text + (vb->scratch.len32 - txtheader_buf->len32)); // update l_text
+
+    buf_copy (vb, txtheader_buf, &vb->scratch, char, 0, 0, "txt_data");
+    buf_free (vb->scratch);
+}
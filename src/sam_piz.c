@@ -18,6 +18,7 @@
 #include "codec.h"
 #include "qname_filter.h"
 #include "huffman.h"
+#include "arrow.h"
 #include "libdeflate_1.19/libdeflate.h"
 #include "htscodecs/arith_dynamic.h"
 
@@ -219,15 +220,21 @@ IS_SKIP (sam_piz_is_skip_section)
     bool is_prim = (comp_i == SAM_COMP_PRIM) && !preproc;
     bool is_main = (comp_i == SAM_COMP_MAIN);
     bool cov     = flag.collect_coverage;
-    bool cnt     = flag.count && !flag.grep;  // we skip if we're only counting, but not also if based on --count, but not if --grep, because grepping requires full reconstruction
+    bool cnt     = flag.count && !flag.grep && !flag.filter;  // we skip if we're only counting, but not also if based on --count, but not if --grep, because grepping requires full reconstruction
     bool deep_fq = OUT_DT(FASTQ) && (comp_i <= SAM_COMP_DEPN); // genocat of fastq data from a Deep file
 
+    // --arrow: we skip contexts of fields that are not exported, and on which exported fields don't depend
+    bool arw      = flag.arrow && !arrow_piz_needs_full_line && (ST(B250) || ST(LOCAL)); // note: columns are known only after reading the global area
+    bool arw_aux  = arw && !arrow_piz_has_type2_column(); // AUX fields might depend on any of QUAL, SEQ or other AUX fields
+    bool arw_qual = arw_aux && !arrow_piz_is_column ((DictId){ .num = _SAM_QUAL });
+    bool arw_seq  = arw_qual && !arrow_piz_is_column ((DictId){ .num = _SAM_SQBITMAP }); // QUAL codecs might need the textual SEQ
+
     #define has_sa (ZCTX(OPTION_SA_Z)->z_data_exists > 0)
     #define is_aux dict_id_is_aux_sf(dict_id) // #define so calculated only when (rarely) needed
 
     switch (dict_id.num) {
         case _SAM_SQBITMAP :
-            SKIPIFF ((cov || cnt) && !flag.bases && 
+            SKIPIFF ((((cov || cnt) && !flag.bases) || arw_seq) && 
                      !has_sa); // if this file has SA:Z: needed by MD:Z which is needed by NM:i which is needed by SA:Z
             
         case _SAM_NONREF   : case _SAM_NONREF_X : case _SAM_GPOS     : case _SAM_STRAND :
@@ -235,25 +242,27 @@ IS_SKIP (sam_piz_is_skip_section)
         case _SAM_SEQINS_A : case _SAM_SEQINS_C : case _SAM_SEQINS_G : case _SAM_SEQINS_T : 
             SKIPIF (is_prim); // in PRIM, we skip sections that we used for loading the SA Groups in sam_piz_load_sags, but not needed for reconstruction
                            // (during PRIM SA Group loading, skip function is temporarily changed to sam_plsg_only). see also: sam_load_groups_add_grps
-            SKIPIFF ((cov || cnt) && !flag.bases && !has_sa);
+            SKIPIFF ((((cov || cnt) && !flag.bases) || arw_seq) && !has_sa);
 
         case _SAM_QUAL  : case _SAM_DOMQRUNS  : case _SAM_QUALMPLX  : case _SAM_DIVRQUAL  :
         case _SAM_CQUAL : case _SAM_CDOMQRUNS : case _SAM_CQUALMPLX : case _SAM_CDIVRQUAL : 
             SKIPIF (is_prim);                                         
             SKIPIF (deep_fq && (flag.seq_only || flag.header_only_fast));
-            SKIPIFF (cov || cnt);
+            SKIPIFF (cov || cnt || arw_qual);
 
         case _OPTION_np_i : case _OPTION_ec_f : // np is needed for reconstruting QUAL (PACB codec), and ec is needed to rereconstruct np
         case _OPTION_iq_sq_dq : case SAM_QUAL_PACBIO_DIFF: // iq_sq_dq, if it exists, is combined with DIFF to construct QUAL
-            SKIPIFF (cov || cnt);
+            SKIPIFF (cov || cnt || arw_qual);
 
         case _SAM_TLEN    :
         case _SAM_BAM_BIN :
         case _SAM_EOL     :
             SKIPIF (deep_fq);
+            SKIPIF (arw && !arrow_piz_is_column (dict_id));
             // fallthrough
 
         case _SAM_QUALSA  :
+            SKIPIF (arw_qual);
             SKIPIFF (preproc || cov || (cnt && !(flag.bases && (OUT_DT(BAM) || OUT_DT(CRAM)))));
 
         case _SAM_Q1NAME : case _SAM_QNAMESA :
@@ -275,7 +284,7 @@ IS_SKIP (sam_piz_is_skip_section)
         case _OPTION_AS_i  : // we don't skip AS in preprocessing unless it is entirely skipped
             SKIPIF (preproc && !segconf.sag_has_AS);
             SKIPIF (deep_fq);
-            SKIPIFF ((cov || cnt) && is_aux);
+            SKIPIFF ((cov || cnt || arw_aux) && is_aux);
   
         // data stored in SAGs - needed for reconstruction, and also for preproccessing
         case _OPTION_NH_i: 
@@ -285,7 +294,7 @@ IS_SKIP (sam_piz_is_skip_section)
         case _OPTION_CY_Z: case _OPTION_CY_ARR: case _OPTION_CY_DIVRQUAL: case _OPTION_CY_DOMQRUNS: case _OPTION_CY_QUALMPLX:
         case _OPTION_QT_Z: case _OPTION_QT_ARR: case _OPTION_QT_DIVRQUAL: case _OPTION_QT_DOMQRUNS: case _OPTION_QT_QUALMPLX:
         case _OPTION_QX_Z:                      case _OPTION_QX_DIVRQUAL: case _OPTION_QX_DOMQRUNS: case _OPTION_QX_QUALMPLX:
-            SKIPIFF (deep_fq || cov || cnt);
+            SKIPIFF (deep_fq || cov || cnt || arw_aux);
 
         case _SAM_FQ_AUX   : KEEPIFF (OUT_DT(FASTQ) || flag.collect_coverage);
         
@@ -317,6 +326,7 @@ IS_SKIP (sam_piz_is_skip_section)
         
         default            : other :
             SKIPIF ((cov || cnt) && is_aux && !(is_dict && dict_id.num == _OPTION_OC_Z/*dict-alias of MC0_Z needed to reconstruct CIGAR*/));
+            SKIPIF (arw_aux && is_aux && dict_id.num != _OPTION_MQ_i && dict_id.num != _OPTION_xq_i); // MQ:i and xq:i are needed to reconstruct MAPQ
             SKIPIF (deep_fq && is_aux && !is_dict); // Dictionaries might be needed for FASTQ AUX fields
             SKIPIF (deep_fq && is_dict && is_aux && !f.dictionary.deep_fastq); // outputting FASTQ: we don't need SAM-only AUX dicts
             SKIPIF (is_dict && !flag.deep && is_aux && f.dictionary.deep_fastq && !f.dictionary.deep_sam);   // Deep file, but we are not reconstructed FQ (hence !flag.deep) - we don't need FASTQ-only AUX dicts
@@ -675,6 +685,23 @@ TXTHEADER_TRANSLATOR (txtheader_sam2fq)
     txtheader_buf->len = 0; // fastq has no header
 }
 
+// --sort: capture the coordinate by which the writer sorts this line: RNAME's word index (which is also the BAM ref_id - 
+// see sam_piz_sam2bam_RNAME) in the high 32 bits and POS in the low 32 bits. Unplaced reads (RNAME="*") sort last, as in samtools.
+static inline void sam_piz_capture_sort_key (VBlockSAMP vb)
+{
+    ContextP ctx = CTX(SAM_RNAME);
+
+    STR0(rname);
+    ctx_get_snip_by_word_index (ctx, ctx->last_value.i, rname);
+
+    uint32_t ref_id = IS_ASTERISK(rname) ? 0xffffffff : (uint32_t)ctx->last_value.i;
+
+    buf_alloc (vb, &vb->sort_keys, 0, vb->lines.len32, uint64_t, 0, "sort_keys");
+    vb->sort_keys.len32 = vb->line_i + 1;
+    
+    *B64(vb->sort_keys, vb->line_i) = ((uint64_t)ref_id << 32) | (uint32_t)vb->last_int(SAM_POS);
+}
+
 // filtering during reconstruction: called by container_reconstruct for each sam alignment (repeat)
 CONTAINER_CALLBACK (sam_piz_container_cb)
 {    
@@ -693,6 +720,9 @@ CONTAINER_CALLBACK (sam_piz_container_cb)
             BAMAlignmentFixedP alignment = (BAMAlignmentFixedP)Btxt (vb->line_start);
             alignment->block_size = LTEN32 (Ltxt - vb->line_start - sizeof (uint32_t)); // block_size doesn't include the block_size field itself
         }
+
+        if (flag.sort)
+            sam_piz_capture_sort_key (vb);
         
         // --FLAG
         if (flag.sam_flag_filter) {
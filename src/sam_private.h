@@ -302,6 +302,7 @@ typedef struct VBlockSAM {
     Buffer sag_grps;               // ZIP/PIZ: an SA group is a group of alignments, including the primary alignment
     Buffer sag_alns;               // ZIP/PIZ: array of {RNAME, STRAND, POS, CIGAR, NM, MAPQ} of the alignment
     Buffer qname_count;            // ZIP: count the number of each qname_hash in this VB (if needed)
+    TxtWord vb_first_qname, vb_last_qname; // ZIP MAIN: SAG_BY_FLAG single-pass: QNAMEs of first and last lines of the VB - these sags might span VBs
 
     uint32_t comp_qual_len;        // ZIP PRIM: compressed length of QUAL of this VB as it appears in in-memory sags
     union {
@@ -480,6 +481,7 @@ typedef struct Sag { // 32 bytes (= 4 x uint64_t)
 extern bool bam_txt_file_is_last_alignment_unmapped (void);
 
 extern void      sam_seg_QNAME (VBlockSAMP vb, ZipDataLineSAMP dl, STRp(qname), unsigned add_additional_bytes);
+extern void sam_seg_aggregates (VBlockSAMP vb, ZipDataLineSAMP dl);
 extern WordIndex sam_seg_RNAME (VBlockSAMP vb, ZipDataLineSAMP dl, STRp (chrom), bool against_sa_group_ok, unsigned add_bytes);
 extern WordIndex sam_seg_RNEXT (VBlockSAMP vb, ZipDataLineSAMP dl, STRp (chrom), unsigned add_bytes);
 extern void      sam_seg_MAPQ  (VBlockSAMP vb, ZipDataLineSAMP dl, unsigned add_bytes);
@@ -804,6 +806,7 @@ extern bool sam_is_sag_loaded (void);
 extern void sam_sag_by_flag_scan_for_depn (void);
 extern bool sam_might_have_saggies_in_other_VBs (VBlockSAMP vb, ZipDataLineSAMP dl, int32_t n_alns/*0 if unknown*/);
 extern void scan_index_qnames_seg (VBlockSAMP vb);
+extern void scan_get_vb_boundary_qnames (VBlockSAMP vb);
 extern uint32_t sam_piz_get_plsg_i (VBIType vb_i);
 extern void sam_add_main_vb_info (VBlockP vb, uint64_t prim_first_line, uint32_t prim_num_lines, uint64_t depn_first_line, uint32_t depn_num_lines);
 extern uint32_t sam_zip_calculate_max_conc_writing_vbs (void);
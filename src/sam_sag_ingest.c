@@ -34,8 +34,6 @@ void sam_sa_prim_initialize_ingest (void)
     z_file->sag_grps.can_be_big = z_file->sag_seq.can_be_big = z_file->sag_qual.can_be_big = z_file->sag_qnames.can_be_big = true;
 }
 
-static ASCENDING_SORTER (group_index_sorter, SAGroupIndexEntry, qname_hash)
-
 // ZIP ingest/PIZ load: main thread: after ingest/load: trim over-allocated memory
 void sam_gencomp_trim_memory (void)
 {
@@ -92,7 +90,7 @@ void sam_sa_prim_finalize_ingest (void)
     ASSERT (z_file->sag_grps.len <= 0xffffffffULL, "sag_grps.len=%"PRIu64" exceeds 32 bits - need to widen SAGroupIndexEntry.grp_i", z_file->sag_grps.len);
 
     // build index by hash(qname)
-    qsort (z_file->sag_grps_index.data, z_file->sag_grps_index.len, sizeof(SAGroupIndexEntry), group_index_sorter);
+    radix_sort (SAGroupIndexEntry, qname_hash, z_file->sag_grps_index);
 
     if (flag.show_sag) sam_show_sag();
     
@@ -235,7 +233,7 @@ static void sam_zip_prim_ingest_vb_create_index (VBlockSAMP vb, BufferP index_bu
     for_buf_tandem (SAGroupIndexEntry, index, *index_buf, uint32_t, hash, *qname_hash_buf)
         *index = (SAGroupIndexEntry){ .grp_i = index - first, .qname_hash = *hash };
 
-    qsort (first, index_buf->len32, sizeof(SAGroupIndexEntry), group_index_sorter);
+    radix_sort (SAGroupIndexEntry, qname_hash, *index_buf);
 
     COPY_TIMER (sam_zip_prim_ingest_vb_create_index);
 }
@@ -27,10 +27,10 @@ static VBlockP scan_vb;
 #define z_qname_index  evb->z_data // QNAME hash of all mapped alignments in this file
 
 typedef struct { uint32_t hash; VBIType vb_i; } QnameIndexEnt;
-static rom scan_index_one_line (VBlockSAMP vb, rom alignment, uint32_t remaining_txt_len)   
+
+// returns alignment length
+static uint32_t scan_parse_line (VBlockSAMP vb, rom alignment, uint32_t remaining_txt_len, pSTRp(qname), SamFlags *flag)
 {
-    STR(qname);
-    SamFlags flag;
     uint32_t alignment_len;
 
     if (IS_BAM_ZIP) {
@@ -41,9 +41,9 @@ static rom scan_index_one_line (VBlockSAMP vb, rom alignment, uint32_t remaining
                 "%s: alignment_len=%u is out of range - too small, or goes beyond end of txt data: remaining_txt_len=%u",
                 LN_NAME, alignment_len, remaining_txt_len);
 
-        flag      = (SamFlags){ .value = GET_UINT16 (&alignment[18]) };
-        qname_len = (uint8_t)alignment[12] - 1; // -1 bc without \0
-        qname     = &alignment[36];
+        *flag      = (SamFlags){ .value = GET_UINT16 (&alignment[18]) };
+        *qname_len = (uint8_t)alignment[12] - 1; // -1 bc without \0
+        *qname     = &alignment[36];
     }
     
     else { // SAM
@@ -55,16 +55,25 @@ static rom scan_index_one_line (VBlockSAMP vb, rom alignment, uint32_t remaining
         rom tab = memchr (alignment, '\t', alignment_len);
         ASSERT (tab, "%s: line has no \\t after QNAME", LN_NAME);
 
-        qname = alignment;
-        qname_len = tab - qname;
+        *qname = alignment;
+        *qname_len = tab - alignment;
         
         rom flag_str = tab+1;
-        tab = memchr (flag_str, '\t', alignment_len - (qname_len+1));
+        tab = memchr (flag_str, '\t', alignment_len - (*qname_len+1));
         ASSERT (tab, "%s: line has no \\t after FLAG", VB_NAME);
 
-        ASSERT (str_get_int_range16 (flag_str, tab - flag_str, 0, SAM_MAX_FLAG, &flag.value), "%s: invalid FLAG=%.*s", VB_NAME, (int)(tab - flag_str), flag_str);
+        ASSERT (str_get_int_range16 (flag_str, tab - flag_str, 0, SAM_MAX_FLAG, &flag->value), "%s: invalid FLAG=%.*s", VB_NAME, (int)(tab - flag_str), flag_str);
     }
 
+    return alignment_len;
+}
+
+static rom scan_index_one_line (VBlockSAMP vb, rom alignment, uint32_t remaining_txt_len)   
+{
+    STR(qname);
+    SamFlags flag;
+    uint32_t alignment_len = scan_parse_line (vb, alignment, remaining_txt_len, pSTRa(qname), &flag);
+
     uint32_t hash = qname_calc_hash (QNAME1, COMP_NONE, qname, qname_len, flag.is_last, false, CRC32, NULL);
 
     if (vb->preprocessing) {
@@ -107,11 +116,6 @@ static void scan_read_one_vb (VBlockP vb)
         vb->dispatch = DATA_EXHAUSTED;
 }
 
-static SORTER (depn_index_sorter)
-{
-    return ASCENDING_RAW (*(uint32_t *)a, *(uint32_t *)b);
-}
-
 // sort and uniq list of qname hashes that appear in this VB
 static void scan_sort_unique_depn_index (Buffer *buf)
 {
@@ -120,7 +124,7 @@ static void scan_sort_unique_depn_index (Buffer *buf)
     ARRAY (uint32_t, arr, *buf);
 
     // sort-uniq depn index    
-    qsort (arr, arr_len, sizeof(uint32_t), depn_index_sorter);
+    radix_sort_integral (uint32_t, *buf);
 
     // unique
     uint32_t new_len=1;
@@ -132,8 +136,6 @@ static void scan_sort_unique_depn_index (Buffer *buf)
     buf->len32 = new_len;
 }
 
-static ASCENDING_SORTER (qname_index_sorter, QnameIndexEnt, hash)
-
 // sort and uniq QNAME hashes, and also mark if they appear in more than one VB
 static void scan_sort_unique_qname_index (Buffer *buf)
 {
@@ -142,7 +144,7 @@ static void scan_sort_unique_qname_index (Buffer *buf)
     ARRAY (QnameIndexEnt, arr, *buf);
 
     // sort-uniq depn index    
-    qsort (arr, arr_len, sizeof(QnameIndexEnt), qname_index_sorter);
+    radix_sort (QnameIndexEnt, hash, *buf);
 
     // unique
     uint32_t new_len=1;
@@ -303,8 +305,6 @@ void sam_sag_by_flag_scan_for_depn (void)
 // no need to move to the prim/depn components) 
 //---------------------------------------------------------------------------
 
-static ASCENDING_SORTER (qname_count_sorter, QnameCount, hash)
-
 void scan_index_qnames_seg (VBlockSAMP vb)
 {
     rom next  = B1STtxt;
@@ -318,7 +318,7 @@ void scan_index_qnames_seg (VBlockSAMP vb)
     if (!counts_len) return; // all lines are unmapped
     
     // sort-uniq counts    
-    qsort (counts, counts_len, sizeof(QnameCount), qname_count_sorter);
+    radix_sort (QnameCount, hash, vb->qname_count);
 
     // unique
     uint32_t new_len=1;
@@ -339,6 +339,32 @@ void scan_index_qnames_seg (VBlockSAMP vb)
     vb->qname_count.len32 = new_len2;
 }
 
+// SAG_BY_FLAG single-pass, collated file: all alignments of a QNAME are consecutive, so only the sags of the first
+// and last lines of the VB might have alignments in other VBs
+void scan_get_vb_boundary_qnames (VBlockSAMP vb)
+{
+    if (!Ltxt) return;
+
+    rom first = B1STtxt, last = first, after = BAFTtxt;
+
+    if (IS_BAM_ZIP) 
+        for (rom next=first; next < after; next += GET_UINT32 (next) + 4) 
+            last = next;
+    
+    else {
+        rom nl = memrchr (first, '\n', after - 1 - first); // newline ending the line before the last line
+        if (nl) last = nl + 1;
+    }
+
+    STR(qname);
+    SamFlags flag;
+    scan_parse_line (vb, first, after - first, pSTRa(qname), &flag);
+    vb->vb_first_qname = (TxtWord){ .index = BNUMtxt (qname), .len = qname_len };
+
+    scan_parse_line (vb, last, after - last, pSTRa(qname), &flag);
+    vb->vb_last_qname  = (TxtWord){ .index = BNUMtxt (qname), .len = qname_len };
+}
+
 //---------------------------------------------------
 // Shared - called from sam_seg_is_gc_line during seg
 //---------------------------------------------------
@@ -351,6 +377,12 @@ static BINARY_SEARCHER (sam_sag_get_qname_counts_this_vb, QnameCount, uint32_t,
 // ZIP: true if this prim or depn sag line *might* have saggies in other VBs
 bool sam_might_have_saggies_in_other_VBs (VBlockSAMP vb, ZipDataLineSAMP dl, int32_t n_alns)
 {
+    // SAG_BY_FLAG single-pass: only sags at the VB boundaries might span VBs (if collated)
+    if (IS_SAG_FLAG && segconf.sag_by_flag_single_pass)
+        return !segconf.is_collated || 
+               str_issame_(STRqname(dl), STRtxt(vb->vb_first_qname)) || 
+               str_issame_(STRqname(dl), STRtxt(vb->vb_last_qname));
+
     if (!vb->qname_count.len32) return true; // we didn't count qnames, so we don't have proof that there aren't any saggies in other VBs
 
     uint32_t qname_hash = qname_calc_hash (QNAME1, COMP_NONE, STRqname(dl), dl->FLAG.is_last, false, CRC32, NULL);
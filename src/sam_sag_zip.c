@@ -111,13 +111,22 @@ void sam_set_sag_type (void)
     // We treat all non-depn mapped lines as PRIM (and warn the user of memory consumption)
     else if ((MP(BLASR) || segconf.sam_has_depn || flag.force_gencomp) && 
              (flag.best || flag.force_gencomp) &&  // too slow for normal mode
-             !txt_file->redirected && !txt_file->is_remote) { // conditions for using sam_sag_by_flag_scan_for_depn
+             !txt_file->redirected && !txt_file->is_remote && !flag.sag_single_pass) { // conditions for using sam_sag_by_flag_scan_for_depn
         sam_sag_by_flag_scan_for_depn ();
         segconf.sag_type = !z_file->sag_depn_index.len ? SAG_NONE
                          : segconf.has[OPTION_SA_Z]    ? SAG_BY_SA  // scan can detect SA:Z not previously detected by segconf
                          :                               SAG_BY_FLAG;
     }
 
+    // SAG_BY_FLAG single-pass: input can't be scanned twice (eg stdin), or --sag-single-pass. If the file is collated,
+    // only sags at the VB boundaries are sent to gencomp. Otherwise (only with --sag-single-pass), all valid PRIM lines are.
+    else if ((MP(BLASR) || segconf.sam_has_depn || flag.force_gencomp) && 
+             (flag.best || flag.force_gencomp || flag.sag_single_pass) &&
+             (segconf.is_collated || flag.sag_single_pass)) {
+        segconf.sag_type = SAG_BY_FLAG;
+        segconf.sag_by_flag_single_pass = true;
+    }
+
     else 
         segconf.sag_type = SAG_NONE;      
 
@@ -428,7 +437,7 @@ bool sam_seg_is_gc_line (VBlockSAMP vb, ZipDataLineSAMP dl, STRp(alignment), boo
                 }
             break;
 
-        case SAG_BY_FLAG: // note: we only possibly set this for BAM (not SAM) files
+        case SAG_BY_FLAG: // note: set for both SAM and BAM, after sam_sag_by_flag_scan_for_depn, or in single-pass mode (collated input or --sag-single-pass)
             if (sam_line_is_depn(dl))
                 comp_i = SAM_COMP_DEPN;
 
@@ -22,6 +22,7 @@
 #include "threads.h"
 #include "zip_dyn_int.h"
 #include "huffman.h"
+#include "aggregates.h"
 
 STRl(copy_GX_snip, 30);
 STRl(copy_sn_snip, 30);
@@ -529,6 +530,9 @@ void sam_seg_initialize (VBlockP vb_)
     if (vb->check_for_gc && !flag.force_gencomp && (/*IS_SAG_SA ||*/ IS_SAG_NH || IS_SAG_SOLO)) // SA still doesn't work well with saggy - not even QUAL
         scan_index_qnames_seg (vb);
 
+    else if (vb->check_for_gc && IS_SAG_FLAG && segconf.sag_by_flag_single_pass && segconf.is_collated)
+        scan_get_vb_boundary_qnames (vb);
+
     // note: SA_HtoS might be already set if we segged an line containing SA:Z against a prim saggy
     if (IS_DEPN(vb) && IS_SAG_SA && segconf.SA_HtoS == unknown)
         segconf.SA_HtoS = segconf.depn_CIGAR_can_have_H && // set when segging MAIN component
@@ -1592,6 +1596,26 @@ void sam_seg_QNAME (VBlockSAMP vb, ZipDataLineSAMP dl, STRp (qname), unsigned ad
         seg_special0 (VB, SAM_SPECIAL_PRIM_QNAME, CTX(SAM_QNAMESA), 0); // consumed when reconstructing PRIM vb
 }
 
+// --aggregates: count the line under the same cover type as genocat --coverage would (see sam_piz_update_coverage)
+void sam_seg_aggregates (VBlockSAMP vb, ZipDataLineSAMP dl)
+{
+    if (!flag.aggregates) return;
+
+    uint32_t soft_clip = vb->soft_clip[0] + vb->soft_clip[1];
+
+    CoverTypes cvr = (vb->chrom_node_index == WORD_INDEX_NONE || dl->FLAG.unmapped) ? CVR_UNMAPPED
+                   : dl->FLAG.filtered      ? CVR_FAILED
+                   : dl->FLAG.duplicate     ? CVR_DUPLICATE
+                   : dl->FLAG.secondary     ? CVR_SECONDARY
+                   : dl->FLAG.supplementary ? CVR_SUPPLEMENTARY
+                   :                          CVR_ALL_CONTIGS;
+
+    if (cvr == CVR_ALL_CONTIGS)
+        aggregates_seg_line (VB, cvr, dl->SEQ.len - soft_clip, soft_clip);
+    else
+        aggregates_seg_line (VB, cvr, dl->SEQ.len, 0);
+}
+
 WordIndex sam_seg_RNAME (VBlockSAMP vb, ZipDataLineSAMP dl, STRp (chrom),
                          bool against_sa_group_ok, // if true, vb->chrom_node_index must already be set
                          unsigned add_bytes)
@@ -1901,6 +1925,8 @@ rom sam_seg_txt_line (VBlockP vb_, rom next_line, uint32_t remaining_txt_len, bo
 
     MAXIMIZE (vb->longest_seq_len, dl->SEQ.len);
 
+    sam_seg_aggregates (vb, dl);
+
     return next_line;
 
 rollback_and_done:
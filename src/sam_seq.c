@@ -10,6 +10,7 @@
 #include "random_access.h"
 #include "aligner.h"
 #include "refhash.h"
+#include "acgt.h"
 
 //---------------
 // Shared ZIP/PIZ
@@ -1499,18 +1500,9 @@ TRANSLATOR_FUNC (sam_piz_sam2bam_SEQ)
         goto done;
     }
 
-    // if l_seq is odd, 0 the next byte that will be half of our last result byte
-    if (l_seq % 2) *BAFTtxt = 0; 
-
-    // the characters "=ACMGRSVTWYHKDBN" are mapped to BAM 0->15, in this matrix we add 0x80 as a validity bit. All other characters are 0x00 - invalid
-    static const uint8_t sam2bam_seq_map[256] = { ['=']=0x0, ['A']=0x1, ['C']=0x2, ['M']=0x3, ['G']=0x4, ['R']=0x5, ['S']=0x6, ['V']=0x7, 
-                                                  ['T']=0x8, ['W']=0x9, ['Y']=0xa, ['H']=0xb, ['K']=0xc, ['D']=0xd, ['B']=0xe, ['N']=0xf };
-
-    uint8_t *in=(uint8_t *)recon, *out=in; 
+    // translate in place: A,C,G,T,N are packed 16 or 32 bases at a time, other IUPAC codes fall back to a lookup table
     uint32_t out_len = (l_seq + 1) / 2;
-    
-    for (uint32_t i=0; i < out_len; i++, out++, in += 2) 
-        *out = (sam2bam_seq_map[in[0]] << 4) | sam2bam_seq_map[in[1]]; // note: invalid characters are encoded as 0 (piz doesn't verify)
+    acgt_seq_to_bam (recon, l_seq, (uint8_t *)recon);
     
     Ltxt = Ltxt - l_seq + out_len;
 
@@ -48,6 +48,9 @@ static const struct {rom name; uint32_t header_size; } abouts[NUM_SEC_TYPES] = {
     [SEC_USER_MESSAGE]    = {"SEC_USER_MESSAGE",    sizeof (SectionHeader)              }, \
     [SEC_GENCOMP]         = {"SEC_GENCOMP",         sizeof (SectionHeader)              }, \
     [SEC_HUFFMAN]         = {"SEC_HUFFMAN",         sizeof (SectionHeaderHuffman)       }, \
+    [SEC_RA_LINES]        = {"SEC_RA_LINES",        sizeof (SectionHeader)              }, \
+    [SEC_AGGREGATES]      = {"SEC_AGGREGATES",      sizeof (SectionHeader)              }, \
+    [SEC_DICT_TEMPLATE]   = {"SEC_DICT_TEMPLATE",   sizeof (SectionHeader)              }, \
 };
 
 const LocalTypeDesc lt_desc[NUM_LOCAL_TYPES] = LOCALTYPE_DESC;
@@ -1273,6 +1276,9 @@ void sections_show_header (ConstSectionHeaderP header,
     }
         
     case SEC_MGZIP:
+    case SEC_RA_LINES:
+    case SEC_AGGREGATES:
+    case SEC_DICT_TEMPLATE:
     case SEC_RANDOM_ACCESS: {
         snprintf (str, sizeof (str), "%s%s\n", SEC_TAB, sections_dis_flags (f, st, dt, 0).s); 
         break;
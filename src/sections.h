@@ -269,8 +269,9 @@ typedef struct {
             } width; 
 
             float segconf_Q_to_O;              // VCF: 15.0.61
+            uint32_t segconf_sample_block;     // VCF: --sample-blocks: samples per block, 0 if not blocked. 15.0.74
 
-            uint8_t unused[251];
+            uint8_t unused[247];
         } vcf;
     };
 
@@ -507,6 +508,40 @@ typedef struct RAEntry {
     PosType64 min_pos, max_pos;// POS field value of smallest and largest POS value of this chrom in this VB (regardless of whether the VB is sorted)
 } RAEntry; 
 
+// the data of SEC_RA_LINES is an array of the following type, as is the z_file->ra_lines_buf and vb->ra_lines_buf.
+// Each entry covers a range of lines within a VB, not crossing a boundary of --sub-vb-index lines, all on the same chrom.
+typedef struct RALinesEntry {
+    VBIType vblock_i;          
+    WordIndex chrom_index;     // before merge: node index into chrom context nodes, after merge - word index in CHROM dictionary
+    PosType64 min_pos, max_pos;// smallest and largest POS of lines in this range
+    uint32_t first_line, last_line; // 0-based line_i within the VB
+} RALinesEntry; 
+
+// the data of SEC_AGGREGATES is an array of the following type, as is the z_file->agg_buf and vb->agg_buf. 
+// Each entry summarizes the lines of a VB that have the same chrom and (SAM) cover type, allowing genocat --count, 
+// --coverage and --idxstats to be answered without reconstructing the VB.
+typedef struct AggEntry {
+    VBIType vblock_i;
+    WordIndex chrom_index;     // before merge: node index into chrom context nodes, after merge - word index in CHROM dictionary. WORD_INDEX_NONE if no chrom.
+    uint32_t num_lines;        // number of lines in the VB with this chrom and cover type
+    uint8_t cvr;               // SAM: the CoverTypes under which --coverage counts these lines (CVR_ALL_CONTIGS for mapped primary alignments). Other data types: CVR_ALL_CONTIGS
+    uint8_t unused[3];
+    uint64_t bases;            // SAM: number of bases, excluding soft-clipped bases for CVR_ALL_CONTIGS
+    uint64_t soft_clip;        // SAM: number of soft-clipped bases (CVR_ALL_CONTIGS only)
+} AggEntry;
+
+// the data of SEC_DICT_TEMPLATE is an array of the following type, one entry per context whose dictionary was primed
+// from the --dict-template file. PIZ primes the context with the same words, and verifies they are identical.
+typedef struct DictTemplateEnt {
+    DictId dict_id;
+    uint32_t num_words;        // number of leading words of the dictionary taken from the template
+    uint32_t dict_crc32;       // crc32 of the primed words, including their \0 separators
+    uint64_t dict_len;         // length of the primed words, including their \0 separators
+    uint8_t dict_helper;       // zctx->dict_helper: normally transmitted via SEC_DICT, which might not exist if no new words were added
+    SectionFlags dict_flags;   // zctx->dict_flags: same
+    uint8_t unused[6];
+} DictTemplateEnt;
+
 // the data of SEC_REF_IUPACS (added v12)
 typedef struct Iupac {
     PosType64 gpos;
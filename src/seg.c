@@ -152,7 +152,10 @@ rom seg_get_next_item (VBlockP vb, rom str, int *str_len,
     START_TIMER;
 
     rom c, after;
-    for (c = str, after = str + *str_len; c < after; c++) 
+    for (c = str, after = str + *str_len; c < after; c++) {
+        c = str_find_first_of3 (c, after, ' ', '\t', '\n'); // skip to next potential separator
+        if (c == after) break;
+
         switch (*c) {
             case ' '  : if      (space   == GN_SEP     ) goto sep_found; 
                         else if (space   == GN_FORBIDEN) goto not_found;
@@ -168,6 +171,7 @@ rom seg_get_next_item (VBlockP vb, rom str, int *str_len,
 
             default   : break;
         }
+    }
 
 not_found: // no sep found in entire string, or forbidden separator encountered
     ABOSEG ("while segmenting %s: expecting a %s%s%s in \"%.1000s\"", 
@@ -200,20 +204,21 @@ rom seg_get_next_line (VBlockP vb, rom str,
     START_TIMER;
 
     rom after = str + *remaining_len;
-    for (rom s=str; s < after; s++)
-        if (*s == '\n') {
-                *len = s - str;
-                *remaining_len -= *len + 1;
-
-                // check for Windows-style '\r\n' end of line 
-                if (s > str && s[-1] == '\r') {
-                    (*len)--;
-                    *has_13 = true;
-                }
-
-                COPY_TIMER (seg_get_next_line);
-                return str + *len + *has_13 + 1; // beyond the separator
+    rom s = (*remaining_len > 0) ? memchr (str, '\n', *remaining_len) : NULL;
+    
+    if (s) {
+        *len = s - str;
+        *remaining_len -= *len + 1;
+
+        // check for Windows-style '\r\n' end of line 
+        if (s > str && s[-1] == '\r') {
+            (*len)--;
+            *has_13 = true;
         }
+
+        COPY_TIMER (seg_get_next_line);
+        return str + *len + *has_13 + 1; // beyond the separator
+    }
     
     ASSSEG (*remaining_len, "missing %s field", item_name);
 
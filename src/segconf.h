@@ -182,6 +182,7 @@ typedef struct {
     bool nM_after_MD;           // same, for nM:i
     bool pysam_qual;            // ZIP/PIZ: BAM missing QUAL is generated by old versions of pysam: first byte is 0xff, followed by 0s (SAM spec requires all bytes to be 0xff)
     bool sam_has_depn;          // ZIP: true if any line in the segconf sample had SAM_FLAG_SECONDARY or SAM_FLAG_SUPPLEMENTARY
+    bool sag_by_flag_single_pass; // ZIP: SAG_BY_FLAG without sam_sag_by_flag_scan_for_depn - sags are resolved by QNAME collation
     bool has_barcodes;          // ZIP: file uses barcodes
     bool star_solo;             // ZIP: using STARsolo or cellranger
     uint32_t AS_is_2ref_consumed; // ZIP/PIZ: AS value tends to be double ref_consumed (counter during segconf, bool during seg/piz)
@@ -274,6 +275,7 @@ typedef struct {
     uint8_t vcf_max_MAPQ;       // maximum MAPQ of BAM alignments that contributed to this variant, as derived from RAW_MQandDP, but not more than 223
     FormatDPMethod FMT_DP_method;
     InfoDPMethod INFO_DP_method;
+    uint32_t vcf_sample_block;  // --sample-blocks: number of samples per block, 0 if samples are not blocked
     thool PL_mux_by_DP;
     Mutex PL_mux_by_DP_mutex;
     bool FI_by_DP;
@@ -0,0 +1,341 @@
+// ------------------------------------------------------------------
+//   server.c
+//   Copyright (C) 2025-2025 Genozip Limited. Patent Pending.
+//   Please see terms and conditions in the file LICENSE.txt
+//
+//   WARNING: Genozip is proprietary, not open source software. Modifying the source code is strictly prohibited,
+//   under penalties specified in the license.
+
+// genozip --server=SOCKET runs as a resident process, listening on a Unix domain socket. Clients are regular
+// genozip / genounzip / genocat invocations with --use-server=SOCKET: they send their command line, current
+// directory and stdin/stdout/stderr to the server, and exit with the exit status of the job.
+// Each job runs in a process forked from the server, so it starts with the server's initialization done, and
+// with the reference and refhash (loaded once by the server) already in memory, shared copy-on-write.
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <errno.h>
+#include <unistd.h>
+#include <limits.h>
+#endif
+#include "server.h"
+#include "buf_struct.h"
+#include "arch.h"
+#include "flags.h"
+
+#ifndef _WIN32
+
+#define SERVER_JOB_MAGIC 0x4a425347 // "GSBJ"
+
+typedef struct {
+    uint32_t magic;
+    uint32_t argc;
+    uint32_t payload_len; // payload: current directory, followed by argv[0..argc-1], each nul-terminated
+} ServerJobHeader;
+
+typedef struct {
+    pid_t pid;
+    int conn;             // connection to the client, to which we report the job's exit status
+    bool killed;          // client disconnected before the job was done
+} ServerJob;
+
+static int sigchld_pipe[2] = { -1, -1 }; // self-pipe: written by the SIGCHLD handler, to wake up the server's poll
+
+static struct sockaddr_un server_address (rom socket_path)
+{
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+
+    ASSINP (strlen (socket_path) < sizeof (addr.sun_path), "Socket path too long: %s", socket_path);
+    strcpy (addr.sun_path, socket_path);
+
+    return addr;
+}
+
+static bool server_write (int fd, const void *data, uint32_t len)
+{
+    while (len) {
+        ssize_t n = write (fd, data, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+
+        data += n;
+        len  -= n;
+    }
+
+    return true;
+}
+
+static bool server_read (int fd, void *data, uint32_t len)
+{
+    while (len) {
+        ssize_t n = read (fd, data, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+
+        data += n;
+        len  -= n;
+    }
+
+    return true;
+}
+
+//---------------
+// Client side
+//---------------
+
+static void server_client (rom socket_path, int argc, char **argv)
+{
+    int conn = socket (AF_UNIX, SOCK_STREAM, 0);
+    ASSERT (conn >= 0, "socket failed: %s", strerror (errno));
+
+    struct sockaddr_un addr = server_address (socket_path);
+    ASSINP (!connect (conn, (struct sockaddr *)&addr, sizeof (addr)),
+            "Failed to connect to genozip server at %s: %s", socket_path, strerror (errno));
+
+    char cwd[PATH_MAX];
+    ASSERT (getcwd (cwd, sizeof (cwd)), "getcwd failed: %s", strerror (errno));
+
+    ServerJobHeader header = { .magic = SERVER_JOB_MAGIC, .argc = argc, .payload_len = strlen (cwd) + 1 };
+    for (int i=0; i < argc; i++)
+        header.payload_len += strlen (argv[i]) + 1;
+
+    char *payload = MALLOC (header.payload_len), *next = payload;
+    next = stpcpy (next, cwd) + 1;
+    for (int i=0; i < argc; i++)
+        next = stpcpy (next, argv[i]) + 1;
+
+    // send the header, along with our stdin, stdout and stderr
+    int fds[3] = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+    char control[CMSG_SPACE (sizeof (fds))];
+    memset (control, 0, sizeof (control));
+
+    struct iovec iov = { .iov_base = &header, .iov_len = sizeof (header) };
+    struct msghdr msg = { .msg_iov = &iov, .msg_iovlen = 1, .msg_control = control, .msg_controllen = sizeof (control) };
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR (&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type  = SCM_RIGHTS;
+    cmsg->cmsg_len   = CMSG_LEN (sizeof (fds));
+    memcpy (CMSG_DATA (cmsg), fds, sizeof (fds));
+
+    ASSERT (sendmsg (conn, &msg, 0) == sizeof (header) && server_write (conn, payload, header.payload_len),
+            "Failed to send job to genozip server at %s: %s", socket_path, strerror (errno));
+
+    FREE (payload);
+
+    // wait for the job to complete. Its output goes directly to our stdout and stderr.
+    int32_t exit_status;
+    ASSINP (server_read (conn, &exit_status, sizeof (exit_status)), "Lost connection to genozip server at %s", socket_path);
+
+    exit (exit_status);
+}
+
+//---------------
+// Server side
+//---------------
+
+// job process: receive the job from the client, and set up our process to run it
+static void server_receive_job (int conn, int *argc, char ***argv)
+{
+    ServerJobHeader header;
+    int fds[3];
+    char control[CMSG_SPACE (sizeof (fds))];
+
+    struct iovec iov = { .iov_base = &header, .iov_len = sizeof (header) };
+    struct msghdr msg = { .msg_iov = &iov, .msg_iovlen = 1, .msg_control = control, .msg_controllen = sizeof (control) };
+
+    ssize_t n;
+    while ((n = recvmsg (conn, &msg, 0)) < 0 && errno == EINTR) {}
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR (&msg);
+    if (n != sizeof (header) || header.magic != SERVER_JOB_MAGIC || !header.argc ||
+        !cmsg || cmsg->cmsg_type != SCM_RIGHTS || cmsg->cmsg_len != CMSG_LEN (sizeof (fds)))
+        exit (EXIT_GENERAL_ERROR); // not a valid client - note: we can't report an error, as we don't have its stderr
+
+    memcpy (fds, CMSG_DATA (cmsg), sizeof (fds));
+
+    char *payload = MALLOC (header.payload_len + 1);
+    if (!server_read (conn, payload, header.payload_len)) exit (EXIT_GENERAL_ERROR);
+    payload[header.payload_len] = 0;
+
+    close (conn); // the server process reports our exit status to the client
+
+    // from now on, our stdin, stdout and stderr are the client's
+    fflush (stdout);
+    fflush (stderr);
+    for (int i=0; i < 3; i++) {
+        dup2 (fds[i], i);
+        close (fds[i]);
+    }
+
+    signal (SIGPIPE, SIG_DFL); // ignored by the server
+
+    ASSINP (!chdir (payload), "Failed to change directory to %s: %s", payload, strerror (errno));
+
+    *argv = MALLOC ((header.argc + 1) * sizeof (char *));
+    char *next = payload + strlen (payload) + 1, *after = payload + header.payload_len;
+
+    for (uint32_t i=0; i < header.argc; i++) {
+        ASSINP0 (next < after, "Malformed job received from client");
+        (*argv)[i] = next;
+        next += strlen (next) + 1;
+    }
+    (*argv)[header.argc] = NULL;
+    *argc = header.argc;
+}
+
+static void server_sigchld_handler (int sig)
+{
+    int save_errno = errno;
+    char c = 0;
+    if (write (sigchld_pipe[1], &c, 1)) {} // pipe is non-blocking - if it is full, the server will wake up anyway
+    errno = save_errno;
+}
+
+#endif // _WIN32
+
+// called at the beginning of main: if --use-server=SOCKET is on the command line, we are a client:
+// submit the job and exit with its exit status
+void server_run_client_if_requested (int argc, char **argv)
+{
+    const unsigned opt_len = strlen (USE_SERVER_OPTION);
+
+    for (int i=1; i < argc; i++)
+        if (!strncmp (argv[i], USE_SERVER_OPTION, opt_len)) {
+#ifndef _WIN32
+            rom socket_path = argv[i] + opt_len;
+
+            // forward the command line without --use-server
+            memmove (&argv[i], &argv[i+1], (argc - i - 1) * sizeof (char *));
+            server_client (socket_path, argc - 1, argv); // doesn't return
+#else
+            ABORTINP0 ("--use-server is not supported on Windows");
+#endif
+        }
+}
+
+// genozip --server: listen for jobs, and run each in a forked process. Returns only in a job process,
+// with the client's command line, after having set up the client's stdin/stdout/stderr and current directory.
+void server_run (rom socket_path, int *argc, char ***argv)
+{
+#ifndef _WIN32
+    struct sockaddr_un addr = server_address (socket_path);
+
+    // don't take over the socket of a running server, but remove a stale socket file
+    int probe = socket (AF_UNIX, SOCK_STREAM, 0);
+    ASSINP (connect (probe, (struct sockaddr *)&addr, sizeof (addr)) < 0, "A genozip server is already listening on %s", socket_path);
+    close (probe);
+    unlink (socket_path);
+
+    int listen_fd = socket (AF_UNIX, SOCK_STREAM, 0);
+    ASSERT (listen_fd >= 0, "socket failed: %s", strerror (errno));
+
+    // socket is accessible only to our user, as jobs run with our permissions
+    mode_t save_umask = umask (0177);
+    int bind_failed = bind (listen_fd, (struct sockaddr *)&addr, sizeof (addr));
+    umask (save_umask);
+    ASSINP (!bind_failed, "Failed to bind to %s: %s", socket_path, strerror (errno));
+    ASSERT (!listen (listen_fd, 128), "listen failed on %s: %s", socket_path, strerror (errno));
+
+    signal (SIGPIPE, SIG_IGN); // a client might disconnect before we report its exit status
+
+    // a completed job wakes up poll via the self-pipe, so we can block in poll rather than wake up periodically to reap jobs
+    ASSERT (!pipe (sigchld_pipe), "pipe failed: %s", strerror (errno));
+    for (int i=0; i < 2; i++)
+        fcntl (sigchld_pipe[i], F_SETFL, fcntl (sigchld_pipe[i], F_GETFL) | O_NONBLOCK);
+
+    struct sigaction sa = { .sa_handler = server_sigchld_handler, .sa_flags = SA_RESTART | SA_NOCLDSTOP };
+    sigemptyset (&sa.sa_mask);
+    ASSERT (!sigaction (SIGCHLD, &sa, NULL), "sigaction failed: %s", strerror (errno));
+
+    // additional clients wait in the listen backlog
+    uint32_t max_jobs = MAX_(arch_get_num_cores(), 1);
+    ServerJob jobs[max_jobs];
+    uint32_t n_jobs = 0;
+
+    iprintf ("%s: server listening on %s, running up to %u concurrent jobs\n", global_cmd, socket_path, max_jobs);
+
+    while (1) {
+        // reap completed jobs, and report their exit status to their clients
+        int status;
+        pid_t pid;
+        while ((pid = waitpid (-1, &status, WNOHANG)) > 0)
+            for (uint32_t j=0; j < n_jobs; j++)
+                if (jobs[j].pid == pid) {
+                    int32_t exit_status = WIFEXITED (status) ? WEXITSTATUS (status) : 128 + WTERMSIG (status);
+                    server_write (jobs[j].conn, &exit_status, sizeof (exit_status)); // fails silently if client is gone
+                    close (jobs[j].conn);
+
+                    jobs[j] = jobs[--n_jobs];
+                    break;
+                }
+
+        // wait for a new client (if we have room for another job), for a client to disconnect mid-job (e.g. ctrl-C),
+        // or for a job to complete (SIGCHLD). note: a SIGCHLD arriving after waitpid above leaves a byte in the pipe.
+        struct pollfd pfds[max_jobs + 2];
+        for (uint32_t j=0; j < n_jobs; j++)
+            pfds[j] = (struct pollfd){ .fd = jobs[j].killed ? -1 : jobs[j].conn, .events = POLLIN };
+
+        pfds[n_jobs]   = (struct pollfd){ .fd = (n_jobs < max_jobs) ? listen_fd : -1, .events = POLLIN };
+        pfds[n_jobs+1] = (struct pollfd){ .fd = sigchld_pipe[0], .events = POLLIN };
+
+        if (poll (pfds, n_jobs + 2, -1) <= 0) continue; // EINTR
+
+        // drain the self-pipe - jobs are reaped at the top of the loop
+        if (pfds[n_jobs+1].revents & POLLIN) {
+            char drain[64];
+            while (read (sigchld_pipe[0], drain, sizeof (drain)) > 0) {}
+        }
+
+        // a client has gone if its connection hung up, or reached EOF. note: a connection might also be readable because
+        // the job process hasn't yet read the request sent by the client - that is not a reason to kill the job.
+        for (uint32_t j=0; j < n_jobs; j++) {
+            char c;
+            if ((pfds[j].revents & (POLLHUP | POLLERR)) ||
+                ((pfds[j].revents & POLLIN) && recv (jobs[j].conn, &c, 1, MSG_PEEK | MSG_DONTWAIT) == 0)) {
+                kill (jobs[j].pid, SIGTERM);
+                jobs[j].killed = true;
+            }
+        }
+
+        if (!(pfds[n_jobs].revents & POLLIN)) continue;
+
+        int conn = accept (listen_fd, NULL, NULL);
+        if (conn < 0) continue;
+
+        fflush (stdout); // so that the job process doesn't inherit unflushed data
+        fflush (stderr);
+
+        pid = fork();
+
+        // case: job process - return to main to run the job
+        if (!pid) {
+            signal (SIGCHLD, SIG_DFL); // the job might run child processes of its own
+            close (sigchld_pipe[0]);
+            close (sigchld_pipe[1]);
+            close (listen_fd);
+            for (uint32_t j=0; j < n_jobs; j++)
+                close (jobs[j].conn);
+
+            server_receive_job (conn, argc, argv);
+            return;
+        }
+
+        else if (pid < 0) {
+            WARN ("fork failed: %s", strerror (errno));
+            close (conn); // client will report a lost connection
+        }
+
+        else
+            jobs[n_jobs++] = (ServerJob){ .pid = pid, .conn = conn };
+    }
+#else
+    ABORTINP0 ("--server is not supported on Windows");
+#endif
+}
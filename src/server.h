@@ -0,0 +1,16 @@
+// ------------------------------------------------------------------
+//   server.h
+//   Copyright (C) 2025-2025 Genozip Limited. Patent Pending.
+//   Please see terms and conditions in the file LICENSE.txt
+//
+//   WARNING: Genozip is proprietary, not open source software. Modifying the source code is strictly prohibited,
+//   under penalties specified in the license.
+
+#pragma once
+
+#include "genozip.h"
+
+#define USE_SERVER_OPTION "--use-server="
+
+extern void server_run_client_if_requested (int argc, char **argv);
+extern void server_run (rom socket_path, int *argc, char ***argv);
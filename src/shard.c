@@ -0,0 +1,181 @@
+// ------------------------------------------------------------------
+//   shard.c
+//   Copyright (C) 2025-2025 Genozip Limited. Patent pending.
+//   Please see terms and conditions in the file LICENSE.txt
+//
+//   WARNING: Genozip is proprietary, not open source software. Modifying the source code is strictly prohibited
+//   and subject to penalties specified in the license.
+
+// genocat --shard-by=chrom|vb-count:N|size:MB --output-pattern=PATTERN: the output is split into multiple files, each with
+// its own txt header. A first pass reads only the global area, and calculates the shards: by chrom, the random access index
+// lists the chroms present, and each shard is a --regions of one chrom (so its process reads only the VBs of that chrom) -
+// files with lines that have no chrom (eg unmapped reads) are refused, as these lines are not in the random access index.
+// By vb-count or size, each shard is a --lines range covering consecutive VBs. Shards are then written concurrently by
+// child processes (see main_genocat_shards), each with its own writer and BGZF compression.
+
+#include "shard.h"
+#include "file.h"
+#include "context.h"
+#include "sections.h"
+#include "zfile.h"
+#include "regions.h"
+
+typedef struct {
+    uint64_t name_index;          // index into shard_names
+    int64_t first_line, last_line;// vb-count, size: 0-based, inclusive
+} Shard;
+
+static Buffer shards      = {};   // array of Shard
+static Buffer shard_names = {};   // nul-terminated names of shards, substituted into --output-pattern
+
+void shard_set_shard_by (rom optarg)
+{
+    rom colon = strchr (optarg, ':');
+    unsigned by_len = colon ? (colon - optarg) : strlen (optarg);
+
+    if      (str_issame_(optarg, by_len, "chrom",    5)) flag.shard_by = SHARD_BY_CHROM;
+    else if (str_issame_(optarg, by_len, "vb-count", 8)) flag.shard_by = SHARD_BY_VB_COUNT;
+    else if (str_issame_(optarg, by_len, "size",     4)) flag.shard_by = SHARD_BY_SIZE;
+    else ABORTINP ("--shard-by: bad argument \"%s\", expecting one of: chrom, vb-count:<VBs-per-shard>, size:<MB-per-shard>", optarg);
+
+    ASSINP ((flag.shard_by == SHARD_BY_CHROM) == !colon, "--shard-by: bad argument \"%s\", expecting one of: chrom, vb-count:<VBs-per-shard>, size:<MB-per-shard>", optarg);
+
+    ASSINP (!colon || str_get_int_range64 (colon+1, 0, 1, 1000000000, (int64_t *)&flag.shard_by_param),
+            "--shard-by: bad value \"%s\", expecting an integer from 1 to 1000000000", colon+1);
+}
+
+void shard_set_output_pattern (rom optarg)
+{
+    rom s = strstr (optarg, "%s");
+    ASSINP (s && !strchr (s+1, '%') && strchr (optarg, '%') == s, 
+            "--output-pattern: \"%s\" must contain \"%%s\" exactly once (replaced by the shard name), and no other %%", optarg);
+
+    flag.output_pattern = optarg;
+}
+
+static void shard_add (rom name, unsigned name_len, int64_t first_line, int64_t last_line)
+{
+    buf_alloc (evb, &shards, 1, 64, Shard, 2, "shards");
+    BNXT (Shard, shards) = (Shard){ .name_index = shard_names.len, .first_line = first_line, .last_line = last_line };
+
+    buf_alloc (evb, &shard_names, name_len + 1, 1 KB, char, 2, "shard_names");
+    buf_add (&shard_names, name, name_len);
+    BNXTc (shard_names) = 0;
+}
+
+// --shard-by=chrom: one shard per chrom that has any data according to the random access index, in dictionary order 
+static void shard_calculate_by_chrom (void)
+{
+    ASSINP (DTFZ(chrom) != DID_NONE && z_file->ra_buf.len, 
+            "--shard-by=chrom: %s has no random access index. Use --shard-by=vb-count or --shard-by=size instead", z_name);
+
+    ContextP zctx = ZCTX(DTFZ(chrom));
+
+    // lines with an unavailable chrom ("*" in SAM, "." in VCF) are not in the random access index, so they would be in no shard
+    ASSINP (ctx_search_for_word_index (zctx, _S("*")) == WORD_INDEX_NONE && ctx_search_for_word_index (zctx, _S(".")) == WORD_INDEX_NONE,
+            "--shard-by=chrom: %s has lines without a %s (eg unmapped reads), which would not be in any shard. Use --shard-by=vb-count or --shard-by=size instead", 
+            z_name, zctx->tag_name);
+    
+    ASSERTNOTINUSE (evb->scratch);
+    buf_alloc_zero (evb, &evb->scratch, 0, zctx->word_list.len, bool, 0, "scratch");
+    ARRAY (bool, has_data, evb->scratch);
+
+    for_buf (RAEntry, ra, z_file->ra_buf)
+        if (ra->chrom_index >= 0 && ra->chrom_index < zctx->word_list.len) 
+            has_data[ra->chrom_index] = true;
+
+    for (WordIndex wi=0; wi < zctx->word_list.len; wi++)
+        if (has_data[wi]) {
+            STR(chrom);
+            ctx_get_snip_by_word_index (zctx, wi, chrom);
+            shard_add (STRa(chrom), NO_LINE, NO_LINE);
+        }
+
+    buf_free (evb->scratch);
+}
+
+static void shard_add_lines (int64_t first_line, int64_t last_line)
+{
+    char name[16];
+    shard_add (name, snprintf (name, sizeof (name), "%04u", shards.len32 + 1), first_line, last_line);
+}
+
+// --shard-by=vb-count or size: shards are --lines ranges of consecutive VBs. Note: in SAM with PRIM/DEPN components, whose 
+// lines are reconstructed interleaved with MAIN lines, shard boundaries are only approximately aligned with VB boundaries.
+static void shard_calculate_by_vbs (void)
+{
+    SectionHeaderTxtHeader header = zfile_read_section_header (evb, sections_get_comp_txt_header_sec (COMP_MAIN), SEC_TXT_HEADER).txt_header;
+    double bytes_per_line = (double)BGEN64 (header.txt_data_size) / (double)MAX_(BGEN64 (header.txt_num_lines), 1);
+
+    double max_weight = (flag.shard_by == SHARD_BY_SIZE) ? (double)(flag.shard_by_param MB) : (double)flag.shard_by_param;
+    double weight = 0;
+    int64_t first_line = 0, line_i = 0;
+
+    for (VBIType vb_i=1; vb_i <= z_file->num_vbs; vb_i++) {
+        Section sec = sections_vb_header (vb_i);
+        if (Z_DT(SAM) && sec->comp_i > SAM_COMP_DEPN) continue; // Deep: FASTQ components are not part of the SAM output
+
+        line_i += sec->num_lines;
+        weight += (flag.shard_by == SHARD_BY_SIZE) ? (sec->num_lines * bytes_per_line) : 1;
+
+        if (weight >= max_weight) {
+            if (line_i > first_line) shard_add_lines (first_line, line_i - 1);
+            first_line = line_i;
+            weight = 0;
+        }
+    }
+
+    // last shard - lines after the last full shard (note: the last VB is not necessarily a SAM VB)
+    if (line_i > first_line)
+        shard_add_lines (first_line, line_i - 1);
+}
+
+// PIZ main thread: called after reading the global area, in the first pass of genocat --shard-by
+void shard_piz_calculate (void)
+{
+    buf_free (shards);
+    buf_free (shard_names);
+
+    if (flag.shard_by == SHARD_BY_CHROM) shard_calculate_by_chrom();
+    else                                 shard_calculate_by_vbs();
+
+    ASSINP (shards.len, "--shard-by: %s has no data lines to shard", z_name);
+}
+
+uint32_t shard_piz_get_num_shards (void)
+{
+    return shards.len32;
+}
+
+// child process of genocat --shard-by: set the flags to output one shard, as if genocat was run with -o and --regions or --lines
+void shard_piz_set_flags (uint32_t shard_i)
+{
+    Shard *shard = B(Shard, shards, shard_i);
+    rom name = Bc(shard_names, shard->name_index);
+
+    // substitute the shard name for %s in the pattern
+    rom s = strstr (flag.output_pattern, "%s");
+    unsigned prefix_len = s - flag.output_pattern, name_len = strlen (name), suffix_len = strlen (s+2);
+    
+    char *out_filename = MALLOC (prefix_len + name_len + suffix_len + 1);
+    memcpy (out_filename, flag.output_pattern, prefix_len);
+    memcpy (out_filename + prefix_len + name_len, s+2, suffix_len + 1);
+
+    for (unsigned i=0; i < name_len; i++) // replace characters that can't be in a filename
+        out_filename[prefix_len + i] = (name[i] == '/' || name[i] == '\\') ? '_' : name[i];
+
+    flag.out_filename = out_filename;
+    flag.to_stdout    = false;
+    
+    if (flag.shard_by == SHARD_BY_CHROM) {
+        regions_add_chrom (name);
+        flag.regions = 1;
+    }
+    else {
+        flag.lines_first = shard->first_line;
+        flag.lines_last  = shard->last_line;
+    }
+
+    flag.shard_by = SHARD_NONE; // this process writes a single shard
+    if (!flag.noisy) flag.quiet = true; // progress of concurrent shards would be garbled
+}
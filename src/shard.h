@@ -0,0 +1,19 @@
+// ------------------------------------------------------------------
+//   shard.h
+//   Copyright (C) 2025-2025 Genozip Limited. Patent pending.
+//   Please see terms and conditions in the file LICENSE.txt
+//
+//   WARNING: Genozip is proprietary, not open source software. Modifying the source code is strictly prohibited
+//   and subject to penalties specified in the license.
+
+#pragma once
+
+#include "genozip.h"
+
+extern void shard_set_shard_by (rom optarg);
+extern void shard_set_output_pattern (rom optarg);
+
+// PIZ
+extern void shard_piz_calculate (void);
+extern uint32_t shard_piz_get_num_shards (void);
+extern void shard_piz_set_flags (uint32_t shard_i);
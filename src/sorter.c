@@ -0,0 +1,73 @@
+// ------------------------------------------------------------------
+//   sorter.c
+//   Copyright (C) 2019-2025 Genozip Limited. Patent Pending.
+//   Please see terms and conditions in the file LICENSE.txt
+//
+//   WARNING: Genozip is proprietary, not open source software. Modifying the source code is strictly prohibited
+//   and subject to penalties specified in the license.
+
+#include "sorter.h"
+
+// scatters entries of src to dst according to the byte of the key at byte_i. ent_size is a compile-time constant in
+// the common cases, so that memcpy compiles to a single load/store
+#define RADIX_SCATTER(ent_size) ({                                                          \
+    for (uint64_t i=0; i < len; i++) {                                                      \
+        uint8_t byte = radix_get_key (&src[i * (ent_size) + key_offset], key_size) >> (byte_i * 8); \
+        memcpy (&dst[offsets[byte]++ * (ent_size)], &src[i * (ent_size)], (ent_size));      \
+    }                                                                                       \
+})
+
+static inline uint64_t radix_get_key (const char *key, uint32_t key_size)
+{
+    if (key_size == 4) { uint32_t k; memcpy (&k, key, 4); return k; }
+    else               { uint64_t k; memcpy (&k, key, 8); return k; }
+}
+
+// stable LSD radix sort, 8 bits at a time, of an array of entries by an unsigned 32 or 64 bit key field.
+// Histograms of all bytes are collected in a single pass, and bytes that are the same in all keys are skipped.
+void radix_sort_do (void *data, uint64_t len, uint32_t ent_size, uint32_t key_offset, uint32_t key_size)
+{
+    if (len < 2) return;
+
+    ASSERT (key_size == 4 || key_size == 8, "expecting key_size=%u to be 4 or 8", key_size);
+
+    uint64_t (*counts)[256] = CALLOC (key_size * 256 * sizeof (uint64_t));
+
+    for (uint64_t i=0; i < len; i++) {
+        uint64_t key = radix_get_key ((char *)data + i * ent_size + key_offset, key_size);
+
+        for (uint32_t byte_i=0; byte_i < key_size; byte_i++, key >>= 8)
+            counts[byte_i][key & 0xff]++;
+    }
+
+    char *src = data, *dst = MALLOC (len * ent_size), *dst_alloc = dst;
+    uint8_t first_key_bytes[8];
+    uint64_t first_key = radix_get_key (&src[key_offset], key_size);
+
+    for (uint32_t byte_i=0; byte_i < key_size; byte_i++)
+        first_key_bytes[byte_i] = first_key >> (byte_i * 8);
+
+    for (uint32_t byte_i=0; byte_i < key_size; byte_i++) {
+        if (counts[byte_i][first_key_bytes[byte_i]] == len) continue; // all keys have the same value in this byte
+
+        uint64_t offsets[256], sum=0;
+        for (int b=0; b < 256; b++) {
+            offsets[b] = sum;
+            sum += counts[byte_i][b];
+        }
+
+        switch (ent_size) {
+            case 4  : RADIX_SCATTER (4);        break;
+            case 8  : RADIX_SCATTER (8);        break;
+            case 16 : RADIX_SCATTER (16);       break;
+            default : RADIX_SCATTER (ent_size); break;
+        }
+
+        SWAP (src, dst);
+    }
+
+    if (src != data) memcpy (data, src, len * ent_size); // odd number of passes
+
+    FREE (dst_alloc);
+    FREE (counts);
+}
@@ -910,12 +910,12 @@ void stats_generate (void) // specific section, or COMP_NONE if for the entire f
                                ST_NAME (SEC_REF_CONTIGS), ST_NAME (SEC_CHROM2REF_MAP),
                                ST_NAME (SEC_REF_IUPACS));
 
-    stats_consolidate_non_ctx (sbl, sbl_buf.len32, "Other", 19 + (DTPZ(txt_header_required) == HDR_NONE), "E1L", "E2L", "EOL", 
+    stats_consolidate_non_ctx (sbl, sbl_buf.len32, "Other", 20 + (DTPZ(txt_header_required) == HDR_NONE), "E1L", "E2L", "EOL", 
                                "SAMPLES", "AUX", TOPLEVEL, "TOP2BAM", "TOP2NONE", "TOP2VCF", "BAM_BIN", "LINEMETA", "CONTIG", "SAG", "SAALN",
-                               ST_NAME (SEC_DICT_ID_ALIASES), ST_NAME (SEC_RECON_PLAN), ST_NAME (SEC_GENCOMP),
+                               ST_NAME (SEC_DICT_ID_ALIASES), ST_NAME (SEC_RECON_PLAN), ST_NAME (SEC_GENCOMP), ST_NAME (SEC_DICT_TEMPLATE),
                                ST_NAME (SEC_VB_HEADER), ST_NAME (SEC_MGZIP), ST_NAME(SEC_TXT_HEADER)/*must be last*/);
         
-    stats_consolidate_non_ctx (sbl, sbl_buf.len32, "RandomAccessIndex", 2, ST_NAME (SEC_RANDOM_ACCESS), ST_NAME (SEC_REF_RAND_ACC));
+    stats_consolidate_non_ctx (sbl, sbl_buf.len32, "RandomAccessIndex", 4, ST_NAME (SEC_RANDOM_ACCESS), ST_NAME (SEC_REF_RAND_ACC), ST_NAME (SEC_RA_LINES), ST_NAME (SEC_AGGREGATES));
     
     ASSERTW (all_txt_len == txt_size || flag.make_reference, // all_txt_len=0 in make-ref as there are no contexts
              "Expecting all_txt_len=Σ(ctx.txt_len)=%"PRId64" == txt_size%s=%"PRId64" (diff=%"PRId64")", 
@@ -125,32 +125,41 @@ StrText str_bases (uint64_t num_bases)
     return s;
 }
 
-// returns length
+static const char digit_pairs[201] = // "00" "01" ... "99"
+    "0001020304050607080910111213141516171819202122232425262728293031323334353637383940414243444546474849"
+    "5051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+// returns length. Emits two digits per division, using a table of digit pairs.
 uint32_t str_int_ex (int64_t n, char *str /* out */, bool add_nul_terminator)
 {
     uint32_t len=0;
+    if (n < 0) str[len++] = '-';
 
-    if (n==0) {
-        str[0] = '0';
-        len=1;
-    }
+    uint64_t u = (n < 0) ? -(uint64_t)n : (uint64_t)n; // correct for INT64_MIN too
+
+    if (u < 10) // most common case
+        str[len++] = '0' + u;
 
     else {
-        bool is_negative = (n<0);
-        if (is_negative) n = -n;
+        char rev[20], *next = rev + sizeof (rev); // longest uint64: 20 digits, filled from the end
 
-        char rev[50] = {}; // "initialize" to avoid compiler warning
-        while (n) {
-            rev[len++] = '0' + n % 10;
-            n /= 10;
+        while (u >= 100) {
+            uint32_t pair = u % 100;
+            u /= 100;
+            next -= 2;
+            memcpy (next, &digit_pairs[pair * 2], 2);
         }
-        // now reverse it
-        for (int i=0; i < len; i++) str[i + is_negative] = rev[len-i-1];
 
-        if (is_negative) {
-            str[0] = '-';
-            len++;
+        if (u >= 10) {
+            next -= 2;
+            memcpy (next, &digit_pairs[u * 2], 2);
         }
+        else
+            *--next = '0' + u;
+
+        uint32_t num_digits = rev + sizeof (rev) - next;
+        memcpy (&str[len], next, num_digits);
+        len += num_digits;
     }
 
     if (add_nul_terminator) str[len] = '\0'; // string terminator
@@ -254,6 +263,25 @@ bool str_is_simple_float (STRp(str),
     return true;
 } 
 
+#ifdef __LITTLE_ENDIAN__
+static const int64_t str_pow10[9] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+
+// true if all 8 bytes are '0'-'9'
+static inline bool str_is_8_digits (uint64_t chunk)
+{
+    return ((chunk & 0xF0F0F0F0F0F0F0F0ULL) == 0x3030303030303030ULL) &&
+           (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) == 0x3030303030303030ULL);
+}
+
+// converts 8 ASCII digits (first digit in lowest byte) to their value, combining pairs of digits, then pairs of pairs...
+static inline uint32_t str_parse_8_digits (uint64_t chunk)
+{
+    chunk = ((chunk & 0x0F0F0F0F0F0F0F0FULL) * 2561) >> 8;
+    chunk = ((chunk & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+    return ((chunk & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32;
+}
+#endif
+
 // similar to strtoull, except it rejects numbers that are shorter than str_len, or that their reconstruction would be different
 // the the original string.
 // returns true if successfully parsed an integer of the full length of the string
@@ -269,15 +297,40 @@ bool str_get_int (STRp(str),
         (str_len >= 2 && str[0] == '-' && str[1] == '0')) return false;
 
     uint32_t negative = (str[0] == '-');
+    rom digits = str + negative;
+    uint32_t n_digits = str_len - negative;
+
+    // case: up to 18 digits - can't overflow int64_t
+    if (n_digits <= 18) {
+#ifdef __LITTLE_ENDIAN__
+        // parse 8 digits at a time - the final 4 to 7 digits are right-aligned in a '0'-padded word
+        while (n_digits >= 4) {
+            uint32_t chunk_len = MIN_(n_digits, 8);
+            uint64_t chunk = 0x3030303030303030ULL;
+            memcpy ((char *)&chunk + 8 - chunk_len, digits, chunk_len);
+
+            if (!str_is_8_digits (chunk)) return false;
+
+            out = out * str_pow10[chunk_len] + str_parse_8_digits (chunk);
+            digits   += chunk_len;
+            n_digits -= chunk_len;
+        }
+#endif
+        for (uint32_t i=0; i < n_digits; i++) {
+            if (!IS_DIGIT(digits[i])) return false;
+            out = (out * 10) + (digits[i] - '0');
+        }
+    }
 
-    for (uint32_t i=negative; i < str_len; i++) {
-        if (!IS_DIGIT(str[i])) return false;
+    else 
+        for (uint32_t i=0; i < n_digits; i++) {
+            if (!IS_DIGIT(digits[i])) return false;
 
-        int64_t prev_out = out;
-        out = (out * 10) + (str[i] - '0');
+            int64_t prev_out = out;
+            out = (out * 10) + (digits[i] - '0');
 
-        if (out < prev_out) return false; // number overflowed beyond maximum int64_t
-    }
+            if (out < prev_out) return false; // number overflowed beyond maximum int64_t
+        }
 
     if (negative) out = -out;
 
@@ -738,8 +791,12 @@ rom str_split_by_tab_do (STRp(str),
     uint32_t fld_i = 1; 
     uint32_t str_i;
     bool my_has_13;
+    rom after = str + str_len;
 
     for (str_i=0 ; str_i < str_len ; str_i++) {
+        str_i = str_find_first_of3 (&str[str_i], after, '\t', '\n', '\r') - str; // skip to next separator
+        if (str_i == str_len) break;
+
         char c = str[str_i]; 
         if (c == '\t') {
             if (fld_i >= *n_flds)  // excess
@@ -8,7 +8,11 @@
 
 #pragma once
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include "genozip.h"
+#include "endianness.h"
 
 #define IS_DIGIT(c)        ((c)>='0' && (c)<='9')
 #define NUM2HEXDIGIT(n)    ((n)<=9 ? '0' + (n) : 'a'+((n)-10))      
@@ -165,6 +169,44 @@ static inline uint32_t str_count_char (rom str, uint32_t len, char c)
     return count;
 }
 
+// returns the first occurance of any of the 3 characters in [s, after), or after if none. This is the inner loop of 
+// line and field splitting: 16 bytes at a time with SSE2, or 8 bytes at a time on other little-endian CPUs
+static inline rom str_find_first_of3 (rom s, rom after, char c1, char c2, char c3)
+{
+#ifdef __SSE2__
+    __m128i v1 = _mm_set1_epi8 (c1), v2 = _mm_set1_epi8 (c2), v3 = _mm_set1_epi8 (c3);
+
+    for (; s + 16 <= after; s += 16) {
+        __m128i data = _mm_loadu_si128 ((const __m128i *)s);
+        int mask = _mm_movemask_epi8 (_mm_or_si128 (_mm_or_si128 (_mm_cmpeq_epi8 (data, v1), _mm_cmpeq_epi8 (data, v2)), 
+                                                    _mm_cmpeq_epi8 (data, v3)));
+        if (mask) return s + __builtin_ctz (mask);
+    }
+
+#elif defined __LITTLE_ENDIAN__
+    #define ONES  0x0101010101010101ULL
+    #define HIGHS 0x8080808080808080ULL
+    #define HAS_ZERO_BYTE(v) (((v) - ONES) & ~(v) & HIGHS) // lowest set bit is exact - false positives are only above a true zero byte
+
+    for (; s + 8 <= after; s += 8) {
+        uint64_t data; 
+        memcpy (&data, s, 8);
+        uint64_t mask = HAS_ZERO_BYTE (data ^ (ONES * (uint8_t)c1)) | HAS_ZERO_BYTE (data ^ (ONES * (uint8_t)c2)) | 
+                        HAS_ZERO_BYTE (data ^ (ONES * (uint8_t)c3));
+        if (mask) return s + (__builtin_ctzll (mask) >> 3);
+    }
+
+    #undef ONES
+    #undef HIGHS
+    #undef HAS_ZERO_BYTE
+#endif
+
+    for (; s < after; s++)
+        if (*s == c1 || *s == c2 || *s == c3) return s;
+
+    return after;
+}
+
 // true if entire string is a single character
 static inline bool str_is_monochar (STRp(str))
 {
@@ -985,6 +985,11 @@ batch_grep_count_lines()
 
     # regions
     test_count_genocat_lines "$TESTDIR/basic.vcf" "--regions 13:207237509-207237510,1:207237250 -H" 7
+
+    # regions with the sub-VB index, and --head / --lines (lines after the last one written are not reconstructed)
+    test_count_genocat_lines "$TESTDIR/basic.vcf --sub-vb-index 16" "--regions 13:207237509-207237510,1:207237250 -H" 7
+    test_count_genocat_lines "" "--head=5 -H" 5
+    test_count_genocat_lines "" "--lines=5-9 -H" 5
 }
 
 ass_eq_num() # $1 result $2 expected
@@ -2618,6 +2623,328 @@ batch_bamass()
     cleanup
 }
 
+# --resumable: interrupt after a checkpoint (using --debug-resume), --resume, and verify the digest
+batch_resume()
+{
+    batch_print_header
+
+    local file
+    for file in basic.vcf basic.sam basic.fq; do
+        test_header "$file - --resumable interrupted, then --resume"
+        $genozip $TESTDIR/$file -B2000B --resumable --debug-resume -Xfo $output
+        verify_failure "genozip --debug-resume" $?
+
+        $genozip $TESTDIR/$file -B2000B --resumable --debug-resume -Xfo $output --resume || exit 1
+        $genounzip -t $output || exit 1
+
+        local recon=$OUTDIR/recon.$file
+        $genocat_no_echo $output --no-pg -fo $recon || exit 1
+        cmp_2_files $TESTDIR/$file $recon
+    done
+
+    cleanup
+}
+
+# genocat --filter: compare to the equivalent fixed-option filters
+batch_filter()
+{
+    batch_print_header
+
+    test_header "--filter on VCF, compared to --regions"
+    local file=$OUTDIR/basic.vcf.genozip
+    $genozip $TESTDIR/basic.vcf -B100000B -Xfo $file || exit 1 # -B so we have several VBs for predicate pushdown to exclude
+    ass_eq_num "`$genocat_no_echo $file --filter 'CHROM==1' --count`" "`$genocat_no_echo $file --regions 1 --count`"
+    ass_eq_num "`$genocat_no_echo $file --filter '"1"==CHROM && POS>=1000 && POS<=207237509' --count`" "`$genocat_no_echo $file --regions 1:1000-207237509 --count`"
+    ass_eq_num "`$genocat_no_echo $file --filter 'CHROM==NONEXISTANT' --count`" 0
+
+    test_header "--filter on BAM, compared to --MAPQ and --FLAG"
+    file=$OUTDIR/test.human2.bam.genozip
+    $genozip $TESTDIR/test.human2.bam -B100000B -Xfo $file || exit 1
+    ass_eq_num "`$genocat_no_echo $file --filter 'MAPQ>=20' --count`" "`$genocat_no_echo $file --MAPQ 20 --count`"
+    ass_eq_num "`$genocat_no_echo $file --filter 'FLAG&0x800' --count`" "`$genocat_no_echo $file --FLAG=+SUPPLEMENTARY --count`"
+    ass_eq_num "`$genocat_no_echo $file --filter '!(FLAG&0x30)' --count`" "`$genocat_no_echo $file --FLAG=-0x0030 --count`"
+    ass_eq_num "`$genocat_no_echo $file --filter 'RNAME==1' --count --sam`" "`$genocat_no_echo $file -r 1 --count`"
+
+    test_header "--filter string comparison is rejected when outputting BAM"
+    $genocat_no_echo $file --filter 'RNAME=="1"' --bam -fo $OUTDIR/filter.bam
+    verify_failure "genocat --filter on BAM output" $?
+
+    cleanup
+}
+
+# genocat --shard-by + --output-pattern: the shards together have all the lines of the file
+batch_shard()
+{
+    batch_print_header
+
+    local file=$OUTDIR/basic.vcf.genozip
+    $genozip $TESTDIR/basic.vcf -B100000B -Xfo $file || exit 1 # -B so we have several VBs
+    local num_lines=`$genocat_no_echo $file --no-header | wc -l`
+    
+    local shard_by
+    for shard_by in chrom vb-count:2 size:1; do
+        test_header "--shard-by=$shard_by"
+        rm -f $OUTDIR/shard.*.vcf
+        $genocat $file --shard-by=$shard_by --output-pattern=$OUTDIR/shard.%s.vcf || exit 1
+        ass_eq_num "`cat $OUTDIR/shard.*.vcf | grep -v '^#' | wc -l`" $num_lines
+    done
+
+    test_header "--shard-by=chrom is rejected for a file without a random access index"
+    $genozip $TESTDIR/special.pacbio.ccs.bam -Xfo $output || exit 1 # unaligned
+    $genocat $output --shard-by=chrom --output-pattern=$OUTDIR/shard.%s.bam
+    verify_failure "genocat --shard-by=chrom" $?
+
+    rm -f $OUTDIR/shard.*
+    cleanup
+}
+
+# genozip --sample-blocks: genocat --samples must give the same result as without sample blocks
+batch_sample_blocks()
+{
+    batch_print_header
+
+    local blocks=$OUTDIR/blocks.vcf.genozip
+    $genozip $TESTDIR/basic.vcf -Xfo $output || exit 1
+    $genozip $TESTDIR/basic.vcf --sample-blocks=1 -Xfo $blocks || exit 1
+    $genounzip -t $blocks || exit 1
+
+    local sample # second sample in the file
+    sample=`$genocat_no_echo $output --header-only | grep "^#CHROM" | cut -f11` || exit 1
+    if [ "$sample" == "" ]; then echo "basic.vcf is expected to have at least two samples"; exit 1; fi
+
+    local i
+    for i in 1 2; do
+        test_header "--samples $sample ${i}"
+        $genocat_no_echo $output --samples $sample --no-header -fo $OUTDIR/samples.vcf || exit 1
+        $genocat_no_echo $blocks --samples $sample --no-header -fo $OUTDIR/samples.blocks.vcf || exit 1
+        cmp_2_files $OUTDIR/samples.vcf $OUTDIR/samples.blocks.vcf
+        sample="^$sample" # second iteration: all samples except this one
+    done
+
+    rm -f $blocks $OUTDIR/samples.vcf $OUTDIR/samples.blocks.vcf
+    cleanup
+}
+
+batch_aggregates()
+{
+    batch_print_header
+
+    # BAM: --coverage and --idxstats are answered from SEC_AGGREGATES without reconstruction - expecting the same results
+    local agg=$OUTDIR/agg.bam.genozip
+    $genozip $TESTDIR/test.human3-collated.bam -B2000B -Xfo $output || exit 1
+    $genozip $TESTDIR/test.human3-collated.bam -B2000B --aggregates -Xfo $agg || exit 1
+    $genounzip -t $agg || exit 1
+
+    local opt
+    for opt in --coverage --idxstats; do
+        test_header "$opt with and without --aggregates"
+        $genocat_no_echo $output $opt > $OUTDIR/no_agg.txt || exit 1
+        $genocat_no_echo $agg $opt > $OUTDIR/agg.txt || exit 1
+        cmp_2_files $OUTDIR/no_agg.txt $OUTDIR/agg.txt
+    done
+
+    # --count --regions: VBs fully inside or outside the regions are counted from SEC_AGGREGATES
+    ass_eq_num "`$genocat_no_echo $agg -r chr1 --count`" "`$genocat_no_echo $output -r chr1 --count`"
+    ass_eq_num "`$genocat_no_echo $agg -r ^chr1 --count`" "`$genocat_no_echo $output -r ^chr1 --count`"
+
+    # VCF: --count --regions
+    $genozip $TESTDIR/basic.vcf -B2000B -Xfo $output || exit 1
+    $genozip $TESTDIR/basic.vcf -B2000B --aggregates -Xfo $agg || exit 1
+    ass_eq_num "`$genocat_no_echo $agg -r 1 --count`" "`$genocat_no_echo $output -r 1 --count`"
+    ass_eq_num "`$genocat_no_echo $agg -r 13:207237509-207237510,1:207237250 --count`" "`$genocat_no_echo $output -r 13:207237509-207237510,1:207237250 --count`"
+
+    rm -f $agg $OUTDIR/no_agg.txt $OUTDIR/agg.txt
+    cleanup
+}
+
+# compare region queries and idxstats on a file with the index created by --index, and with an index created by samtools / tabix
+batch_index()
+{
+    batch_print_header
+    local region
+    rm -f $OUTDIR/index.genozip.txt $OUTDIR/index.samtools.txt
+
+    # BAM: .bai created while writing
+    if `command -v samtools >& /dev/null`; then
+        local bam=$OUTDIR/index.bam
+        $genozip $TESTDIR/test.human2.bam -Xfo $output || exit 1
+        $genounzip $output --index -fo $bam || exit 1
+        if [ ! -f $bam.bai ]; then echo "$bam.bai was not created"; exit 1; fi
+
+        for region in 1 1:1-10000000 1:100000000-100100000 '*'; do
+            echo "`samtools view -c $bam $region`" >> $OUTDIR/index.genozip.txt || exit 1
+        done
+        samtools idxstats $bam >> $OUTDIR/index.genozip.txt || exit 1
+
+        samtools index $bam || exit 1 # overwrite our .bai
+        for region in 1 1:1-10000000 1:100000000-100100000 '*'; do
+            echo "`samtools view -c $bam $region`" >> $OUTDIR/index.samtools.txt || exit 1
+        done
+        samtools idxstats $bam >> $OUTDIR/index.samtools.txt || exit 1
+
+        cmp_2_files $OUTDIR/index.genozip.txt $OUTDIR/index.samtools.txt
+        rm -f $bam $bam.bai $OUTDIR/index.genozip.txt $OUTDIR/index.samtools.txt
+    fi
+
+    # VCF: .tbi created while writing
+    if `command -v tabix >& /dev/null`; then
+        local vcf=$OUTDIR/index.vcf.gz
+        $genozip $TESTDIR/basic.vcf -Xfo $output || exit 1
+        $genounzip $output --index -fo $vcf || exit 1
+        if [ ! -f $vcf.tbi ]; then echo "$vcf.tbi was not created"; exit 1; fi
+
+        for region in 1 1:1-1000000 1:207237250 13 13:207237509-207237510; do
+            tabix $vcf $region >> $OUTDIR/index.genozip.txt || exit 1
+        done
+
+        tabix -f -p vcf $vcf || exit 1 # overwrite our .tbi
+        for region in 1 1:1-1000000 1:207237250 13 13:207237509-207237510; do
+            tabix $vcf $region >> $OUTDIR/index.samtools.txt || exit 1
+        done
+
+        cmp_2_files $OUTDIR/index.genozip.txt $OUTDIR/index.samtools.txt
+        rm -f $vcf $vcf.tbi $OUTDIR/index.genozip.txt $OUTDIR/index.samtools.txt
+    fi
+
+    cleanup
+}
+
+batch_sort()
+{
+    batch_print_header
+
+    local file=$TESTDIR/test.human3-collated.bam
+    $genozip $file -Xfo $output || exit 1
+
+    ass_eq_num "`$genocat_no_echo $output --sort --sam | grep "^@HD" | grep -c SO:coordinate`" 1
+    ass_eq_num "`$genocat_no_echo $output --sort --sam --no-header | wc -l`" "`$genocat_no_echo $output --sam --no-header | wc -l`"
+
+    # compare coordinates (but not order of alignments with the same coordinate) with samtools sort
+    if `command -v samtools >& /dev/null`; then
+        $genocat_no_echo $output --sort --bam -fo $OUTDIR/sorted.bam || exit 1
+        samtools sort $file -o $OUTDIR/samtools.sorted.bam || exit 1
+        samtools view $OUTDIR/sorted.bam | cut -f3,4 > $OUTDIR/sorted.txt || exit 1
+        samtools view $OUTDIR/samtools.sorted.bam | cut -f3,4 > $OUTDIR/samtools.sorted.txt || exit 1
+        cmp_2_files $OUTDIR/sorted.txt $OUTDIR/samtools.sorted.txt
+        rm -f $OUTDIR/sorted.bam $OUTDIR/samtools.sorted.bam $OUTDIR/sorted.txt $OUTDIR/samtools.sorted.txt
+    fi
+
+    cleanup
+}
+
+batch_arrow()
+{
+    batch_print_header
+    local arrow=$OUTDIR/test.arrow
+
+    # stream must end with the end-of-stream marker: continuation (0xffffffff) and a zero metadata length
+    $genozip $TESTDIR/basic.vcf -Xfo $output || exit 1
+    $genocat_no_echo $output --arrow=CHROM,POS:int,REF,QUAL:float -fo $arrow || exit 1
+    if [ "`tail -c 8 $arrow | od -An -tx1 | tr -d ' \n'`" != "ffffffff00000000" ]; then echo "$arrow: missing end-of-stream marker"; exit 1; fi
+
+    # if pyarrow is available, verify that the stream is readable and has the expected number of rows
+    if `python3 -c "import pyarrow" >& /dev/null`; then
+        local count=`$genocat_no_echo $output --count`
+        ass_eq_num "`python3 -c "import pyarrow as pa; print (pa.ipc.open_stream (open ('$arrow', 'rb')).read_all().num_rows)"`" $count
+
+        $genozip $TESTDIR/test.human2.bam -Xfo $output || exit 1
+        $genocat_no_echo $output --arrow=RNAME,POS:int,MAPQ:int,CIGAR -fo $arrow || exit 1
+        count=`$genocat_no_echo $output --count`
+        ass_eq_num "`python3 -c "import pyarrow as pa; print (pa.ipc.open_stream (open ('$arrow', 'rb')).read_all().num_rows)"`" $count
+    fi
+
+    rm -f $arrow
+    cleanup
+}
+
+batch_codec_profile()
+{
+    batch_print_header
+    local profile=$OUTDIR/codec.profile
+    rm -f $profile
+
+    local file
+    for file in basic.vcf basic.sam basic.fq; do
+        test_header "--codec-profile $file: creating the profile, then using it"
+        $genozip $TESTDIR/$file --codec-profile $profile -B2000B -ft -o $output || exit 1
+        if [ ! -s $profile ]; then echo "$profile was not created"; exit 1; fi
+
+        $genozip $TESTDIR/$file --codec-profile $profile -B2000B -ft -o $output || exit 1 # profiled codecs are verified, not tested
+        $genozip $TESTDIR/$file --codec-profile $profile -B2000B --best -ft -o $output || exit 1
+    done
+
+    rm -f $profile
+    cleanup
+}
+
+batch_progressive()
+{
+    batch_print_header
+
+    # a file with PRIM/DEPN components, whose lines are inserted into MAIN VBs by the writer
+    $genozip $TESTDIR/special.depn.bam --force-gencomp -B100000B -Xfo $output || exit 1
+
+    $genocat_no_echo $output --bam -fo $OUTDIR/normal.bam || exit 1
+    $genocat_no_echo $output --bam --progressive -fo $OUTDIR/progressive.bam || exit 1
+    cmp_2_files $OUTDIR/normal.bam $OUTDIR/progressive.bam
+
+    # downstream closes the pipe early
+    ass_eq_num "`$genocat_no_echo $output --progressive --no-header | head -1 | wc -l`" 1
+
+    rm -f $OUTDIR/normal.bam $OUTDIR/progressive.bam
+    cleanup
+}
+
+# microbenchmarks, which also verify the optimized implementations against the reference ones (developer builds only)
+batch_benchmarks()
+{
+    batch_print_header
+    if [ ! -n "$is_debug" ]; then return; fi
+
+    $genozip --bench-checksum || exit 1 # verifies crc32/adler32 combine at odd split points
+
+    # SIMD kernels must produce the same output as scalar (speeds are informational only)
+    local mismatches=`$genozip --bench-acgt | tee /dev/stderr | grep -c MISMATCH`
+    ass_eq_num $mismatches 0
+}
+
+batch_dict_template()
+{
+    batch_print_header
+
+    for file in basic.vcf basic.fq; do
+        test_header "$file - compress and decompress with --dict-template"
+        local tmpl=$OUTDIR/template.${file##*.}.genozip
+        local recon=$OUTDIR/recon.${file##*.}
+        $genozip $TESTDIR/$file -fo $tmpl || exit 1
+        $genozip $TESTDIR/$file --dict-template=$tmpl -fo $output || exit 1
+        $genounzip $output --dict-template=$tmpl -fo $recon || exit 1
+        cmp_2_files $TESTDIR/$file $recon
+
+        test_header "$file - expecting failure: decompress without --dict-template"
+        $genounzip $output -fo $recon
+        verify_failure genounzip $?
+    done
+
+    test_header "expecting failure: decompress with a template other than the one used to compress"
+    local tmpl2=$OUTDIR/template2.vcf.genozip
+    $genozip $TESTDIR/test.human2.filtered.snp.vcf -fo $tmpl2 || exit 1
+    $genozip $TESTDIR/basic.vcf --dict-template=$OUTDIR/template.vcf.genozip -fo $output || exit 1
+    $genounzip $output --dict-template=$tmpl2 -fo $OUTDIR/recon.vcf
+    verify_failure genounzip $?
+
+    test_header "expecting failure: template of a different data type"
+    $genozip $TESTDIR/basic.vcf --dict-template=$OUTDIR/template.fq.genozip -fo $output
+    verify_failure genozip $?
+
+    test_header "expecting failure: --dict-template with an unsupported data type"
+    $genozip $TESTDIR/basic.sam --dict-template=$OUTDIR/template.vcf.genozip -fo $OUTDIR/basic.sam.genozip
+    verify_failure genozip $?
+
+    rm -f $OUTDIR/template.vcf.genozip $OUTDIR/template.fq.genozip $tmpl2 $OUTDIR/recon.vcf $OUTDIR/recon.fq $OUTDIR/basic.sam.genozip
+    cleanup
+}
+
 # only if doing a full test (starting from 0) - delete genome and hash caches
 sparkling_clean()
 {
@@ -2880,6 +3207,18 @@ case $GENOZIP_TEST in
 75)  batch_basic basic.gtf     latest  ;;
 76)  batch_basic basic.me23    latest  ;;
 77)  batch_basic basic.generic latest  ;;
+78)  batch_resume                      ;;
+79)  batch_filter                      ;;
+80)  batch_shard                       ;;
+81)  batch_sample_blocks               ;;
+82)  batch_aggregates                  ;;
+83)  batch_index                       ;;
+84)  batch_sort                        ;;
+85)  batch_arrow                       ;;
+86)  batch_codec_profile               ;;
+87)  batch_progressive                 ;;
+88)  batch_benchmarks                  ;;
+89)  batch_dict_template               ;;
 
 * ) break; # break out of loop
 
@@ -0,0 +1,672 @@
+// ------------------------------------------------------------------
+//   txt_index.c
+//   Copyright (C) 2025-2025 Genozip Limited. Patent Pending.
+//   Please see terms and conditions in the file LICENSE.txt
+//
+//   WARNING: Genozip is proprietary, not open source software. Modifying the source code is strictly prohibited,
+//   under penalties specified in the license.
+
+// genounzip/genocat --index of a BGZF-compressed BAM, VCF, GFF or BED file: build the .bai / .tbi (or .csi if a contig
+// is too long for them) while writing, instead of running "samtools index" or "tabix" on the completed file.
+// For BAM, records are parsed in the writer thread as they are flushed. For VCF, GFF and BED, the compute threads capture
+// the CHROM, start and end of each line as it is reconstructed, and the writer thread places the lines in the output.
+// The BGZF blocks are registered as they are written, and at the end, uncompressed offsets are converted to virtual offsets.
+
+#include <errno.h>
+#include "txt_index.h"
+#include "buffer.h"
+#include "file.h"
+#include "vblock.h"
+#include "mgzip.h"
+#include "endianness.h"
+#include "sorter.h"
+#include "writer.h"
+#include "strings.h"
+
+#define BAI_MIN_SHIFT  14
+#define BAI_NUM_LEVELS 5
+#define CSI_MAX_LEVELS 9
+#define UNSET          0xffffffffffffffffULL
+
+typedef enum { IDX_NONE, IDX_BAI, IDX_TBI } IndexType; // IDX_BAI and IDX_TBI become CSI if needed
+
+typedef struct { uint64_t uoffset, coffset; } BaiBlock;         // a BGZF block: uncompressed offset of its first byte, and its offset in the file
+
+typedef struct { int32_t ref_id; uint32_t bin; uint64_t beg, end; } BaiChunk; // beg, end: uncompressed offsets, until converted in txt_index_finalize
+
+typedef struct {
+    uint64_t l_ref;                      // contig length, from the BAM header
+    uint64_t beg, end;                   // uncompressed offsets of first and after last record of this ref (beg=UNSET if none)
+    uint64_t n_mapped, n_unmapped;
+    uint64_t linear_i, n_intv;           // entries of this ref in linear
+} BaiRef;
+
+// VCF, GFF, BED: captured by the compute thread for each reconstructed line
+typedef struct {
+    uint32_t line_i, chrom_len;
+    WordIndex chrom;                     // WORD_INDEX_NONE if line cannot be indexed
+    int64_t beg, end;                    // 0-based, end exclusive
+} TbiLine;
+
+// tabix configuration of each data type, see tbx_conf_t in htslib
+typedef struct { int32_t format, col_seq, col_beg, col_end, meta, skip; } TbiConf;
+#define TBX_GENERIC 0
+#define TBX_VCF     2
+#define TBX_UCSC    0x10000              // 0-based half-open coordinates
+
+static const TbiConf tbi_conf_vcf = { TBX_VCF,              1, 2, 0, '#', 0 };
+static const TbiConf tbi_conf_gff = { TBX_GENERIC,          1, 4, 5, '#', 0 };
+static const TbiConf tbi_conf_bed = { TBX_GENERIC|TBX_UCSC, 1, 2, 3, '#', 0 };
+
+static struct {
+    IndexType type;
+    bool active;                         // false if not indexing, or if we found the file can't be indexed (eg unsorted)
+    int n_lvls;                          // 5 for BAI and TBI, more for CSI if needed
+    int32_t prev_ref_id;
+    int64_t prev_pos;
+    uint64_t n_no_coor;                  // number of unplaced unmapped reads
+    uint64_t uoffset_so_far;             // uncompressed length of BGZF blocks registered so far
+    Buffer blocks;                       // BaiBlock
+    Buffer chunks;                       // BaiChunk
+    Buffer refs;                         // BaiRef
+    Buffer linear;                       // uint64_t: 16Kbp window linear index of all refs, ordered by ref
+    Buffer cur_linear;                   // uint64_t: linear index of the current ref
+    Buffer chrom_to_ref;                 // TBI: int32_t ref_id for each CHROM word_index, -1 if not encountered yet
+    Buffer names;                        // TBI: nul-terminated ref names, in order of ref_id
+} ti = {};
+
+// PIZ main thread: called after opening the txt_file and setting its BGZF info: decide once per file whether and how
+// it will be indexed, so that the compute threads needn't re-evaluate this for each line
+void txt_index_set_type (void)
+{
+    txt_file->index_type = IDX_NONE;
+
+    if (!flag.index_txt || flag.no_writer || !txt_file->name || // stdout
+        !TXT_IS_BGZF || txt_file->mgzip_flags.library == BGZF_EXTERNAL_LIB)  // same condition as BGZF compression by the writer
+        return;
+
+    switch (txt_file->data_type) {
+        case DT_BAM : txt_file->index_type = IDX_BAI; break;
+        case DT_VCF :
+        case DT_GFF :
+        case DT_BED : txt_file->index_type = IDX_TBI; break;
+        default     : break;
+    }
+}
+
+// same as hts_reg2bin in htslib. end is exclusive.
+static inline uint32_t txt_index_reg2bin (int64_t beg, int64_t end, int n_lvls)
+{
+    int s = BAI_MIN_SHIFT, t = ((1 << ((n_lvls << 1) + n_lvls)) - 1) / 7;
+
+    end--;
+    for (int l = n_lvls; l > 0; l--, s += 3, t -= 1 << ((l << 1) + l))
+        if (beg >> s == end >> s) return t + (beg >> s);
+
+    return 0;
+}
+
+// level of a bin: 0 is the root
+static inline int txt_index_bin_level (uint32_t bin)
+{
+    int l = 0;
+    for (uint32_t first_bin_of_next_level = 1; bin >= first_bin_of_next_level; first_bin_of_next_level = (first_bin_of_next_level << 3) + 1)
+        l++;
+
+    return l;
+}
+
+static inline uint32_t txt_index_meta_bin (void)
+{
+    return ((1 << ((ti.n_lvls + 1) * 3)) - 1) / 7 + 1; // 37450 for BAI
+}
+
+static void txt_index_destroy (void)
+{
+    buf_destroy (ti.blocks);
+    buf_destroy (ti.chunks);
+    buf_destroy (ti.refs);
+    buf_destroy (ti.linear);
+    buf_destroy (ti.cur_linear);
+    buf_destroy (ti.chrom_to_ref);
+    buf_destroy (ti.names);
+}
+
+// writer thread: called when starting to write a txt_file
+void txt_index_initialize (void)
+{
+    txt_index_destroy();
+
+    IndexType type = txt_file ? txt_file->index_type : IDX_NONE;
+
+    ti = (typeof(ti)){ .type        = type,
+                       .active      = (type != IDX_NONE),
+                       .n_lvls      = BAI_NUM_LEVELS,
+                       .prev_ref_id = -1 };
+}
+
+// we can't index this file while writing it (eg it is not sorted) - file_index_txt will run samtools / tabix instead, which will
+// either succeed or report the problem
+static void txt_index_abandon (void)
+{
+    ti.active = false;
+}
+
+// BAM header: get the number of contigs and their lengths, and decide on BAI or CSI
+static void txt_index_add_bam_header (STRp(header))
+{
+    #define HDR_ASSERT(cond) ({ if (!(cond)) { txt_index_abandon(); return; } }) // malformed BAM header
+    HDR_ASSERT (header_len >= 12 && !memcmp (header, "BAM\1", 4));
+
+    uint32_t l_text = GET_UINT32 (&header[4]);
+    HDR_ASSERT (header_len >= 12 + l_text);
+
+    rom next = &header[8 + l_text], after = header + header_len;
+    uint32_t n_ref = GET_UINT32 (next);
+    next += 4;
+
+    buf_alloc_exact_zero (wvb, ti.refs, n_ref, BaiRef, "txt_index.refs");
+    uint64_t max_l_ref = 0;
+
+    for_buf (BaiRef, ref, ti.refs) {
+        HDR_ASSERT (next + 4 <= after);
+        uint32_t l_name = GET_UINT32 (next);
+
+        HDR_ASSERT (next + 8 + l_name <= after);
+        ref->l_ref = GET_UINT32 (next + 4 + l_name);
+        ref->beg   = UNSET;
+
+        MAXIMIZE (max_l_ref, ref->l_ref);
+        next += 8 + l_name;
+    }
+
+    // same as htslib: CSI only if a contig is too long for BAI
+    for (int64_t s = 1LL << (BAI_MIN_SHIFT + 3 * BAI_NUM_LEVELS); max_l_ref > s; s <<= 3)
+        ti.n_lvls++;
+    #undef HDR_ASSERT
+}
+
+// move the linear index of the current ref to the combined linear index
+static void txt_index_finalize_cur_ref (void)
+{
+    if (ti.prev_ref_id < 0) return;
+
+    BaiRef *ref = B(BaiRef, ti.refs, ti.prev_ref_id);
+    ref->linear_i = ti.linear.len;
+    ref->n_intv   = ti.cur_linear.len;
+
+    buf_append_buf (wvb, &ti.linear, &ti.cur_linear, uint64_t, "txt_index.linear");
+    ti.cur_linear.len = 0;
+}
+
+// a position beyond the range of the current number of levels: add a level above the root (i.e. BAI/TBI -> CSI).
+// each bin keeps its offset within its level, which is now one level deeper.
+static bool txt_index_add_level (void)
+{
+    if (ti.n_lvls == CSI_MAX_LEVELS) return false;
+
+    for_buf (BaiChunk, chunk, ti.chunks)
+        chunk->bin += 1 << (3 * txt_index_bin_level (chunk->bin)); // first bin of level l+1 minus first bin of level l
+
+    ti.n_lvls++;
+    return true;
+}
+
+static void txt_index_add_chunk (int32_t ref_id, uint32_t bin, uint64_t beg, uint64_t end)
+{
+    // case: contiguous with previous chunk of the same bin - extend it
+    if (ti.chunks.len) {
+        BaiChunk *last = BLST (BaiChunk, ti.chunks);
+        if (last->ref_id == ref_id && last->bin == bin && last->end == beg) {
+            last->end = end;
+            return;
+        }
+    }
+
+    buf_alloc (wvb, &ti.chunks, 1, 100000, BaiChunk, 2, "txt_index.chunks");
+    BNXT (BaiChunk, ti.chunks) = (BaiChunk){ .ref_id = ref_id, .bin = bin, .beg = beg, .end = end };
+}
+
+// add a placed record (BAM alignment or VCF/GFF/BED line) that occupies [beg,end) of the uncompressed file. pos, pos_end: 0-based, pos_end exclusive
+static void txt_index_add_placed (int32_t ref_id, int64_t pos, int64_t pos_end, bool unmapped, uint64_t beg, uint64_t end)
+{
+    if (ref_id < ti.prev_ref_id || ti.prev_ref_id == -2 || (ref_id == ti.prev_ref_id && pos < ti.prev_pos))
+        return txt_index_abandon(); // file is not sorted by coordinate
+
+    if (ref_id != ti.prev_ref_id) {
+        txt_index_finalize_cur_ref();
+        ti.prev_ref_id = ref_id;
+    }
+    ti.prev_pos = pos;
+
+    while (pos_end > (1LL << (BAI_MIN_SHIFT + 3 * ti.n_lvls)))
+        if (!txt_index_add_level())
+            return txt_index_abandon(); // record ends beyond the maximum position that can be indexed
+
+    BaiRef *ref = B(BaiRef, ti.refs, ref_id);
+    if (ref->beg == UNSET) ref->beg = beg;
+    ref->end = end;
+
+    if (unmapped) ref->n_unmapped++;
+    else          ref->n_mapped++;
+
+    txt_index_add_chunk (ref_id, txt_index_reg2bin (pos, pos_end, ti.n_lvls), beg, end);
+
+    // linear index: offset of first record overlapping each 16Kbp window
+    uint64_t first_w = pos >> BAI_MIN_SHIFT, last_w = (pos_end - 1) >> BAI_MIN_SHIFT;
+    if (last_w >= ti.cur_linear.len) {
+        uint64_t old_len = ti.cur_linear.len;
+        buf_alloc (wvb, &ti.cur_linear, 0, last_w + 1, uint64_t, 2, "txt_index.cur_linear");
+        ti.cur_linear.len = last_w + 1;
+        memset (B64(ti.cur_linear, old_len), 0xff, (ti.cur_linear.len - old_len) * sizeof (uint64_t)); // UNSET
+    }
+
+    for (uint64_t w = first_w; w <= last_w; w++)
+        if (*B64(ti.cur_linear, w) == UNSET) *B64(ti.cur_linear, w) = beg;
+}
+
+static void txt_index_add_bam_record (rom rec, uint64_t beg, uint64_t end)
+{
+    int32_t ref_id = (int32_t)GET_UINT32 (&rec[4]);
+    PosType32 pos  = (int32_t)GET_UINT32 (&rec[8]);
+    uint8_t l_read_name = rec[12];
+    uint16_t n_cigar_op = GET_UINT16 (&rec[16]);
+    uint16_t sam_flag   = GET_UINT16 (&rec[18]);
+
+    // unplaced reads are at the end of the file, and are not binned
+    if (ref_id < 0) {
+        ti.n_no_coor++;
+        txt_index_finalize_cur_ref();
+        ti.prev_ref_id = -2; // no more placed reads are expected
+        return;
+    }
+
+    if (ref_id >= ti.refs.len32 || pos < 0)
+        return txt_index_abandon(); // RNAME or POS out of range
+
+    // reference end of the alignment. Note: a CIGAR longer than 65535 ops, moved to a CG tag, is replaced by
+    // <l_seq>S<ref_len>N, so we get the correct ref_len
+    bool unmapped = sam_flag & 4;
+    int64_t ref_len = 0;
+
+    if (!unmapped) {
+        rom cigar = &rec[36 + l_read_name];
+        for (uint32_t i=0; i < n_cigar_op; i++) {
+            uint32_t op = GET_UINT32 (&cigar[i*4]);
+            if ((1 << (op & 0xf)) & 0x18D) ref_len += op >> 4; // M, D, N, = or X consume the reference
+        }
+    }
+
+    txt_index_add_placed (ref_id, pos, pos + MAX_(ref_len, 1), unmapped, beg, end);
+}
+
+// split the first n_flds tab-separated fields of a line (excluding newline). returns false if the line has fewer fields.
+static bool txt_index_get_flds (rom line, rom after, int n_flds, rom *flds, uint32_t *fld_lens)
+{
+    for (int i=0; i < n_flds; i++) {
+        if (!line) return false;
+
+        rom tab = memchr (line, '\t', after - line);
+        flds[i] = line;
+        fld_lens[i] = (tab ? tab : after) - line;
+        line = tab ? tab + 1 : NULL;
+    }
+
+    return true;
+}
+
+// VCF: END from INFO, or 0 if there isn't one
+static int64_t txt_index_get_vcf_info_END (STRp(info))
+{
+    str_split (info, info_len, 0, ';', item, false);
+
+    for (uint32_t i=0; i < n_items; i++) {
+        int64_t end;
+        if (item_lens[i] > 4 && !memcmp (items[i], "END=", 4) && str_get_int (items[i] + 4, item_lens[i] - 4, &end))
+            return end;
+    }
+
+    return 0;
+}
+
+// compute thread: called from container_reconstruct after reconstructing a non-dropped VCF, GFF or BED line: capture its
+// CHROM, start and end as tabix would calculate them (see tbx_parse1 in htslib)
+void txt_index_capture_line (VBlockP vb)
+{
+    if (txt_file->index_type != IDX_TBI) return;
+
+    rom line = Btxt (vb->line_start), after = BAFTtxt;
+
+    if (line < after && after[-1] == '\n') after--;
+    if (line < after && after[-1] == '\r') after--;
+
+    if (line == after || *line == '#') return; // tabix skips meta lines (and so do we)
+
+    rom flds[8];
+    uint32_t fld_lens[8];
+    int64_t beg, end;
+    bool ok;
+
+    switch (vb->data_type) {
+        case DT_VCF: // 1-based POS, and end is POS+len(REF)-1, or INFO/END
+            if ((ok = txt_index_get_flds (line, after, 8, flds, fld_lens) && str_get_int (STRi(fld, 1), &beg))) {
+                beg--;
+                end = beg + fld_lens[3];
+
+                int64_t info_end = txt_index_get_vcf_info_END (STRi(fld, 7));
+                if (info_end > beg) end = info_end;
+            }
+            break;
+
+        case DT_GFF: // 1-based start and end, end inclusive
+            if ((ok = txt_index_get_flds (line, after, 5, flds, fld_lens) && str_get_int (STRi(fld, 3), &beg) && str_get_int (STRi(fld, 4), &end)))
+                beg--;
+            break;
+
+        case DT_BED: // 0-based start, exclusive end
+            ok = txt_index_get_flds (line, after, 3, flds, fld_lens) && str_get_int (STRi(fld, 1), &beg) && str_get_int (STRi(fld, 2), &end);
+            break;
+
+        default:
+            return;
+    }
+
+    // CHROM is identified by its word index, which is the same across VBs
+    bool chrom_ok = ok && vb->chrom_node_index != WORD_INDEX_NONE && str_issame_(STRi(fld, 0), STRa(vb->chrom_name));
+
+    buf_alloc (vb, &vb->tbi_lines, 1, vb->lines.len32, TbiLine, 1.5, "tbi_lines");
+
+    BNXT (TbiLine, vb->tbi_lines) = (TbiLine){ .line_i    = vb->line_i,
+                                               .chrom     = chrom_ok ? vb->chrom_node_index : WORD_INDEX_NONE,
+                                               .chrom_len = chrom_ok ? fld_lens[0] : 0,
+                                               .beg       = MAX_(beg, 0),                   // as htslib does
+                                               .end       = MAX_(end, MAX_(beg, 0) + 1) };  // at least one base
+}
+
+// writer thread: add one captured VCF, GFF or BED line, that starts at uoffset in the uncompressed file
+static void txt_index_add_tbi_line (TbiLine *tl, rom line, uint64_t uoffset, uint32_t line_len)
+{
+    if (tl->chrom == WORD_INDEX_NONE)
+        return txt_index_abandon(); // line could not be parsed
+
+    // get ref_id of this CHROM, adding it if it is new
+    if (tl->chrom >= ti.chrom_to_ref.len32) {
+        uint32_t old_len = ti.chrom_to_ref.len32;
+        buf_alloc (wvb, &ti.chrom_to_ref, 0, tl->chrom + 1, int32_t, 2, "txt_index.chrom_to_ref");
+        ti.chrom_to_ref.len32 = tl->chrom + 1;
+        memset (B32(ti.chrom_to_ref, old_len), 0xff, (ti.chrom_to_ref.len32 - old_len) * sizeof (int32_t)); // -1
+    }
+
+    int32_t *ref_id = B(int32_t, ti.chrom_to_ref, tl->chrom);
+    if (*ref_id == -1) {
+        *ref_id = ti.refs.len32;
+
+        buf_alloc (wvb, &ti.refs, 1, 1000, BaiRef, 2, "txt_index.refs");
+        BNXT (BaiRef, ti.refs) = (BaiRef){ .beg = UNSET };
+
+        buf_add_more (wvb, &ti.names, line, tl->chrom_len, "txt_index.names");
+        buf_add_more (wvb, &ti.names, "", 1, "txt_index.names"); // nul-terminator
+    }
+
+    txt_index_add_placed (*ref_id, tl->beg, tl->end, false, uoffset, uoffset + line_len);
+}
+
+// writer thread: called for each chunk of data flushed to the txt file (always containing whole records), before it is BGZF-compressed
+void txt_index_add_txt (VBlockP vb, bool is_txt_header)
+{
+    if (!ti.active) return;
+
+    uint64_t offset = txt_file->txt_data_so_far_single; // uncompressed offset of txt_data in the output file
+
+    // VCF, GFF, BED: a whole VB, flushed as is. Lines in wvb were already added by txt_index_add_line.
+    if (ti.type == IDX_TBI) {
+        if (is_txt_header || vb == wvb) return;
+
+        ARRAY (uint32_t, lines, vb->lines);
+        for_buf (TbiLine, tl, vb->tbi_lines) {
+            uint32_t line_len = lines[tl->line_i + 1] - lines[tl->line_i];
+            if (line_len) txt_index_add_tbi_line (tl, Btxt(lines[tl->line_i]), offset + lines[tl->line_i], line_len);
+        }
+    }
+
+    else if (is_txt_header)
+        txt_index_add_bam_header (STRb(vb->txt_data));
+
+    else
+        for (uint32_t i=0; i < Ltxt && ti.active; ) {
+            uint32_t rec_len = GET_UINT32 (Btxt(i)) + 4;
+
+            if (rec_len < 36 || i + rec_len > Ltxt)
+                return txt_index_abandon(); // malformed alignment
+
+            txt_index_add_bam_record (Btxt(i), offset + i, offset + i + rec_len);
+            i += rec_len;
+        }
+}
+
+// writer thread: called for each line of vb that is copied to wvb, in order, at uoffset of the uncompressed file
+void txt_index_add_line (VBlockP vb, uint32_t line_i, uint64_t uoffset, uint32_t line_len)
+{
+    if (!ti.active || ti.type != IDX_TBI || !line_len) return;
+
+    // skip lines not captured (meta lines) and lines dropped by the writer. note: tbi_lines.next is a cursor into tbi_lines.
+    while (vb->tbi_lines.next < vb->tbi_lines.len && B(TbiLine, vb->tbi_lines, vb->tbi_lines.next)->line_i < line_i)
+        vb->tbi_lines.next++;
+
+    if (vb->tbi_lines.next < vb->tbi_lines.len && B(TbiLine, vb->tbi_lines, vb->tbi_lines.next)->line_i == line_i)
+        txt_index_add_tbi_line (B(TbiLine, vb->tbi_lines, vb->tbi_lines.next), Btxt(*B32(vb->lines, line_i)), uoffset, line_len);
+}
+
+// writer thread: called in the order that BGZF blocks are written to disk, before writing them
+void txt_index_add_bgzf_blocks (VBlockP bgzf_vb)
+{
+    if (!ti.active) return;
+
+    uint64_t coffset = txt_file->disk_so_far;
+    uint32_t comp_i = 0;
+
+    buf_alloc (wvb, &ti.blocks, bgzf_vb->gz_blocks.len, 4096, BaiBlock, 2, "txt_index.blocks");
+
+    for_buf (BgzfBlockPiz, block, bgzf_vb->gz_blocks) {
+        BNXT (BaiBlock, ti.blocks) = (BaiBlock){ .uoffset = ti.uoffset_so_far, .coffset = coffset + comp_i };
+
+        ti.uoffset_so_far += block->txt_size;
+        comp_i += GET_UINT16 (Bc(bgzf_vb->comp_txt_data, comp_i + 16)) + 1; // BSIZE field of BGZF header: block size - 1
+    }
+}
+
+// the last block starting at or before uoffset (if several, the last one - as it is non-empty)
+static BINARY_SEARCHER (txt_index_find_block, BaiBlock, uint64_t, uoffset, false, IfNotExact_ReturnLower)
+
+static inline uint64_t txt_index_voffset (uint64_t uoffset)
+{
+    BaiBlock *block = binary_search (txt_index_find_block, BaiBlock, ti.blocks, uoffset);
+
+    while (block < BLST(BaiBlock, ti.blocks) && (block+1)->uoffset == uoffset) block++;
+
+    return (block->coffset << 16) | (uoffset - block->uoffset);
+}
+
+static SORTER (txt_index_chunk_sorter)
+{
+    return ASCENDING (BaiChunk, bin) ? : ASCENDING (BaiChunk, beg);
+}
+
+#define ADD32(n) ({ uint32_t n32 = LTEN32 ((uint32_t)(n)); buf_add_more (wvb, &out, (rom)&n32, 4, NULL); })
+#define ADD64(n) ({ uint64_t n64 = LTEN64 ((uint64_t)(n)); buf_add_more (wvb, &out, (rom)&n64, 8, NULL); })
+
+// tabix configuration and contig names: in the header of a .tbi file, and in the aux data of a .csi file
+static void txt_index_add_tbi_conf (BufferP out_p)
+{
+    #define out (*out_p)
+    const TbiConf *conf = TXT_DT(VCF) ? &tbi_conf_vcf : TXT_DT(GFF) ? &tbi_conf_gff : &tbi_conf_bed;
+
+    ADD32 (conf->format);
+    ADD32 (conf->col_seq);
+    ADD32 (conf->col_beg);
+    ADD32 (conf->col_end);
+    ADD32 (conf->meta);
+    ADD32 (conf->skip);
+    ADD32 (ti.names.len32);
+    buf_add_more (wvb, &out, ti.names.data, ti.names.len, NULL);
+    #undef out
+}
+
+static void txt_index_write (void)
+{
+    txt_index_finalize_cur_ref();
+
+    // the end of the data is the beginning of the EOF block
+    buf_alloc (wvb, &ti.blocks, 1, 0, BaiBlock, 1, "txt_index.blocks");
+    BNXT (BaiBlock, ti.blocks) = (BaiBlock){ .uoffset = ti.uoffset_so_far, .coffset = txt_file->disk_so_far };
+
+    ASSERT (ti.uoffset_so_far == txt_file->txt_data_so_far_single, "expecting uoffset_so_far=%"PRIu64" == txt_data_so_far_single=%"PRIu64,
+            ti.uoffset_so_far, txt_file->txt_data_so_far_single);
+
+    // convert linear index to virtual offsets, and fill empty windows with the previous window's offset (as htslib does)
+    for_buf (BaiRef, ref, ti.refs) {
+        uint64_t prev = 0;
+        for (uint64_t w = ref->linear_i; w < ref->linear_i + ref->n_intv; w++) {
+            uint64_t *ioffset = B64(ti.linear, w);
+            *ioffset = prev = (*ioffset == UNSET) ? prev : txt_index_voffset (*ioffset);
+        }
+    }
+
+    // chunks are in file order - which is by ref_id, as file is sorted. sort by bin and offset within each ref
+    BaiChunk *ref_first = B1ST (BaiChunk, ti.chunks);
+    for_buf (BaiChunk, chunk, ti.chunks)
+        if (chunk == BLST (BaiChunk, ti.chunks) || chunk[1].ref_id != chunk->ref_id) {
+            qsort (ref_first, chunk - ref_first + 1, sizeof (BaiChunk), txt_index_chunk_sorter);
+            ref_first = chunk + 1;
+        }
+
+    bool is_csi = (ti.n_lvls > BAI_NUM_LEVELS);
+    Buffer out = {};
+    buf_alloc (wvb, &out, 0, 1 MB, char, 0, "txt_index.out");
+
+    if (is_csi) {
+        buf_add_more (wvb, &out, "CSI\1", 4, NULL);
+        ADD32 (BAI_MIN_SHIFT);
+        ADD32 (ti.n_lvls);
+
+        if (ti.type == IDX_TBI) {
+            ADD32 (7 * sizeof (int32_t) + ti.names.len32); // l_aux
+            txt_index_add_tbi_conf (&out);
+        }
+        else
+            ADD32 (0); // l_aux
+    }
+
+    else if (ti.type == IDX_TBI) {
+        buf_add_more (wvb, &out, "TBI\1", 4, NULL);
+        ADD32 (ti.refs.len32);
+        txt_index_add_tbi_conf (&out);
+    }
+
+    else
+        buf_add_more (wvb, &out, "BAI\1", 4, NULL);
+
+    if (is_csi || ti.type == IDX_BAI)
+        ADD32 (ti.refs.len32);
+
+    BaiChunk *chunk = B1ST (BaiChunk, ti.chunks), *after_chunks = BAFT (BaiChunk, ti.chunks);
+
+    for (int32_t ref_id=0; ref_id < ti.refs.len32; ref_id++) {
+        BaiRef *ref = B(BaiRef, ti.refs, ref_id);
+
+        // count bins of this ref
+        BaiChunk *first = chunk;
+        while (chunk < after_chunks && chunk->ref_id == ref_id) chunk++;
+        BaiChunk *after = chunk;
+
+        uint32_t n_bin = 0;
+        for (BaiChunk *c = first; c < after; c++)
+            if (c == first || c->bin != c[-1].bin) n_bin++;
+
+        ADD32 (n_bin + (ref->beg != UNSET)); // +1 for meta bin
+
+        for (BaiChunk *bin_first = first; bin_first < after; ) {
+            BaiChunk *bin_after = bin_first;
+            while (bin_after < after && bin_after->bin == bin_first->bin) bin_after++;
+
+            // convert to virtual offsets, and merge chunks that are adjacent or start in the BGZF block in which the previous one ends
+            uint32_t n_chunk = 0;
+            for (BaiChunk *c = bin_first; c < bin_after; c++) {
+                c->beg = txt_index_voffset (c->beg);
+                c->end = txt_index_voffset (c->end);
+
+                if (n_chunk && (c->beg >> 16) <= (bin_first[n_chunk-1].end >> 16))
+                    bin_first[n_chunk-1].end = c->end;
+                else
+                    bin_first[n_chunk++] = *c;
+            }
+
+            ADD32 (bin_first->bin);
+
+            if (is_csi) { // loffset: voffset of first record overlapping the first window of the bin
+                int l = txt_index_bin_level (bin_first->bin);
+                uint32_t first_bin_of_level = ((1 << (3 * l)) - 1) / 7;
+                uint64_t w = (uint64_t)(bin_first->bin - first_bin_of_level) << (3 * (ti.n_lvls - l));
+                ADD64 (w < ref->n_intv ? *B64(ti.linear, ref->linear_i + w) : 0);
+            }
+
+            ADD32 (n_chunk);
+            for (uint32_t i=0; i < n_chunk; i++) {
+                ADD64 (bin_first[i].beg);
+                ADD64 (bin_first[i].end);
+            }
+
+            bin_first = bin_after;
+        }
+
+        // meta bin: voffsets of first and last record of the ref, and counts of mapped and unmapped reads
+        if (ref->beg != UNSET) {
+            ADD32 (txt_index_meta_bin());
+            if (is_csi) ADD64 (0);
+            ADD32 (2);
+            ADD64 (txt_index_voffset (ref->beg));
+            ADD64 (txt_index_voffset (ref->end));
+            ADD64 (ref->n_mapped);
+            ADD64 (ref->n_unmapped);
+        }
+
+        if (!is_csi) {
+            ADD32 (ref->n_intv);
+            for (uint64_t w = ref->linear_i; w < ref->linear_i + ref->n_intv; w++)
+                ADD64 (*B64(ti.linear, w));
+        }
+    }
+
+    ADD64 (ti.n_no_coor);
+
+    // .bai is not compressed, while .tbi and .csi are BGZF-compressed (as in htslib)
+    BufferP data = &out;
+    if (is_csi || ti.type == IDX_TBI) {
+        ASSERT (!wvb->comp_txt_data.len, "expecting wvb->comp_txt_data to be empty, but len=%"PRIu64, wvb->comp_txt_data.len);
+
+        bgzf_compress_buf (wvb, STRb(out));
+        data = &wvb->comp_txt_data;
+    }
+
+    rom ext = is_csi ? "csi" : ti.type == IDX_TBI ? "tbi" : "bai";
+    char index_filename[strlen (txt_file->name) + 5];
+    snprintf (index_filename, sizeof (index_filename), "%s.%s", txt_file->name, ext);
+
+    if (!file_put_data (index_filename, STRb(*data), 0)) {
+        WARN ("FYI: failed to write %s: %s", index_filename, strerror (errno));
+        ti.active = false;
+    }
+
+    buf_free (wvb->comp_txt_data);
+    buf_destroy (out);
+}
+
+// writer thread, after all data is written except the final EOF block: write index file. returns true if index was written.
+bool txt_index_finalize (void)
+{
+    if (ti.active) txt_index_write();
+
+    txt_index_destroy();
+
+    return ti.active;
+}
@@ -0,0 +1,19 @@
+// ------------------------------------------------------------------
+//   txt_index.h
+//   Copyright (C) 2025-2025 Genozip Limited. Patent Pending.
+//   Please see terms and conditions in the file LICENSE.txt
+//
+//   WARNING: Genozip is proprietary, not open source software. Modifying the source code is strictly prohibited,
+//   under penalties specified in the license.
+
+#pragma once
+
+#include "genozip.h"
+
+extern void txt_index_set_type (void);
+extern void txt_index_initialize (void);
+extern void txt_index_capture_line (VBlockP vb);
+extern void txt_index_add_txt (VBlockP vb, bool is_txt_header);
+extern void txt_index_add_line (VBlockP vb, uint32_t line_i, uint64_t uoffset, uint32_t line_len);
+extern void txt_index_add_bgzf_blocks (VBlockP bgzf_vb);
+extern bool txt_index_finalize (void);
@@ -0,0 +1,241 @@
+// ------------------------------------------------------------------
+//   txt_sort.c
+//   Copyright (C) 2025-2025 Genozip Limited. Patent Pending.
+//   Please see terms and conditions in the file LICENSE.txt
+//
+//   WARNING: Genozip is proprietary, not open source software. Modifying the source code is strictly prohibited,
+//   under penalties specified in the license.
+
+// genocat --sort of SAM/BAM: output alignments in coordinate order, instead of piping genocat into "samtools sort".
+// The compute threads capture the coordinate key of each line as it is reconstructed (see sam_piz_capture_sort_key).
+// The writer thread, instead of writing lines in the order of the reconstruction plan, copies them into a run. When the
+// run exceeds --sort-memory, it is radix-sorted and spilled to a temporary file. After all lines are added, the runs
+// (the last of which remains in memory) are k-way merged, and the merged output is fed to the writer, and hence to BGZF.
+
+#include <errno.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+#include "txt_sort.h"
+#include "buffer.h"
+#include "vblock.h"
+#include "sorter.h"
+#include "writer.h"
+
+typedef struct {
+    uint64_t key;                        // high 32 bits: ref_id ; low 32 bits: pos
+    uint64_t offset;                     // offset of the line in ts.data
+    uint32_t len;
+} SortLine;                              // a line of the in-memory run
+
+typedef struct {
+    FILE *file;
+    uint64_t key;                        // key of the current line
+    Buffer line;                         // the current line
+} SortRun;                               // a run spilled to a temporary file, while merging
+
+static struct {
+    uint64_t max_run_size;               // in bytes
+    Buffer lines;                        // SortLine: lines of the in-memory run
+    Buffer data;                         // text of the lines of the in-memory run
+    Buffer files;                        // FILE *: spilled runs, in the order they were spilled
+    Buffer runs;                         // SortRun: the spilled runs - allocated when merging starts
+    Buffer heap;                         // uint32_t: runs not yet exhausted, as a binary min-heap. run_i=runs.len is the in-memory run
+    uint64_t next_mem_line;              // next line of the in-memory run to be merged
+    bool merging;
+} ts = {};
+
+static void txt_sort_destroy (void)
+{
+    for (uint32_t i=0; i < ts.files.len32; i++)
+        fclose (*B(FILE *, ts.files, i)); // a temporary file is removed when it is closed
+
+    for_buf (SortRun, run, ts.runs)
+        buf_destroy (run->line);
+
+    buf_destroy (ts.lines);
+    buf_destroy (ts.data);
+    buf_destroy (ts.files);
+    buf_destroy (ts.runs);
+    buf_destroy (ts.heap);
+}
+
+// writer thread: called when starting to write a txt_file
+void txt_sort_initialize (void)
+{
+    txt_sort_destroy();
+
+    ts = (typeof(ts)){ .max_run_size = (flag.sort_memory ? flag.sort_memory : TXT_SORT_DEFAULT_MEMORY) MB };
+}
+
+// writer thread: create a temporary file in $TMPDIR (tmpfile() ignores it, and might use a small /tmp), removed when closed
+static FILE *txt_sort_tmpfile (void)
+{
+#ifndef _WIN32
+    rom dir = getenv ("TMPDIR");
+    if (!dir || !dir[0]) dir = P_tmpdir;
+
+    char path[strlen (dir) + 32];
+    snprintf (path, sizeof (path), "%s/genozip.sort.XXXXXX", dir);
+
+    int fd = mkstemp (path);
+    ASSINP (fd >= 0, "--sort: failed to create a temporary file in %s (set TMPDIR to use a different directory): %s", dir, strerror (errno));
+
+    unlink (path); // file is removed when closed, or when we exit
+
+    FILE *file = fdopen (fd, "w+b");
+#else
+    FILE *file = tmpfile();
+#endif
+    ASSERT (file, "--sort: failed to create a temporary file: %s", strerror (errno));
+
+    return file;
+}
+
+// writer thread: sort the in-memory run, and write it to a temporary file
+static void txt_sort_spill (void)
+{
+    radix_sort (SortLine, key, ts.lines); // stable - lines with the same key remain in their original order
+
+    FILE *file = txt_sort_tmpfile();
+
+    for_buf (SortLine, sl, ts.lines)
+        ASSERT (fwrite (&sl->key, sizeof (sl->key), 1, file) == 1 &&
+                fwrite (&sl->len, sizeof (sl->len), 1, file) == 1 &&
+                (!sl->len || fwrite (Bc(ts.data, sl->offset), sl->len, 1, file) == 1),
+                "--sort: failed to write to a temporary file (consider increasing --sort-memory): %s", strerror (errno));
+
+    buf_alloc (wvb, &ts.files, 1, 16, FILE *, 2, "txt_sort.files");
+    BNXT (FILE *, ts.files) = file;
+
+    ts.lines.len = ts.data.len = 0;
+}
+
+// writer thread: add a line in place of writing it
+void txt_sort_add_line (uint64_t key, STRp(line))
+{
+    if (ts.data.len + line_len > ts.max_run_size && ts.lines.len)
+        txt_sort_spill();
+
+    buf_alloc (wvb, &ts.lines, 1, 100000, SortLine, 2, "txt_sort.lines");
+    BNXT (SortLine, ts.lines) = (SortLine){ .key = key, .offset = ts.data.len, .len = line_len };
+
+    buf_add_more (wvb, &ts.data, line, line_len, "txt_sort.data");
+}
+
+// read the next line of a spilled run. returns false if the run is exhausted.
+static bool txt_sort_read_line (SortRun *run)
+{
+    if (fread (&run->key, sizeof (run->key), 1, run->file) != 1) {
+        ASSERT (feof (run->file), "--sort: failed to read a temporary file: %s", strerror (errno));
+        return false;
+    }
+
+    uint32_t len;
+    ASSERT0 (fread (&len, sizeof (len), 1, run->file) == 1, "--sort: a temporary file is truncated");
+
+    buf_alloc (wvb, &run->line, 0, len, char, 1.5, "txt_sort.run.line");
+    ASSERT (!len || fread (run->line.data, len, 1, run->file) == 1, "--sort: failed to read a temporary file: %s", strerror (errno));
+    run->line.len = len;
+
+    return true;
+}
+
+static inline uint64_t txt_sort_run_key (uint32_t run_i)
+{
+    return (run_i < ts.runs.len32) ? B(SortRun, ts.runs, run_i)->key
+                                   : B(SortLine, ts.lines, ts.next_mem_line)->key;
+}
+
+// heap order: by key, and runs in the order they were created for equal keys - so the merge is stable too
+static inline bool txt_sort_is_before (uint32_t run_a, uint32_t run_b)
+{
+    uint64_t key_a = txt_sort_run_key (run_a);
+    uint64_t key_b = txt_sort_run_key (run_b);
+
+    return key_a < key_b || (key_a == key_b && run_a < run_b);
+}
+
+static void txt_sort_heap_sift_down (uint32_t i)
+{
+    ARRAY (uint32_t, heap, ts.heap);
+
+    while (true) {
+        uint32_t first = i, left = 2*i + 1, right = 2*i + 2;
+
+        if (left  < heap_len && txt_sort_is_before (heap[left],  heap[first])) first = left;
+        if (right < heap_len && txt_sort_is_before (heap[right], heap[first])) first = right;
+        if (first == i) return;
+
+        SWAP (heap[i], heap[first]);
+        i = first;
+    }
+}
+
+static void txt_sort_start_merge (void)
+{
+    ts.merging = true;
+
+    radix_sort (SortLine, key, ts.lines); // the last run is merged from memory
+
+    if (ts.files.len)
+        buf_alloc_exact_zero (wvb, ts.runs, ts.files.len, SortRun, "txt_sort.runs"); // not realloced, as each SortRun contains a Buffer
+
+    buf_alloc (wvb, &ts.heap, 0, ts.files.len + 1, uint32_t, 0, "txt_sort.heap");
+
+    for_buf2 (SortRun, run, run_i, ts.runs) {
+        run->file = *B(FILE *, ts.files, run_i);
+        rewind (run->file);
+
+        if (txt_sort_read_line (run))
+            BNXT32 (ts.heap) = run_i;
+    }
+
+    if (ts.lines.len)
+        BNXT32 (ts.heap) = ts.runs.len32; // the in-memory run
+
+    for (int32_t i=ts.heap.len32 / 2 - 1; i >= 0; i--)
+        txt_sort_heap_sift_down (i);
+}
+
+// writer thread: append merged lines to out, until it reaches max_len or all lines are merged. returns false if there are no more lines.
+bool txt_sort_merge (VBlockP vb, BufferP out, uint64_t max_len)
+{
+    if (!ts.merging) txt_sort_start_merge();
+
+    while (ts.heap.len && out->len < max_len) {
+        uint32_t run_i = *B1ST32 (ts.heap);
+        bool has_more;
+
+        // case: in-memory run
+        if (run_i == ts.runs.len32) {
+            SortLine *sl = B(SortLine, ts.lines, ts.next_mem_line++);
+            buf_add_more (vb, out, Bc(ts.data, sl->offset), sl->len, "txt_data");
+            has_more = ts.next_mem_line < ts.lines.len;
+        }
+
+        // case: spilled run
+        else {
+            SortRun *run = B(SortRun, ts.runs, run_i);
+            buf_add_more (vb, out, run->line.data, run->line.len, "txt_data");
+            has_more = txt_sort_read_line (run);
+        }
+
+        // remove an exhausted run from the heap
+        if (!has_more) {
+            *B1ST32 (ts.heap) = *BLST32 (ts.heap);
+            ts.heap.len--;
+        }
+
+        if (ts.heap.len)
+            txt_sort_heap_sift_down (0);
+    }
+
+    return out->len > 0;
+}
+
+// writer thread: called after all lines are merged
+void txt_sort_finalize (void)
+{
+    txt_sort_destroy();
+}
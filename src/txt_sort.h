@@ -0,0 +1,18 @@
+// ------------------------------------------------------------------
+//   txt_sort.h
+//   Copyright (C) 2025-2025 Genozip Limited. Patent Pending.
+//   Please see terms and conditions in the file LICENSE.txt
+//
+//   WARNING: Genozip is proprietary, not open source software. Modifying the source code is strictly prohibited,
+//   under penalties specified in the license.
+
+#pragma once
+
+#include "genozip.h"
+
+#define TXT_SORT_DEFAULT_MEMORY 1024 // MB, if --sort-memory is not specified
+
+extern void txt_sort_initialize (void);
+extern void txt_sort_add_line (uint64_t key, STRp(line));
+extern bool txt_sort_merge (VBlockP vb, BufferP out, uint64_t max_len);
+extern void txt_sort_finalize (void);
@@ -12,11 +12,13 @@
 #include "zfile.h"
 #include "mgzip.h"
 #include "writer.h"
+#include "txt_index.h"
 #include "contigs.h"
 #include "piz.h"
 #include "gencomp.h"
 #include "compressor.h"
 #include "dispatcher.h"
+#include "zip_resume.h"
 
 static bool is_first_txt = true; 
 
@@ -98,10 +100,12 @@ void txtheader_compress (BufferP txt_header,
     txt_header_buf->next = 0;
     txt_header_comp_i = comp_i;
 
-    dispatcher_fan_out_task ("compress_txt_header", NULL, 0, "Writing txt header...", false, false, false, 0, 20000, true,
-                             txtheader_prepare_for_compress, 
-                             txtheader_compress_one_fragment, 
-                             zfile_output_processed_vb);
+    // note: with --resume, the txt header is already in the partial z_file, and z_file->txt_header_hdr was loaded from it
+    if (!flag.resume)
+        dispatcher_fan_out_task ("compress_txt_header", NULL, 0, "Writing txt header...", false, false, false, 0, 20000, true,
+                                 txtheader_prepare_for_compress, 
+                                 txtheader_compress_one_fragment, 
+                                 zfile_output_processed_vb);
 
     z_file->txt_data_so_far_single   += txt_header->len; // length of txt header as it would be reconstructed (possibly after modifications)
     z_file->txt_data_so_far_bind     += txt_header->len;
@@ -142,7 +146,7 @@ int64_t txtheader_zip_read_and_compress (int64_t *txt_header_offset, CompIType c
     // note: we always write the txt_header for comp_i=0 even if we don't actually have a header, because the
     // section header contains the data about the file. Special case: we don't write headers of SAM PRIM/DEPN
     if (z_file && !flag.zip_no_z_file && !flag.make_reference && !(z_sam_gencomp && (comp_i == SAM_COMP_PRIM || comp_i == SAM_COMP_DEPN))) {
-        *txt_header_offset = z_file->disk_so_far; // offset of first (vb=1) TXT_HEADER fragment
+        *txt_header_offset = flag.resume ? zip_resume_txt_header_offset() : z_file->disk_so_far; // offset of first (vb=1) TXT_HEADER fragment
         txtheader_compress (&evb->txt_data, txt_header_size, header_digest, is_first_txt, comp_i); 
     }
     else 
@@ -367,6 +371,9 @@ void txtheader_piz_read_and_reconstruct (Section sec)
     if (needs_recon && TXT_IS_MGZIP) 
         bgzf_piz_set_txt_file_bgzf_info (mgzip_flags, header.codec_info);
 
+    if (flag.index_txt && needs_recon)
+        txt_index_set_type();
+
     // note: this is reset for each component:
     // since v14 it is used for the commulative component-scope MD5 used for both VBs and txt file verification
     // up to v13 it is for commulative digest of both MD5 and Adler, but used only for txt file verification,
@@ -416,6 +423,10 @@ void txtheader_piz_read_and_reconstruct (Section sec)
         if (trans.txtheader_translator && !flag.no_header) 
             trans.txtheader_translator (txt_header_vb, &txt_header_vb->txt_data); 
 
+        // --sort: declare the output as coordinate-sorted
+        if (flag.sort && !flag.no_header && txt_header_vb->txt_data.len)
+            sam_header_piz_set_SO_coordinate (&txt_header_vb->txt_data);
+
         // count textual lines in header, used for line= reporting in ASSPIZ
         if (txt_header_vb->txt_data.len && !DTPT (is_binary)) {
             uint32_t num_textual_lines = str_count_char (STRb(txt_header_vb->txt_data), '\n');
@@ -432,6 +443,9 @@ void txtheader_piz_read_and_reconstruct (Section sec)
         digest_txt_header (&txt_header_vb->txt_data, header.digest_header, sec->comp_i); // verify txt header digest
     }
 
+    // --arrow: the txt header is not part of the Arrow stream - the writer outputs the schema instead
+    if (flag.arrow) txt_header_vb->txt_data.len = 0;
+
     if (!writer_handover_txtheader (&txt_header_vb)) {  // handover data to writer thread (even if the header is empty, as the writer thread is waiting for it)
         txt_file->txt_data_so_far_single += txt_header_vb->txt_data.len; // if writing, this is done in writer_write, caputring the processing in writer too
 
@@ -132,18 +132,34 @@ typedef struct {
     \
     /* random access, chrom, pos */ \
     Buffer ra_buf;                /* ZIP only: array of RAEntry - copied to z_file at the end of each vb compression, then written as a SEC_RANDOM_ACCESS section at the end of the genozip file */\
+    Buffer ra_lines_buf;          /* ZIP only: array of RALinesEntry - same, for the sub-VB index (--sub-vb-index), written as SEC_RA_LINES */\
+    Buffer agg_buf;               /* ZIP only: array of AggEntry - per-chrom and cover-type line counts (--aggregates), written as SEC_AGGREGATES */\
+    Buffer agg_index;             /* ZIP only: for each (chrom_node_index+1, cover type): 1 + index of its entry in agg_buf, or 0 */\
     WordIndex chrom_node_index;   /* ZIP and PIZ: index and name of chrom of the current line. Note: since v12, this is redundant with last_int (CHROM) */ \
     STR(chrom_name);              /* since v12, this redundant with last_txtx/last_txt_len (CHROM) */ \
     uint32_t seq_len;             /* PIZ - last calculated seq_len (as defined by each data_type) */\
     uint32_t longest_seq_len;     /* ZIP/PIZ SAM/BAM/FASTQ: largest seq_len of textual SEQ in this VB. Transmitted through SectionHeaderVbHeader.longest_seq_len */\
     \
     /* regions & filters */ \
+    uint32_t recon_lines_first;   /* PIZ: lines before this line are outside of --regions (per the sub-VB index), and are dropped without consulting regions */\
+    uint32_t recon_lines_limit;   /* PIZ: if non-zero, lines from this line onwards are outside of --regions (per the sub-VB index) or not written (--head, --lines, --tail), and are dropped without being reconstructed */\
+    Buffer filter_state;          /* PIZ: --filter: field references and evaluation points resolved for this VB */ \
     \
     /* PIZ: used by --show-coverage and --show-sex */ \
     Buffer coverage;              /* number of bases of each contig - exluding 'S' CIGAR, excluding reads flagged as Duplicate, Seconday arnd Failed filters */ \
     Buffer read_count;            /* number of mapped reads of each contig for show-coverage/idxstats (for show-coverage - excluding reads flagged as Duplicate, Seconday arnd Failed filters) */\
     Buffer unmapped_read_count;   \
     \
+    /* PIZ: used by --arrow */ \
+    Buffer arrow_cells;           /* captured field values - an ArrowCell per column per line */ \
+    Buffer arrow_strs;            /* text of captured string values */ \
+    \
+    /* PIZ: used by --index of VCF, GFF and BED */ \
+    Buffer tbi_lines;             /* CHROM, start and end of each non-dropped line, captured for the index */ \
+    \
+    /* PIZ: used by --sort */ \
+    Buffer sort_keys;             /* uint64_t: coordinate of each line, captured for the writer to sort by */ \
+    \
     /* crypto stuff */\
     Buffer spiced_pw;             /* used by crypt_generate_aes_key() */\
     int bi;                       /* used by AES */ \
@@ -27,7 +27,8 @@ void vcf_copy_sample_seg_initialize (VBlockVCFP vb)
     decl_ctx (VCF_COPY_SAMPLE);
 
     if (segconf_running) {
-        if ((segconf.vcf_is_gvcf && vcf_num_samples >= 1) || vcf_num_samples >= 5) // gvcf or any file with 5 or more samples
+        if (((segconf.vcf_is_gvcf && vcf_num_samples >= 1) || vcf_num_samples >= 5) && // gvcf or any file with 5 or more samples
+            !segconf.vcf_sample_block) // samples are not copied in a sample-blocked layout
             segconf.vcf_sample_copy = true; // initialize optimistically
     }
 
@@ -598,6 +598,8 @@ static void vcf_header_subset_samples (BufferP vcf_field_name_line)
     // if the user filtered out all samples, its equivalent of drop_genotypes
     if (!vcf_num_displayed_samples) flag.drop_genotypes = true;
 
+    vcf_sample_blocks_piz_set_included (num_samples);
+
     buf_free (evb->codec_bufs[0]);
 }
 
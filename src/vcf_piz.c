@@ -30,6 +30,7 @@ void vcf_piz_genozip_header (ConstSectionHeaderGenozipHeaderP header)
         segconf.vcf_del_svlen_is_neg  = header->vcf.segconf_del_svlen_is_neg;
         segconf.vcf_sample_copy          = header->vcf.segconf_sample_copy;
         segconf.Q_to_O                = BGEN32F (header->vcf.segconf_Q_to_O);
+        segconf.vcf_sample_block      = VER2(15,74) ? BGEN32 (header->vcf.segconf_sample_block) : 0; // since 15.0.74
         segconf.wid[INFO_AC].width    = header->vcf.width.AC;
         segconf.wid[INFO_AF].width    = header->vcf.width.AF;
         segconf.wid[INFO_AN].width    = header->vcf.width.AN;
@@ -88,6 +89,10 @@ void vcf_piz_vb_recon_init (VBlockP vb)
 // returns true if section is to be skipped reading / uncompressing
 IS_SKIP (vcf_piz_is_skip_section)
 {
+    // --sample-blocks: skip blocks that have no --samples samples
+    if (vcf_is_sample_block_dict_id (dict_id))
+        return vcf_piz_sample_blocks_is_skip_section (st, dict_id);
+
     if (flag.drop_genotypes && // note: if all samples are filtered out with --samples then flag.drop_genotypes=true (set in vcf_samples_analyze_field_name_line)
         (dict_id.num == _VCF_FORMAT || 
          (dict_id.num == _VCF_SAMPLES && !segconf.has[FORMAT_RGQ]) || // note: if has[RGQ], vcf_piz_special_REFALT peeks SAMPLES so we need it 
@@ -103,7 +108,7 @@ IS_SKIP (vcf_piz_is_skip_section)
         return true;
 
     // if --count, we only need TOPLEVEL and the fields needed for the available filters (--regions)
-    if (flag.count && IS_DICTED_SEC (st) &&
+    if (flag.count && !flag.filter && IS_DICTED_SEC (st) &&
         (     dict_id.num != _VCF_TOPLEVEL && 
               dict_id.num != _VCF_CHROM    && // easier to always have CHROM
              (dict_id.num != _VCF_POS || !flag.regions))) return true;
@@ -232,6 +237,9 @@ CONTAINER_FILTER_FUNC (vcf_piz_filter)
             
         case _VCF_SAMPLES:
         case _VCF_SAMPLES_0: // "no mate" channel of SAMPLES multiplexor
+            if (segconf.vcf_sample_block) 
+                return vcf_piz_sample_blocks_filter (dict_id, con, item);
+
             // Set sample_i before reconstructing each sample
             if (item == -1) {
                 vb->sample_i = rep;
@@ -250,7 +258,10 @@ CONTAINER_FILTER_FUNC (vcf_piz_filter)
 
             break;
 
-        default: break;
+        default: 
+            if (vcf_is_sample_block_dict_id (dict_id)) 
+                return vcf_piz_sample_blocks_filter (dict_id, con, item);
+            break;
     }
 
     return true;    
@@ -413,6 +424,10 @@ CONTAINER_CALLBACK (vcf_piz_container_cb)
             vb->drop_curr_line = "indels_only";
     }
 
+    // --sample-blocks: SAMPLES and the block containers
+    else if (vcf_is_sample_block_dict_id (dict_id) || (segconf.vcf_sample_block && dict_id.num == _VCF_SAMPLES))
+        vcf_piz_sample_blocks_cb (vb, dict_id, rep, recon, recon_len);
+
     // store reference to sample, in case the same sample in the next line needs to copy it
     else if (dict_id.num == _VCF_SAMPLES) {
         ctx_set_last_value (VB, CTX(VCF_LOOKBACK), (ValueType){ .i = con->repeats });
@@ -274,6 +274,33 @@ extern void seg_mux_by_is_prev_sample_copied (VBlockVCFP vb, ZipDataLineVCFP dl,
 extern void vcf_sample_copy_piz_init_vb (VBlockVCFP vb);
 extern void vcf_copy_sample_piz_store (VBlockVCFP vb, STRp(recon_sample));
 
+// --sample-blocks stuff: dict_ids of per-block contexts are those of the FORMAT field (or of SAMPLES for the block's container),
+// with bytes 5-7 replaced by '#' and the block index in 2 hex digits
+static inline DictId vcf_sample_block_dict_id (DictId dict_id, uint32_t block_i) 
+{ 
+    dict_id.id[5] = '#'; 
+    dict_id.id[6] = "0123456789ABCDEF"[block_i >> 4]; 
+    dict_id.id[7] = "0123456789ABCDEF"[block_i & 0xf]; 
+    return dict_id; 
+}
+
+#define HEX2INT(c) ((c) >= 'A' ? (c) - 'A' + 10 : (c) - '0')
+static inline uint32_t vcf_sample_block_i (DictId dict_id)              { return HEX2INT(dict_id.id[6]) * 16 + HEX2INT(dict_id.id[7]); }
+static inline DictId vcf_sample_block_base (DictId dict_id)             { dict_id.id[5] = dict_id.id[6] = dict_id.id[7] = 0; return dict_id; } // the FORMAT dict_id, for FORMAT fields of up to 5 characters
+static inline bool vcf_is_sample_block_con_dict_id (DictId dict_id)     { return !memcmp (dict_id.id, ((DictId){ .num = _VCF_SAMPLES }).id, 5); }
+static inline bool vcf_is_sample_block_dict_id (DictId dict_id)         { return segconf.vcf_sample_block && dict_id.id[5] == '#' && IS_HEXDIGITUP (dict_id.id[6]) && IS_HEXDIGITUP (dict_id.id[7]) &&
+                                                                                 (dict_id_is_vcf_format_sf (dict_id) || vcf_is_sample_block_con_dict_id (dict_id)); } // a FORMAT#xx or SAMPL#xx dict_id
+
+extern void vcf_sample_blocks_zip_initialize (void);
+extern void vcf_sample_blocks_segconf_finalize (void);
+extern void vcf_sample_blocks_segconf_finalize_DP (void);
+extern rom vcf_seg_samples_blocked (VBlockVCFP vb, ZipDataLineVCFP dl, int32_t len, char *next_field, bool *has_13);
+extern rom error_format_field (unsigned n_items, ContextP *ctxs);
+extern void vcf_sample_blocks_piz_set_included (uint32_t num_samples);
+extern bool vcf_piz_sample_blocks_is_skip_section (SectionType st, DictId dict_id);
+extern bool vcf_piz_sample_blocks_filter (DictId dict_id, ConstContainerP con, int item);
+extern void vcf_piz_sample_blocks_cb (VBlockVCFP vb, DictId dict_id, unsigned rep, char *recon, int32_t recon_len);
+
 // Local alleles
 extern void vcf_seg_FORMAT_LAA (VBlockVCFP vb, ContextP ctx, STRp(laa));
 
@@ -0,0 +1,220 @@
+// ------------------------------------------------------------------
+//   vcf_sample_blocks.c
+//   Copyright (C) 2025-2025 Genozip Limited. Patent Pending.
+//   Please see terms and conditions in the file LICENSE.txt
+//
+//   WARNING: Genozip is proprietary, not open source software. Modifying the source code is strictly prohibited
+//   and subject to penalties specified in the license.
+
+// --sample-blocks: an alternative layout for the samples, in which samples are partitioned into column blocks,
+// each with its own contexts. Samples are segged generically (no cross-sample or cross-field predictions),
+// trading compression for the ability of genocat --samples / --drop-genotypes to read and decompress only the
+// sections of blocks that contain requested samples.
+//
+// SAMPLES is a container with one item per block (no separators), each item is the block's container (SAMPL#xx),
+// with repeats=samples of this block in the line and items=the block's FORMAT contexts (eg GT#xx). Each
+// sample is followed by \t, and the final \t of the line is removed in vcf_piz_sample_blocks_cb.
+
+#include "vcf_private.h"
+
+#define MAX_SAMPLE_BLOCKS 64 // beyond that, block size is increased, to limit the number of contexts
+
+static char *block_is_included = NULL; // PIZ: a bytemap indicating for each block if it contains any --samples sample
+
+//------------
+// ZIP
+//------------
+
+void vcf_sample_blocks_zip_initialize (void)
+{
+    segconf.vcf_sample_block = 0;
+    if (!flag.sample_blocks) return;
+
+    if (vcf_num_samples < 2 || segconf.vcf_is_svaba || segconf.vcf_is_manta) {
+        WARN_ONCE ("FYI: ignoring --sample-blocks, as it is not supported for %s",
+                   vcf_num_samples < 2 ? "files with fewer than two samples" : "structural variant files of this caller");
+        return;
+    }
+
+    segconf.vcf_sample_block = MAX_(flag.sample_blocks, (vcf_num_samples + MAX_SAMPLE_BLOCKS - 1) / MAX_SAMPLE_BLOCKS);
+
+    if (segconf.vcf_sample_block != flag.sample_blocks)
+        WARN_ONCE ("FYI: --sample-blocks: using %u samples per block, as the maximum number of blocks is %u",
+                   segconf.vcf_sample_block, MAX_SAMPLE_BLOCKS);
+}
+
+// called from vcf_segconf_finalize: methods in which INFO or QUAL depend on FORMAT data cannot be used, as FORMAT data 
+// is segged generically. Note: segconf.has[] of FORMAT fields are not set in blocked seg.
+void vcf_sample_blocks_segconf_finalize (void)
+{
+    segconf.vcf_is_gatk_gvcf = false; // it would set segconf.has[] of FORMAT fields, and RGQ-multiplexing that peeks SAMPLES
+}
+
+// called from vcf_segconf_finalize, after INFO_DP_method is decided
+void vcf_sample_blocks_segconf_finalize_DP (void)
+{
+    if (segconf.INFO_DP_method == BY_FORMAT_DP)
+        segconf.INFO_DP_method = INFO_DP_DEFAULT; // so --samples reconstructs INFO/DP and not "-1"
+}
+
+static inline ContextP vcf_seg_sample_block_get_ctx (VBlockVCFP vb, ContextP ctx, uint32_t block_i)
+{
+    char tag_name[MAX_TAG_LEN];
+    unsigned tag_name_len = snprintf (tag_name, sizeof (tag_name), "%.*s#%02X", MAX_TAG_LEN - 4, ctx->tag_name, block_i);
+
+    ContextP block_ctx = ctx_get_ctx_tag (vb, vcf_sample_block_dict_id (ctx->dict_id, block_i), tag_name, tag_name_len);
+
+    ASSINP (!strcmp (block_ctx->tag_name, tag_name), "--sample-blocks cannot be used with this file, because FORMAT fields %.*s and %.*s cannot be distinguished. Please compress without it.",
+            (int)strlen (block_ctx->tag_name) - 3, block_ctx->tag_name, (int)strlen (ctx->tag_name), ctx->tag_name);
+
+    return block_ctx;
+}
+
+rom vcf_seg_samples_blocked (VBlockVCFP vb, ZipDataLineVCFP dl, int32_t len, char *next_field, bool *has_13)
+{
+    START_TIMER;
+
+    decl_ctx (VCF_SAMPLES);
+    ConstContainerP format = B(Container, ctx->format_mapper_buf, dl->format_node_i);
+    ContextP *ctxs = B(ContextP, ctx->format_contexts, dl->format_node_i * MAX_FIELDS);
+    uint32_t n_items = con_nitems (*format);
+
+    CTX(FORMAT_GT_HT)->use_HT_matrix = false; // GT is segged as a plain field
+
+    Container samples_con = { .repeats = 1, .filter_items = true, .callback = true };
+    Container block_con   = { .filter_items = true, .callback = true, .drop_final_item_sep = true, .repsep = "\t" };
+    con_set_nitems (block_con, n_items);
+
+    ContextPBlock block_ctxs;
+    uint32_t block_i=0, block_n_samples=0, block_n_colons=0;
+    char separator=0;
+
+    for (vb->sample_i=0 ; separator != '\n'; vb->sample_i++) {
+        STR0(sample);
+        sample = next_field;
+        next_field = (char *)seg_get_next_item (VB, sample, &len, GN_SEP, GN_SEP, GN_IGNORE, &sample_len, &separator, has_13, "sample-subfield");
+
+        ASSVCF (sample_len, "Error: invalid VCF file - expecting sample data for sample_i=%u, but found a tab character", vb->sample_i);
+
+        ASSVCF (vb->sample_i < vcf_num_samples || separator == '\n',
+                "invalid VCF file - expecting a newline after the last sample (sample_i=%u)", vb->sample_i);
+
+        // case: first sample of a block: get the block's contexts
+        if (!block_n_samples) {
+            block_i = vb->sample_i / segconf.vcf_sample_block;
+
+            for (unsigned i=0; i < n_items; i++) {
+                block_ctxs[i] = vcf_seg_sample_block_get_ctx (vb, ctxs[i], block_i);
+                block_con.items[i] = (ContainerItem){ .dict_id = block_ctxs[i]->dict_id, .separator = {':'} };
+            }
+        }
+
+        str_split (sample, sample_len, n_items, ':', sf, false);
+
+        ASSVCF (n_sfs, "Sample %u has too many subfields - FORMAT field \"%s\" specifies only %u: \"%.*s\"",
+                vb->sample_i+1, error_format_field (n_items, ctxs), n_items, STRf(sample));
+
+        for (unsigned i=0; i < n_sfs; i++)
+            if (sf_lens[i]) seg_integer_or_not (VB, block_ctxs[i], STRi(sf, i), sf_lens[i]);
+            else            seg_by_ctx (VB, "", 0, block_ctxs[i], 0); // generates WORD_INDEX_EMPTY
+
+        // missing subfields - defined in FORMAT but missing (not merely empty) in sample
+        for (unsigned i=n_sfs; i < n_items; i++)
+            seg_by_ctx (VB, NULL, 0, block_ctxs[i], 0); // generates WORD_INDEX_MISSING
+
+        block_n_samples++;
+        block_n_colons += n_sfs - 1;
+
+        // case: last sample of the block or of the line: seg the block's container
+        if (separator == '\n' || (vb->sample_i + 1) % segconf.vcf_sample_block == 0) {
+            ContextP block_con_ctx = ctx_get_ctx (vb, vcf_sample_block_dict_id ((DictId){ .num = _VCF_SAMPLES }, block_i));
+
+            block_con.repeats = block_n_samples;
+            container_seg (vb, block_con_ctx, &block_con, 0, 0, block_n_samples + block_n_colons); // account for : and \t \r \n separators
+
+            samples_con.items[block_i] = (ContainerItem){ .dict_id = block_con_ctx->dict_id };
+            block_n_samples = block_n_colons = 0;
+        }
+    }
+
+    if (vb->sample_i < vcf_num_samples)
+        WARN_ONCE ("FYI: the number of samples in variant CHROM=%.*s POS=%"PRId64" is %u, different than the VCF column header line which has %u samples",
+                   vb->chrom_name_len, vb->chrom_name, vb->last_int (VCF_POS), vb->sample_i, vcf_num_samples);
+
+    con_set_nitems (samples_con, block_i + 1);
+    container_seg (vb, ctx, &samples_con, 0, 0, 0);
+
+    ctx_set_last_value (VB, ctx, (ValueType){ .i = vb->sample_i });
+
+    COPY_TIMER (vcf_seg_samples);
+    return next_field;
+}
+
+//------------
+// PIZ
+//------------
+
+// called after the --samples list is resolved against the VCF header
+void vcf_sample_blocks_piz_set_included (uint32_t num_samples)
+{
+    if (!segconf.vcf_sample_block) return;
+
+    FREE (block_is_included);
+    block_is_included = CALLOC ((num_samples + segconf.vcf_sample_block - 1) / segconf.vcf_sample_block);
+
+    for (uint32_t sample_i=0; sample_i < num_samples; sample_i++)
+        if (vcf_samples_is_included[sample_i])
+            block_is_included[sample_i / segconf.vcf_sample_block] = true;
+}
+
+static inline bool vcf_piz_is_sample_block_needed (uint32_t block_i)
+{
+    return !flag.samples || !block_is_included/*not known yet, eg when reading dictionaries*/ || block_is_included[block_i];
+}
+
+// true if a section of a block context can be skipped
+bool vcf_piz_sample_blocks_is_skip_section (SectionType st, DictId dict_id)
+{
+    if (flag.drop_genotypes || !vcf_piz_is_sample_block_needed (vcf_sample_block_i (dict_id)))
+        return true;
+
+    // --GT-only: we need the block containers and the GT contexts
+    if (flag.gt_only && IS_DICTED_SEC (st) &&
+        vcf_sample_block_base (dict_id).num != _FORMAT_GT && !vcf_is_sample_block_con_dict_id (dict_id))
+        return true;
+
+    return false;
+}
+
+// container filter for SAMPLES and for the block containers
+bool vcf_piz_sample_blocks_filter (DictId dict_id, ConstContainerP con, int item)
+{
+    if (item < 0) return true;
+
+    DictId item_dict_id = con->items[item].dict_id;
+
+    // SAMPLES: filter out blocks with no requested samples, without consuming their data
+    if (dict_id.num == _VCF_SAMPLES)
+        return vcf_piz_is_sample_block_needed (vcf_sample_block_i (item_dict_id));
+
+    // block container: --GT-only - don't reconstruct non-GT sample subfields
+    else
+        return !flag.gt_only || vcf_sample_block_base (item_dict_id).num == _FORMAT_GT;
+}
+
+// container callback for SAMPLES and for the block containers
+void vcf_piz_sample_blocks_cb (VBlockVCFP vb, DictId dict_id, unsigned rep, char *recon, int32_t recon_len)
+{
+    // SAMPLES: every sample is followed by a \t - remove the final one
+    if (dict_id.num == _VCF_SAMPLES) {
+        if (recon_len && recon[recon_len-1] == '\t') Ltxt--;
+    }
+
+    // block container: --samples: remove sample (including its \t separator) if not requested
+    else {
+        vb->sample_i = vcf_sample_block_i (dict_id) * segconf.vcf_sample_block + rep;
+
+        if (!samples_am_i_included (vb->sample_i))
+            Ltxt -= recon_len;
+    }
+}
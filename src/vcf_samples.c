@@ -1300,7 +1300,7 @@ SPECIAL_RECONSTRUCTOR (vcf_piz_special_DEMUX_BY_DP_CUTOFF)
     return reconstruct_demultiplex (vb, ctx, STRa(snip), channel_i, new_value, reconstruct);
 }
 
-static rom error_format_field (unsigned n_items, ContextP *ctxs)
+rom error_format_field (unsigned n_items, ContextP *ctxs)
 {
     static char format[256];
     unsigned len=0;
@@ -1589,6 +1589,9 @@ static inline unsigned vcf_seg_one_sample (VBlockVCFP vb, ZipDataLineVCF *dl, Co
 
 rom vcf_seg_samples (VBlockVCFP vb, ZipDataLineVCFP dl, int32_t len, char *next_field, bool *has_13)
 {
+    if (segconf.vcf_sample_block) 
+        return vcf_seg_samples_blocked (vb, dl, len, next_field, has_13);
+
     START_TIMER;
 
     // Container for samples - we have:
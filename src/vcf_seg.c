@@ -14,6 +14,7 @@
 #include "stats.h"
 #include "tip.h"
 #include "arch.h"
+#include "aggregates.h"
 
 // called by main thread after reading the header
 void vcf_zip_initialize (void)
@@ -29,6 +30,7 @@ void vcf_zip_initialize (void)
     vcf_me_zip_initialize();
     vcf_giab_zip_initialize();
     vcf_1000G_zip_initialize();
+    vcf_sample_blocks_zip_initialize();
 
     if (segconf.vcf_is_vagrent)    vcf_vagrent_zip_initialize();
     if (segconf.vcf_is_mastermind) vcf_mastermind_zip_initialize();
@@ -99,6 +101,7 @@ void vcf_zip_genozip_header (SectionHeaderGenozipHeaderP header)
     header->vcf.segconf_del_svlen_is_neg = segconf.vcf_del_svlen_is_neg;  // since 15.0.48
     header->vcf.segconf_sample_copy      = segconf.vcf_sample_copy;       // since 15.0.69
     header->vcf.segconf_Q_to_O           = BGEN32F (segconf.Q_to_O);      // since 15.0.61
+    header->vcf.segconf_sample_block     = BGEN32 (segconf.vcf_sample_block);
     header->vcf.width.MLEAC              = segconf.wid[INFO_MLEAC].width; // since 15.0.37
     header->vcf.width.AC                 = segconf.wid[INFO_AC].width;    // since 15.0.37
     header->vcf.width.AF                 = segconf.wid[INFO_AF].width;    // since 15.0.37
@@ -241,6 +244,9 @@ void vcf_segconf_finalize (VBlockP vb_)
 {
     VBlockVCFP vb = (VBlockVCFP)vb_;
 
+    if (segconf.vcf_sample_block) 
+        vcf_sample_blocks_segconf_finalize();
+
     if (!segconf.vcf_evidence_not_gvcf || // all POS values in segconf are consecutive
         (segconf.has[FORMAT_ICNT] && segconf.has[FORMAT_SPL])) // DRAGEN GVCF - variants are consolidated using INFO/END so POS are not consecutive
         segconf.vcf_is_gvcf = true;
@@ -281,6 +287,9 @@ void vcf_segconf_finalize (VBlockP vb_)
 
         else 
             segconf.INFO_DP_method = INFO_DP_DEFAULT; // note: INFO_DP_DEFAULT≠0, so set explicitly 
+
+        if (segconf.vcf_sample_block)
+            vcf_sample_blocks_segconf_finalize_DP();
     }
 
     if (segconf.has[FORMAT_DP] && segconf.has[FORMAT_FI])
@@ -703,5 +712,7 @@ rom vcf_seg_txt_line (VBlockP vb_, rom line_start, uint32_t remaining_txt_len, b
 
     SEG_EOL (VCF_EOL, false);
 
+    aggregates_seg_line (VB, CVR_ALL_CONTIGS, 0, 0);
+
     return next_field;
 }
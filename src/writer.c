@@ -6,6 +6,7 @@
 //   WARNING: Genozip is proprietary, not open source software. Modifying the source code is strictly prohibited,
 //   under penalties specified in the license.
 
+#include <errno.h>
 #include "genozip.h"
 #include "buffer.h"
 #include "file.h"
@@ -30,6 +31,12 @@
 #include "dispatcher.h"
 #include "progress.h"
 #include "buf_list.h"
+#include "arrow.h"
+#include "txt_index.h"
+#include "aggregates.h"
+#include "txt_sort.h"
+#include "expr_filter.h"
+#include "arch.h"
 
 // ---------------
 // Data structures
@@ -592,7 +599,9 @@ static void writer_downsample_plan (void)
 static void writer_filter_regions (void)
 {
     for (VBIType vb_i=1; vb_i <= z_file->num_vbs; vb_i++) 
-        VBINFO(vb_i)->needs_recon &= random_access_is_vb_included (vb_i); // --regions: this VB is excluded
+        VBINFO(vb_i)->needs_recon &= random_access_is_vb_included (vb_i) && // --regions: this VB is excluded
+                                     expr_filter_is_vb_included (vb_i) &&   // --filter: no line in this VB can survive CHROM/POS predicates
+                                     !aggregates_count_vb (vb_i);           // --count: VB's lines counted from SEC_AGGREGATES
 }
 
 // PIZ main thread
@@ -794,7 +803,8 @@ static void noreturn writer_report_count (void)
 
 static void writer_apply_genocat_flags_to_recon_plan (void)
 {
-    bool has_regions_filter = random_access_has_filter();
+    bool has_regions_filter = random_access_has_filter() | expr_filter_prepare_pushdown();
+    bool has_aggregates     = aggregates_can_replace_coverage();
     
     // filtering
     if (flag.maybe_lines_dropped_by_writer || has_regions_filter) {
@@ -822,8 +832,13 @@ static void writer_apply_genocat_flags_to_recon_plan (void)
             writer_downsample_plan(); 
     }
 
+    // --coverage and --idxstats: counts are taken from SEC_AGGREGATES, no VB needs to be reconstructed
+    if (has_aggregates)
+        for (VBIType vb_i=1; vb_i <= z_file->num_vbs; vb_i++) 
+            VBINFO(vb_i)->needs_recon = false;
+
     // mark VBs that are fully dropped as !needs_recon + remove REMOVE_ME items from recon_plan + compact plan
-    if (flag.maybe_lines_dropped_by_writer || has_regions_filter || flag.one_vb) 
+    if (flag.maybe_lines_dropped_by_writer || has_regions_filter || has_aggregates || flag.one_vb) 
         writer_cleanup_recon_plan_after_genocat_filtering();
 
     // if user wants just genocat --count and reconstructor doesn't drop lines - we know the answer from the plan
@@ -915,7 +930,8 @@ void writer_create_plan (CompIType comp_i)
 
 #define BGZF_FLUSH_THRESHOLD  (32 MB) 
 #define PLAIN_FLUSH_THRESHOLD (4 MB) 
-#define FLUSH_THRESHOLD (TXT_IS_BGZF ? BGZF_FLUSH_THRESHOLD : PLAIN_FLUSH_THRESHOLD)
+#define PROGRESSIVE_FLUSH_THRESHOLD (256 KB) // --progressive: output reaches a downstream pipe sooner, at the cost of more write calls
+#define FLUSH_THRESHOLD (flag.progressive ? PROGRESSIVE_FLUSH_THRESHOLD : TXT_IS_BGZF ? BGZF_FLUSH_THRESHOLD : PLAIN_FLUSH_THRESHOLD)
 
 static void writer_write (BufferP buf, uint64_t txt_data_len)
 {
@@ -924,7 +940,16 @@ static void writer_write (BufferP buf, uint64_t txt_data_len)
     if (!buf->len) return;
     
     txtfile_fwrite (STRb(*buf));
+
+    // don't let stdio buffering delay data a downstream tool is waiting for
+    if (flag.progressive && fflush ((FILE *)txt_file->file)) {
+        if (errno == EPIPE) exit (EXIT_DOWNSTREAM_LOST); // downstream process has ended or closed the pipe - exit quietly, as txtfile_fwrite
+
+        ABORT ("Error flushing %s on filesystem=%s: (%u)%s", txt_file->basename, arch_get_filesystem_type (txt_file).s, errno, strerror (errno));
+    }
     
+    if (!txt_file->disk_so_far) profiler_set_time_to_first_byte();
+
     txt_file->disk_so_far += buf->len;
 
     buf_free (*buf);
@@ -943,6 +968,7 @@ static bool writer_output_one_processed_bgzf (Dispatcher dispatcher, bool blocki
     VBlockP bgzf_vb = dispatcher_get_processed_vb (dispatcher, NULL, blocking);
 
     if (bgzf_vb) {
+        txt_index_add_bgzf_blocks (bgzf_vb);
         writer_write (&bgzf_vb->comp_txt_data, bgzf_vb->txt_data.len);
         dispatcher_recycle_vbs (dispatcher, true);  // also release VB
     }
@@ -956,13 +982,15 @@ static void writer_flush_vb (Dispatcher dispatcher, VBlockP vb, bool is_txt_head
 
     if (!Ltxt && !is_last) return; // no data to flush
 
+    if (dispatcher) txt_index_add_txt (vb, is_txt_header); // note: uses txt_data_so_far_single before it is updated
+
     txt_file->txt_data_so_far_single += vb->txt_data.len;
 
     if (!flag.no_writer) { // note: we might have a writer thread despite no writing - eg for calculated the digest if we have SAM gencomp
         // case: BGZF compression - offload compression to compute threads (a max of BGZF_FLUSH_THRESHOLD per thread)
         if (dispatcher) {
             // in case of wvb, write the entire buffer, if its "native" vb, chop it up
-            uint32_t chunk_size = (vb==wvb) ? Ltxt : BGZF_FLUSH_THRESHOLD;
+            uint32_t chunk_size = (vb==wvb) ? Ltxt : FLUSH_THRESHOLD;
 
             for (uint32_t i=0; i < Ltxt || is_last; i += chunk_size) { // if txt_data is empty, we still do one iteration in case of is_last
 
@@ -975,6 +1003,10 @@ static void writer_flush_vb (Dispatcher dispatcher, VBlockP vb, bool is_txt_head
                 is_last = false; // if is is_last, we enter the loop once if txt_data.len=0
             }
 
+            // --progressive: output BGZF blocks as soon as they are compressed, rather than when the pool fills up
+            if (flag.progressive)
+                while (writer_output_one_processed_bgzf (dispatcher, false));
+
             buf_free (vb->txt_data);
         }
 
@@ -1028,8 +1060,18 @@ static void writer_write_line_range (VbInfo *v, uint32_t start_line, uint32_t nu
  
         if (!is_dropped) { // don't output lines dropped in container_  reconstruct_do due to vb->drop_curr_line
             
-            if (writer_line_survived_downsampling(v))
-                buf_add_more (wvb, &wvb->txt_data, start, line_len, "txt_data");
+            if (writer_line_survived_downsampling(v)) {
+                // --sort: the line is written later, merged with all other lines in coordinate order
+                if (flag.sort) {
+                    ASSERT (line_i < v->vb->sort_keys.len32, "vb_i=%u: sort key of line_i=%u was not captured", VBINFO_NUM(v), line_i);
+                    txt_sort_add_line (*B64(v->vb->sort_keys, line_i), start, line_len);
+                }
+
+                else {
+                    txt_index_add_line (v->vb, line_i, txt_file->txt_data_so_far_single + wvb->txt_data.len, line_len);
+                    buf_add_more (wvb, &wvb->txt_data, start, line_len, "txt_data");
+                }
+            }
             
             txt_file->lines_written_so_far++; // increment even if downsampled-out, but not if filtered out during reconstruction (for downsampling accounting)
             v->vb->num_nondrop_lines--;       // update lines remaining to be written (initialized during reconstruction in container_reconstruct)
@@ -1150,9 +1192,19 @@ static void writer_main_loop (VBlockP wvb) // same as wvb global variable
     Dispatcher dispatcher = (!flag.no_writer && TXT_IS_BGZF && txt_file->mgzip_flags.library != BGZF_EXTERNAL_LIB) ? 
         dispatcher_init ("bgzf", NULL, POOL_BGZF, writer_get_max_bgzf_threads(), 0, false, false, NULL, 0, NULL) : NULL;
 
+    txt_index_initialize();
+
+    if (flag.sort) txt_sort_initialize();
+
     // normally, we digest in the compute thread but in case gencomp lines can be inserted into the vb we digest here.
     bool do_digest = piz_need_digest && z_has_gencomp;
 
+    // --arrow: the stream starts with the schema, and record batches follow in the VBs
+    if (flag.arrow) {
+        arrow_piz_append_schema (wvb, &wvb->txt_data);
+        writer_flush_vb (dispatcher, wvb, false, false);
+    }
+
     // execute reconstruction plan
     for (int64_t i=0; i < z_file->recon_plan.len; i++) { // note: recon_plan.len maybe 0 if everything is filtered out
         ReconPlanItemP p = B(ReconPlanItem, z_file->recon_plan, i);
@@ -1191,7 +1243,7 @@ static void writer_main_loop (VBlockP wvb) // same as wvb global variable
                 // case of an unmodified VB that inserts lines from gencomp VBs, we do it here, as we re-assemble the original VB
                 if (do_digest_v) digest_one_vb (v->vb, false, NULL); 
 
-                if (!flag.downsample) {
+                if (!flag.downsample && !flag.sort) {
 
                     if (flag_is_show_vblocks (PIZ_TASK_NAME)) // only displayed for entire VBs, not line ranges etc 
                         iprintf ("VB_FLUSH_FULL_VB(id=%d) vb=%s/%d txt_data.len=%u\n", v->vb->id, comp_name (v->vb->comp_i), v->vb->vblock_i, v->vb->txt_data.len32);
@@ -1201,7 +1253,7 @@ static void writer_main_loop (VBlockP wvb) // same as wvb global variable
                     txt_file->lines_written_so_far += v->vb->num_nondrop_lines;
                 }
                 else 
-                    writer_write_line_range (v, 0, v->num_lines); // this skips downsampled-out lines
+                    writer_write_line_range (v, 0, v->num_lines); // this skips downsampled-out lines, or adds lines to be sorted
 
                 dispatcher_increment_progress ("txt_write", 1); // done writing VB
                 writer_release_vb (v);
@@ -1259,6 +1311,17 @@ static void writer_main_loop (VBlockP wvb) // same as wvb global variable
             dispatcher_increment_progress ("txt_write", 1); // done writing VB
         }
             
+    // --sort: all lines were added to the sorter - now write them, merged in coordinate order
+    if (flag.sort) {
+        while (txt_sort_merge (wvb, &wvb->txt_data, FLUSH_THRESHOLD))
+            writer_flush_vb (dispatcher, wvb, false, false);
+
+        txt_sort_finalize();
+    }
+
+    if (flag.arrow) 
+        arrow_piz_append_eos (wvb, &wvb->txt_data);
+
     // this might have data (eg with flag.downsample or flag.interleave) or not
     writer_flush_vb (dispatcher, wvb, false, true);
 
@@ -1267,6 +1330,8 @@ static void writer_main_loop (VBlockP wvb) // same as wvb global variable
         while (!vb_pool_is_empty (POOL_BGZF)) 
             writer_output_one_processed_bgzf (dispatcher, true);
 
+        txt_file->index_written = txt_index_finalize(); // before writing EOF block
+
         bgzf_write_finalize(); // write final data to wvb->comp_txt_data
         writer_write (&wvb->comp_txt_data, 0);
 
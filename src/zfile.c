@@ -389,6 +389,19 @@ static void *zfile_read_from_disk (FileP file, VBlockP vb, BufferP buf, uint32_t
     return start;
 }
 
+// ZIP of R2: "read" an R1 section from its in-memory copy rather than from disk
+static void *zfile_read_from_R1_cache (BufferP buf, rom cached, uint32_t cached_len, uint32_t offset, uint32_t len, SectionType st)
+{
+    ASSERT (offset + len <= cached_len, "reading cached R1 %s: offset=%u + len=%u exceeds cached_len=%u", st_name (st), offset, len, cached_len);
+    ASSERT (buf_has_space (buf, len), "reading cached R1 %s: buf is out of space: len=%u but remaining space in buffer=%u",
+            st_name (st), len, (uint32_t)(buf->size - buf->len));
+
+    char *start = BAFTc (*buf);
+    memcpy (start, cached + offset, len);
+    buf->len += len;
+
+    return start;
+}
 
 // read section header - called from the main thread. 
 // returns offset of header within data, or SECTION_SKIPPED if section is skipped
@@ -425,10 +438,15 @@ int32_t zfile_read_section_do (FileP file,
     buf_alloc (vb, data, 0, header_offset + header_size, uint8_t, 2, buf_name);
     data->param = 1;
     
+    // ZIP of R2: R1 sections needed for the pair might be cached in memory, in which case we don't read them back from disk
+    uint32_t cached_len = 0;
+    rom cached = (IS_ZIP && IS_R2 && sec && file == z_file) ? fastq_zip_get_cached_R1_section (sec, &cached_len) : NULL;
+
     // move the cursor to the section. file_seek is smart not to cause any overhead if no moving is needed
-    if (sec) file_seek (file, sec->offset, SEEK_SET, READ, HARD_FAIL);
+    if (sec && !cached) file_seek (file, sec->offset, SEEK_SET, READ, HARD_FAIL);
 
-    SectionHeaderP header = zfile_read_from_disk (file, vb, data, header_size, expected_sec_type, IS_DICTED_SEC(sec->st) ? sec->dict_id : DICT_ID_NONE); 
+    SectionHeaderP header = cached ? zfile_read_from_R1_cache (data, cached, cached_len, 0, header_size, expected_sec_type)
+                                   : zfile_read_from_disk (file, vb, data, header_size, expected_sec_type, IS_DICTED_SEC(sec->st) ? sec->dict_id : DICT_ID_NONE); 
     uint32_t bytes_read = header_size;
 
     ASSERT (header, "called from %s:%u: Failed to read data from file %s while expecting section type %s: %s", 
@@ -494,8 +512,10 @@ int32_t zfile_read_section_do (FileP file,
     data->param = 2;
 
     // read section data 
-    if (remaining_data_len > 0)
-        zfile_read_from_disk (file, vb, data, remaining_data_len, expected_sec_type, sections_get_dict_id (header));
+    if (remaining_data_len > 0) {
+        if (cached) zfile_read_from_R1_cache (data, cached, cached_len, bytes_read, remaining_data_len, expected_sec_type);
+        else        zfile_read_from_disk (file, vb, data, remaining_data_len, expected_sec_type, sections_get_dict_id (header));
+    }
 
     return header_offset;
 }
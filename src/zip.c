@@ -14,6 +14,8 @@
 #include "zip.h"
 #include "seg.h"
 #include "random_access.h"
+#include "aggregates.h"
+#include "dict_template.h"
 #include "refhash.h"
 #include "ref_iupacs.h"
 #include "progress.h"
@@ -34,6 +36,8 @@
 #include "b250.h"
 #include "zip_dyn_int.h"
 #include "huffman.h"
+#include "zip_resume.h"
+#include "codec.h"
 
 static void zip_display_compression_ratio (Digest md5)
 {
@@ -426,6 +430,8 @@ static void zip_write_global_area (void)
     THREAD_DEBUG (compress_dictionaries);
     dict_io_compress_dictionaries(); 
 
+    dict_template_compress(); // --dict-template
+
     if (z_sam_gencomp || flag.deep) {
         huffman_compress_section (SAM_QNAME);  // exists if gencomp or deep
         huffman_compress_section (SAM_QUAL);   // exists if gencomp or deep
@@ -481,8 +487,12 @@ static void zip_write_global_area (void)
     
         if (store_ref) 
             random_access_compress (ref_get_stored_ra(), SEC_REF_RAND_ACC, codec, flag.show_ref_index ? RA_MSG_REF : NULL);
+
+        random_access_compress_lines(); // --sub-vb-index
     }
 
+    aggregates_compress(); // --aggregates
+
     THREAD_DEBUG (user_message);
     user_message_compress();
 
@@ -515,6 +525,10 @@ static void zip_compress_one_vb (VBlockP vb)
 
     vb->txt_size = Ltxt; // this doesn't change with --optimize.
 
+    // for --resumable we serialize VBs from cloning until after merging: the clone (and hence segging and
+    // zip_handle_unique_words_ctxs) must see exactly the dictionaries of all previous VBs, so that --resume can re-create them
+    if (flag.resumable) serializer_lock (z_file->merge_serializer, vb->vblock_i);
+
     // clone global dictionaries while granted exclusive access to the global dictionaries
     ctx_clone (vb);
 
@@ -543,14 +557,18 @@ static void zip_compress_one_vb (VBlockP vb)
     // identify dictionaries that contain only singleton words (eg a unique id) and move the data from dict to local
     zip_handle_unique_words_ctxs (vb);
 
-    zfile_compress_vb_header (vb); // vblock header
+    // --resume: this VB is already in the partial z_file. We seg and merge it, to re-create dictionaries, random access etc, but don't compress or write it
+    bool is_replay = zip_resume_is_replay_vb (vb->vblock_i);
+
+    if (!is_replay)
+        zfile_compress_vb_header (vb); // vblock header
 
     if (flag.show_codec) {
         DO_ONCE iprintf ("\n\nThe output of --show-codec-test: Testing a sample of up %u bytes on ctx.local of each context.\n"
                          "Results in the format [codec bytes μsec] are in order of quality - the first was selected.\n", CODEC_ASSIGN_SAMPLE_SIZE);
     }
 
-    bool need_compress = !flag.make_reference && !flag.seg_only;
+    bool need_compress = !flag.make_reference && !flag.seg_only && !is_replay;
 
     // while vb_i=1 is busy merging, other VBs can handle local
     if (vb->vblock_i != 1 && need_compress) 
@@ -561,6 +579,7 @@ static void zip_compress_one_vb (VBlockP vb)
     threads_log_by_vb (vb, "zip", "START MERGE", 0);
 
     // for --make-reference we serialize merging by VB, so that contigs get their word_index in the order of the reference file
+    // note: for --resumable, we are already holding merge_serializer since before ctx_clone
     if (flag.make_reference) serializer_lock (make_ref_merge_serializer, vb->vblock_i);
 
     // merge new words added in this vb into the z_file.contexts (zctx), ahead of b250_zip_generate().
@@ -569,6 +588,7 @@ static void zip_compress_one_vb (VBlockP vb)
     ctx_merge_in_vb_ctx (vb);
 
     if (flag.make_reference) serializer_unlock (make_ref_merge_serializer);
+    else if (flag.resumable) serializer_unlock (z_file->merge_serializer);
 
     if (need_compress) {
         zip_compress_all_contexts_local (vb); // for vb=1 - all locals ; for vb>1 - locals which consist of singletons set in ctx_merge_in_vb_ctx (other locals were already compressed above)
@@ -580,6 +600,8 @@ static void zip_compress_one_vb (VBlockP vb)
     // merge in random access - IF it is used
     if (!segconf.disable_random_acccess) 
         random_access_merge_in_vb (vb);
+
+    aggregates_merge_in_vb (vb); // --aggregates
     
 after_compress:
     // examples: compress data-type specific sections ; absorb gencomp lines ; determine bamass_trims
@@ -662,12 +684,15 @@ static void zip_complete_processing_one_vb (VBlockP vb)
     DT_FUNC (vb, zip_after_compute)(vb);
 
     // update z_data in memory (its not written to disk yet)
-    zfile_update_compressed_vb_header (vb); 
+    if (!zip_resume_is_replay_vb (vb->vblock_i))
+        zfile_update_compressed_vb_header (vb); 
         
     txt_file->max_lines_per_vb = MAX_(txt_file->max_lines_per_vb, vb->lines.len);
 
-    if (!flag.make_reference && !flag.seg_only)
-        zfile_output_processed_vb_ext (vb, true);
+    if (!flag.make_reference && !flag.seg_only) {
+        zfile_output_processed_vb_ext (vb, true); // note: z_data is empty if this is a --resume replay VB
+        zip_resume_after_vb();
+    }
     
     zip_update_txt_counters (vb);
 
@@ -733,6 +758,7 @@ void zip_one_file (rom txt_basename,
         ctx_initialize_predefined_ctxs (z_file->contexts, txt_file->data_type, z_file->d2d_map, &z_file->num_contexts);
 
     segconf_zip_initialize(); // before txtheader 
+    zip_resume_set_vb_size();
 
     uint32_t first_vb_i = prev_file_last_vb_i + 1;
 
@@ -747,6 +773,10 @@ void zip_one_file (rom txt_basename,
 
     segconf_calculate();
 
+    codec_profile_load(); // after segconf, as profile is per flavor
+
+    dict_template_zip_prime(); // after segconf, as it creates contexts, and before the first VB
+
     txtfile_zip_finalize_codecs();
 
     uint64_t target_progress = zip_get_target_progress(); // estimate based on segconf data
@@ -826,6 +856,10 @@ finish:
         DT_FUNC (txt_file, zip_after_vbs)();
     
         zip_write_global_area();
+
+        codec_profile_save();
+
+        zip_resume_finalize(); // z_file is complete - remove checkpoint
     }
 
     zip_display_compression_ratio (digest_snapshot (&z_file->digest_ctx, NULL)); // Done for reference + final compression ratio calculation
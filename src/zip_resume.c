@@ -0,0 +1,300 @@
+// ------------------------------------------------------------------
+//   zip_resume.c
+//   Copyright (C) 2025-2025 Genozip Limited. Patent Pending.
+//   Please see terms and conditions in the file LICENSE.txt
+//
+//   WARNING: Genozip is proprietary, not open source software. Modifying the source code is strictly prohibited
+//   and subject to penalties specified in the license.
+
+// --resumable: every CHECKPOINT_INTERVAL seconds, the z_file is fsync'ed and a checkpoint file is (atomically) written,
+// recording the z_file length at that point, and the section list of all sections up to it.
+//
+// --resume: the z_file is validated against the checkpoint, truncated to the checkpoint length and continued. Rather than
+// serializing dictionaries, random access and other merged state (which is complex and data-type specific), we re-create it:
+// the input is re-read from the start, and VBs already in the z_file (the "replay" VBs) are segged and merged, but not compressed
+// or written. For this to be equivalent, --resumable serializes VBs in order of vb_i from ctx_clone to the end of the merge:
+// merging in order alone is not enough, as the words cloned (and hence which words are new, singletons etc) would still
+// depend on thread timing. This costs segging parallelism, but makes the dictionaries deterministic.
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include <errno.h>
+#include <sys/stat.h>
+#include "genozip.h"
+#include "buffer.h"
+#include "file.h"
+#include "sections.h"
+#include "segconf.h"
+#include "zriter.h"
+#include "version.h"
+#include "zip_resume.h"
+#include "libdeflate_1.19/libdeflate.h"
+
+#define CHECKPOINT_SIGNATURE "GENOCKP"
+#define CHECKPOINT_INTERVAL  30 // seconds
+
+typedef struct {
+    char signature[8];          // CHECKPOINT_SIGNATURE
+    uint32_t magic;             // GENOZIP_MAGIC
+    uint16_t genozip_version, genozip_minor_ver; // the checkpoint is only valid for the exact same Genozip build
+    uint32_t cmd_line_hash;     // adler32 of the command line, excluding --resume
+    uint32_t num_sections;      // number of SectionEnt following this header
+    uint64_t txt_file_size, txt_file_mtime;
+    uint64_t z_offset;          // length of the z_file covered by this checkpoint
+    uint64_t vb_size;           // segconf.vb_size, forced on --resume so that VB boundaries are the same
+    int64_t disk_so_far_comp;   // z_file->disk_so_far_comp[COMP_MAIN]
+    char txt_filename[1024];
+} CheckpointHeader;
+
+static Buffer replay_vbs = {};  // --resume: array of bool indexed by vb_i: true if VB is in the partial z_file
+static int64_t txt_header_offset = -1;
+static uint64_t resume_vb_size = 0;
+static time_t last_checkpoint_time = 0;
+static bool has_checkpoint = false; // a checkpoint was written or resumed from in this execution
+
+#define DECL_CHECKPOINT_FN(z_filename) char checkpoint_fn[strlen (z_filename) + sizeof (CHECKPOINT_EXT)]; \
+                                       snprintf (checkpoint_fn, sizeof (checkpoint_fn), "%s" CHECKPOINT_EXT, (z_filename))
+
+static uint32_t zip_resume_cmd_line_hash (void)
+{
+    rom cmd = flags_command_line();
+    uint32_t hash = 1;
+
+    // hash all tokens, except --resume
+    for (rom c=cmd; c && *c; ) {
+        rom after = strchr (c, ' ');
+        if (!after) after = c + strlen (c);
+
+        if (!str_issame_ (c, after - c, "--resume", 8) && !str_issame_ (c, after - c, "--debug-resume", 14))
+            hash = adler32 (hash, c, after - c + (*after == ' '));
+
+        c = after + (*after == ' ');
+    }
+
+    return hash;
+}
+
+static uint64_t zip_resume_txt_mtime (void)
+{
+    struct stat64 st;
+    ASSINP (!stat64 (txt_file->name, &st), "Failed to stat %s: %s", txt_name, strerror (errno));
+    return st.st_mtime;
+}
+
+static void zip_resume_fsync (FILE *fp)
+{
+#ifdef _WIN32
+    _commit (_fileno (fp));
+#else
+    fsync (fileno (fp));
+#endif
+}
+
+static void zip_resume_write_checkpoint (void)
+{
+    DECL_CHECKPOINT_FN (z_file->name);
+
+    CheckpointHeader header = { .signature         = CHECKPOINT_SIGNATURE,
+                                .magic             = GENOZIP_MAGIC,
+                                .genozip_version   = code_version_major(),
+                                .genozip_minor_ver = code_version_minor(),
+                                .cmd_line_hash     = zip_resume_cmd_line_hash(),
+                                .num_sections      = z_file->section_list.len32,
+                                .txt_file_size     = txt_file->disk_size,
+                                .txt_file_mtime    = zip_resume_txt_mtime(),
+                                .z_offset          = z_file->disk_so_far,
+                                .vb_size           = segconf.vb_size,
+                                .disk_so_far_comp  = z_file->disk_so_far_comp[COMP_MAIN] };
+    strncpy (header.txt_filename, txt_file->name, sizeof (header.txt_filename)-1);
+
+    // we write to a temporary file and rename, so that a checkpoint in its final name is guaranteed to be complete
+    char tmp_fn[sizeof (checkpoint_fn) + 16];
+    snprintf (tmp_fn, sizeof (tmp_fn), "%s.%u.tmp", checkpoint_fn, (unsigned)getpid());
+
+    FILE *file = fopen (tmp_fn, "wb");
+    ASSERT (file, "Failed to create checkpoint %s: %s", tmp_fn, strerror (errno));
+
+    bool success = fwrite (&header, sizeof (header), 1, file) == 1 &&
+                   fwrite (z_file->section_list.data, sizeof (SectionEnt), header.num_sections, file) == header.num_sections &&
+                   !fflush (file);
+
+    if (success) zip_resume_fsync (file);
+    success = !fclose (file) && success;
+
+#ifdef _WIN32
+    if (success) file_remove (checkpoint_fn, true); // rename doesn't overwrite on Windows
+#endif
+    ASSERT (success && !rename (tmp_fn, checkpoint_fn), "Failed to write checkpoint %s: %s", checkpoint_fn, strerror (errno));
+
+    has_checkpoint = true;
+}
+
+// main thread: called after each VB is handed to zriter. Every CHECKPOINT_INTERVAL seconds, we make
+// everything written so far durable, and record it in the checkpoint
+// --debug-resume (used by test.sh): checkpoint after every VB, and simulate an interruption after the second checkpoint
+void zip_resume_after_vb (void)
+{
+    if (!flag.resumable) return;
+
+    time_t now = time (NULL);
+    if (!last_checkpoint_time) last_checkpoint_time = now; // first VB
+    if (!flag.debug_resume && now - last_checkpoint_time < CHECKPOINT_INTERVAL) return;
+
+    zriter_wait_for_bg_writing(); // join background writers and fflush: disk_so_far and section_list now cover all data handed to zriter
+    zip_resume_fsync ((FILE *)z_file->file);
+    zip_resume_write_checkpoint();
+
+    last_checkpoint_time = time (NULL);
+
+    static int n_checkpoints = 0;
+    ASSINP (!flag.debug_resume || flag.resume || ++n_checkpoints < 2, "--debug-resume: simulating an interruption after checkpoint of %s", z_name);
+}
+
+// verify each section in the partial z_file: header fields as in the section list, and the Adler32 of its data
+static void zip_resume_verify_sections (FileP file, ConstBufferP list, uint64_t z_offset)
+{
+    FILE *fp = fopen (file->name, "rb");
+    ASSINP (fp, "Failed to open %s for reading: %s", file->name, strerror (errno));
+
+    ASSERTNOTINUSE (evb->scratch);
+
+    for_buf2 (SectionEnt, sec, sec_i, *list) {
+        uint64_t next_offset = (sec_i < list->len-1) ? (sec+1)->offset : z_offset;
+        uint32_t header_size = st_header_size (sec->st);
+
+        ASSINP (sec->offset + header_size <= next_offset && !fseeko64 (fp, sec->offset, SEEK_SET),
+                "Cannot resume: %s is inconsistent with its checkpoint (section_i=%u). Use --force without --resume to start over.", file->name, sec_i);
+
+        buf_alloc (evb, &evb->scratch, 0, next_offset - sec->offset, char, 1, "scratch");
+        evb->scratch.len = fread (evb->scratch.data, 1, next_offset - sec->offset, fp);
+
+        SectionHeaderP header = B1ST (SectionHeader, evb->scratch);
+        ASSINP (evb->scratch.len == next_offset - sec->offset         &&
+                BGEN32 (header->magic) == GENOZIP_MAGIC                &&
+                header->section_type == sec->st                        &&
+                BGEN32 (header->vblock_i) == sec->vblock_i             &&
+                header_size + BGEN32 (header->data_compressed_len) == evb->scratch.len &&
+                BGEN32 (header->z_digest) == adler32 (1, Bc(evb->scratch, header_size), BGEN32 (header->data_compressed_len)),
+                "Cannot resume: %s is corrupt (section_i=%u type=%s vb=%u). Use --force without --resume to start over.",
+                file->name, sec_i, st_name (sec->st), sec->vblock_i);
+
+        // keep the first TXT_HEADER fragment's header - it will be updated in zfile_update_txt_header_section_header
+        if (sec->st == SEC_TXT_HEADER && sec->vblock_i == 1 && txt_header_offset == -1) {
+            txt_header_offset = sec->offset;
+            file->txt_header_hdr = *(SectionHeaderTxtHeaderP)header;
+        }
+    }
+
+    buf_free (evb->scratch);
+    fclose (fp);
+
+    ASSINP (txt_header_offset >= 0, "Cannot resume: %s has no TXT_HEADER section", file->name);
+}
+
+// --resume: called from file_open_z_write, after the partial z_file is opened for update
+void zip_resume_open_z_file (FileP file)
+{
+    DECL_CHECKPOINT_FN (file->name);
+
+    ASSINP (file_exists (checkpoint_fn), "Cannot resume: checkpoint file %s does not exist. Either %s is complete, or it was not compressed with --resumable",
+            checkpoint_fn, file->name);
+
+    ASSINP (!txt_file->redirected && !txt_file->is_remote, "%s can only be used when compressing a local file", "--resume");
+
+    Buffer ckpt = {};
+    file_get_file (evb, checkpoint_fn, &ckpt, "ckpt", 0, VERIFY_NONE, false);
+
+    CheckpointHeader *header = B1ST (CheckpointHeader, ckpt);
+    ASSINP (ckpt.len >= sizeof (CheckpointHeader) && !memcmp (header->signature, CHECKPOINT_SIGNATURE, 8) && header->magic == GENOZIP_MAGIC &&
+            ckpt.len == sizeof (CheckpointHeader) + header->num_sections * sizeof (SectionEnt),
+            "Cannot resume: %s is not a valid checkpoint file", checkpoint_fn);
+
+    ASSINP (header->genozip_version == code_version_major() && header->genozip_minor_ver == code_version_minor(),
+            "Cannot resume: %s was created by Genozip %u.0.%u, but this is Genozip %s",
+            file->name, header->genozip_version, header->genozip_minor_ver, code_version().s);
+
+    ASSINP (!strcmp (header->txt_filename, txt_file->name) && header->txt_file_size == txt_file->disk_size &&
+            header->txt_file_mtime == zip_resume_txt_mtime(),
+            "Cannot resume: %s was created from %s, which is not the same as %s, or has been modified since", file->name, header->txt_filename, txt_name);
+
+    ASSINP (header->cmd_line_hash == zip_resume_cmd_line_hash(),
+            "Cannot resume: %s must be run with the same command line as the original compression of %s, with %s added",
+            "--resume", file->name, "--resume");
+
+    ASSINP (file_get_size (file->name) >= header->z_offset,
+            "Cannot resume: %s is shorter than its checkpoint", file->name);
+
+    // restore section list (section_list was just initialized in file_initialize_z_file_data)
+    buf_alloc (evb, &file->section_list, 0, header->num_sections, SectionEnt, 0, "z_file->section_list");
+    memcpy (file->section_list.data, header + 1, header->num_sections * sizeof (SectionEnt));
+    file->section_list.len = header->num_sections;
+
+    zip_resume_verify_sections (file, &file->section_list, header->z_offset);
+
+    // VBs whose sections are already in the z_file
+    uint32_t num_replay_vbs = 0;
+    for_buf (SectionEnt, sec, file->section_list)
+        if (sec->st == SEC_VB_HEADER) {
+            buf_alloc_zero (evb, &replay_vbs, 0, sec->vblock_i + 1, bool, 2, "replay_vbs");
+            *B(bool, replay_vbs, sec->vblock_i) = true;
+            replay_vbs.len = MAX_(replay_vbs.len, sec->vblock_i + 1);
+            num_replay_vbs++;
+        }
+
+    // discard whatever was written after the checkpoint
+    fflush ((FILE *)file->file);
+#ifdef _WIN32
+    ASSERT (!_chsize_s (_fileno ((FILE *)file->file), header->z_offset), "Failed to truncate %s: %s", file->name, strerror (errno));
+#else
+    ASSERT (!ftruncate (fileno ((FILE *)file->file), header->z_offset), "Failed to truncate %s: %s", file->name, strerror (errno));
+#endif
+    ASSERT (!fseeko64 ((FILE *)file->file, 0, SEEK_END), "Failed to seek to end of %s: %s", file->name, strerror (errno));
+
+    file->disk_so_far = header->z_offset;
+    file->disk_so_far_comp[COMP_MAIN] = header->disk_so_far_comp;
+    resume_vb_size = header->vb_size;
+
+    if (!flag.quiet)
+        iprintf ("Resuming %s from its checkpoint: %s VBs (%s) are already compressed. Re-reading them from %s to re-create the dictionaries...\n",
+                 file->name, str_int_commas (num_replay_vbs).s, str_size (header->z_offset).s, txt_name);
+
+    has_checkpoint = true;
+    buf_destroy (ckpt);
+}
+
+// --resume: called after segconf_zip_initialize: VB boundaries must be the same as in the original run
+void zip_resume_set_vb_size (void)
+{
+    if (flag.resume) segconf.vb_size = resume_vb_size; // segconf_calculate doesn't change a vb_size that is already set
+}
+
+bool zip_resume_is_replay_vb (VBIType vb_i)
+{
+    return flag.resume && vb_i < replay_vbs.len32 && *B(bool, replay_vbs, vb_i);
+}
+
+int64_t zip_resume_txt_header_offset (void)
+{
+    return txt_header_offset;
+}
+
+// called after the global area is written: the z_file is complete, and the checkpoint is no longer needed
+void zip_resume_finalize (void)
+{
+    if (!flag.resumable) return;
+
+    DECL_CHECKPOINT_FN (z_file->name);
+    file_remove (checkpoint_fn, true);
+
+    has_checkpoint = false;
+    buf_destroy (replay_vbs);
+}
+
+// called from exit_on_error: a z_file that has a checkpoint is kept, so it can be resumed
+bool zip_resume_has_checkpoint (void)
+{
+    return has_checkpoint;
+}
@@ -0,0 +1,22 @@
+// ------------------------------------------------------------------
+//   zip_resume.h
+//   Copyright (C) 2025-2025 Genozip Limited. Patent Pending.
+//   Please see terms and conditions in the file LICENSE.txt
+//
+//   WARNING: Genozip is proprietary, not open source software. Modifying the source code is strictly prohibited
+//   and subject to penalties specified in the license.
+
+#pragma once
+
+#include "genozip.h"
+
+// --resumable: a checkpoint file alongside the z_file records the sections that are durable on disk
+#define CHECKPOINT_EXT ".checkpoint"
+
+extern void zip_resume_open_z_file (FileP file);
+extern bool zip_resume_is_replay_vb (VBIType vb_i);
+extern int64_t zip_resume_txt_header_offset (void);
+extern void zip_resume_set_vb_size (void);
+extern void zip_resume_after_vb (void);
+extern void zip_resume_finalize (void);
+extern bool zip_resume_has_checkpoint (void);